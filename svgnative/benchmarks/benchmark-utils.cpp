@@ -0,0 +1,134 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "benchmark-utils.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+namespace SVGNativeBenchmarks
+{
+
+std::atomic<std::uint64_t> gAllocationCount{0};
+
+const std::vector<std::string>& Corpus()
+{
+    static std::vector<std::string> corpus = [] {
+        std::vector<std::string> paths;
+        if (DIR* dir = opendir(SVGNATIVE_TEST_CORPUS_DIR))
+        {
+            while (auto entry = readdir(dir))
+            {
+                std::string name{entry->d_name};
+                if (name.size() > 4 && name.compare(name.size() - 4, 4, ".svg") == 0)
+                    paths.push_back(std::string{SVGNATIVE_TEST_CORPUS_DIR} + "/" + name);
+            }
+            closedir(dir);
+        }
+        std::sort(paths.begin(), paths.end());
+
+        std::vector<std::string> documents;
+        for (const auto& path : paths)
+        {
+            std::ifstream input(path, std::ios::binary);
+            std::stringstream stream;
+            stream << input.rdbuf();
+            documents.push_back(stream.str());
+        }
+        return documents;
+    }();
+    return corpus;
+}
+
+std::string SyntheticDocument(int paths, int segments)
+{
+    std::ostringstream svg;
+    svg << "<svg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 1000 1000'><defs>";
+    for (int i = 0; i < 4; ++i)
+    {
+        svg << "<linearGradient id='g" << i << "' x1='0' x2='1'><stop offset='0' stop-color='#" << i << "0a0f0'/>"
+            << "<stop offset='1' stop-color='rgb(10," << 50 * i << ",200)' stop-opacity='0.5'/></linearGradient>";
+    }
+    svg << "</defs>";
+
+    int openGroups = 0;
+    for (int i = 0; i < paths; ++i)
+    {
+        if (i % 50 == 0)
+        {
+            svg << "<g transform='translate(" << i % 7 << " " << i % 11 << ") rotate(" << i % 13 << ")'>";
+            ++openGroups;
+        }
+        const float x = static_cast<float>(i * 37 % 1000);
+        const float y = static_cast<float>(i * 91 % 1000);
+        svg << "<path d='M" << x << ' ' << y;
+        for (int s = 0; s < segments; ++s)
+            svg << " c" << s % 5 + 1 << ",-3.5 " << s % 7 + 2 << ",3.25 " << s % 3 + 4 << ",1";
+        svg << "z' fill='";
+        if (i % 10 == 0)
+            svg << "url(#g" << i % 4 << ")";
+        else
+            svg << "#" << std::hex << (0x100000 + i * 2654435 % 0xefffff) << std::dec;
+        svg << "' stroke='black' stroke-width='0.5'/>";
+        if (i % 50 == 49)
+        {
+            svg << "</g>";
+            --openGroups;
+        }
+    }
+    for (; openGroups > 0; --openGroups)
+        svg << "</g>";
+    svg << "</svg>";
+    return svg.str();
+}
+
+DocumentCounters::DocumentCounters(benchmark::State& state, size_t documentsPerIteration)
+    : mState{state}
+    , mDocumentsPerIteration{documentsPerIteration}
+    , mAllocationsAtStart{gAllocationCount.load()}
+{
+}
+
+DocumentCounters::~DocumentCounters()
+{
+    const auto documents = static_cast<double>(mState.iterations() * mDocumentsPerIteration);
+    if (!documents)
+        return;
+    mState.counters["allocs/doc"] = static_cast<double>(gAllocationCount.load() - mAllocationsAtStart) / documents;
+    mState.counters["docs/s"] = benchmark::Counter(documents, benchmark::Counter::kIsRate);
+}
+
+} // namespace SVGNativeBenchmarks
+
+// Count every allocation of the benchmark executable.
+void* operator new(std::size_t size)
+{
+    ++SVGNativeBenchmarks::gAllocationCount;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,51 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#pragma once
+
+#include "benchmark/benchmark.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SVGNativeBenchmarks
+{
+
+// Number of calls to the global operator new. Counted by the operator
+// new replacement in benchmark-utils.cpp.
+extern std::atomic<std::uint64_t> gAllocationCount;
+
+// Contents of all SVG files in test/.
+const std::vector<std::string>& Corpus();
+
+// Document with paths of segments cubic curves each. Every tenth path is
+// filled with one of a few gradients and the paths are spread over
+// nested groups.
+std::string SyntheticDocument(int paths, int segments);
+
+// Reports allocations per document and documents per second after the
+// benchmark loop. Construct before the loop.
+class DocumentCounters
+{
+public:
+    DocumentCounters(benchmark::State& state, size_t documentsPerIteration);
+    ~DocumentCounters();
+
+private:
+    benchmark::State& mState;
+    size_t mDocumentsPerIteration;
+    std::uint64_t mAllocationsAtStart;
+};
+
+} // namespace SVGNativeBenchmarks
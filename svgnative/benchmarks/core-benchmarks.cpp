@@ -0,0 +1,450 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "benchmark-utils.h"
+#include "stress-corpus.h"
+#include "Base64.h"
+#include "SVGStringParser.h"
+
+#include "svgnative/SVGDocument.h"
+#include "svgnative/SVGRenderer.h"
+#include "svgnative/Rect.h"
+#ifdef USE_TEXT
+#include "svgnative/ports/string/StringSVGRenderer.h"
+#endif
+#ifdef USE_STREAM
+#include "svgnative/ports/stream/StreamSVGRenderer.h"
+#endif
+#ifdef USE_CAIRO
+#include "svgnative/ports/cairo/CairoSVGRenderer.h"
+#include "cairo.h"
+#endif
+
+#include <string>
+#include <vector>
+
+using namespace SVGNative;
+using namespace SVGNativeBenchmarks;
+
+namespace
+{
+class NullPath final : public Path
+{
+public:
+    void Rect(float, float, float, float) override {}
+    void RoundedRect(float, float, float, float, float, float) override {}
+    void Ellipse(float, float, float, float) override {}
+    void MoveTo(float, float) override {}
+    void LineTo(float, float) override {}
+    void CurveTo(float, float, float, float, float, float) override {}
+    void CurveToV(float, float, float, float) override {}
+    void ClosePath() override {}
+};
+
+class NullTransform final : public Transform
+{
+public:
+    void Set(float, float, float, float, float, float) override {}
+    void Rotate(float) override {}
+    void Translate(float, float) override {}
+    void Scale(float, float) override {}
+    void Concat(float, float, float, float, float, float) override {}
+};
+
+class NullImageData final : public ImageData
+{
+public:
+    float Width() const override { return 1; }
+    float Height() const override { return 1; }
+};
+
+// Does nothing. What remains is the overhead of the core.
+class NullSVGRenderer final : public SVGRenderer
+{
+public:
+    std::unique_ptr<ImageData> CreateImageData(const std::string&, ImageEncoding) override
+    {
+        return std::unique_ptr<ImageData>(new NullImageData);
+    }
+    std::unique_ptr<Path> CreatePath() override { return std::unique_ptr<Path>(new NullPath); }
+    std::unique_ptr<Transform> CreateTransform(float, float, float, float, float, float) override
+    {
+        return std::unique_ptr<Transform>(new NullTransform);
+    }
+    void Save(const GraphicStyle&) override {}
+    void Restore() override {}
+    void DrawPath(const Path&, const GraphicStyle&, const FillStyle&, const StrokeStyle&) override {}
+    void DrawImage(const ImageData&, const GraphicStyle&, const Rect&, const Rect&) override {}
+};
+
+std::unique_ptr<SVGDocument> CreateDocument(const std::string& source, std::shared_ptr<SVGRenderer> renderer)
+{
+    // The XML parser may modify the buffer in place.
+    std::string buffer{source};
+    return SVGDocument::CreateSVGDocument(buffer.c_str(), renderer);
+}
+
+std::vector<std::unique_ptr<SVGDocument>> CreateCorpusDocuments(std::shared_ptr<SVGRenderer> renderer)
+{
+    std::vector<std::unique_ptr<SVGDocument>> documents;
+    for (const auto& source : Corpus())
+    {
+        if (auto document = CreateDocument(source, renderer))
+            documents.push_back(std::move(document));
+    }
+    return documents;
+}
+} // namespace
+
+// SVGStringParser
+
+static void BM_ParseTransform(benchmark::State& state)
+{
+    const std::string transform{"translate(12.5, -3) rotate(45 10 10) scale(2) matrix(1 0.5 -0.5 1 3 4) skewX(10)"};
+    NullTransform matrix;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(SVGStringParser::ParseTransform(transform, matrix));
+}
+BENCHMARK(BM_ParseTransform);
+
+static void BM_ParseListOfNumbers(benchmark::State& state)
+{
+    const std::string numbers{"0 0 1024.5 768.25, 1e3 -2.5e-2 .5 -.75 12 13"};
+    std::vector<float> numberList;
+    for (auto _ : state)
+    {
+        numberList.clear();
+        benchmark::DoNotOptimize(SVGStringParser::ParseListOfNumbers(numbers, numberList));
+    }
+}
+BENCHMARK(BM_ParseListOfNumbers);
+
+static void BM_ParsePathString(benchmark::State& state)
+{
+    std::string pathString{"M10,10"};
+    for (int i = 0; i < state.range(0); ++i)
+        pathString += " c1.5,-3.25 2,3.5 4,1 l5-2 Q3,4 5,6 a10,12 30 0 1 15,10 H30 v-2.5 s1,2 3,4 t2,2";
+    pathString += "z";
+    NullPath path;
+    for (auto _ : state)
+        SVGStringParser::ParsePathString(pathString, path);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * pathString.size()));
+}
+BENCHMARK(BM_ParsePathString)->Arg(1)->Arg(100);
+
+// Arc-heavy paths, e.g. rounded corners and pie charts. Arg is the number of
+// arcs, their sweeps cover one to four curves.
+static void BM_ParseArcPath(benchmark::State& state)
+{
+    std::string pathString{"M10,10"};
+    for (int i = 0; i < state.range(0); ++i)
+        pathString += " a5,5 0 0 1 5,5 a20,10 30 1 0 15,-10 A8,8 0 0 0 10,10 a40,25 -45 1 1 -1,0";
+    NullPath path;
+    for (auto _ : state)
+        SVGStringParser::ParsePathString(pathString, path);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * state.range(0) * 4));
+}
+BENCHMARK(BM_ParseArcPath)->Arg(100);
+
+static void BM_ParseColor(benchmark::State& state)
+{
+    const std::vector<std::string> colors{"#f0a", "#ff00aa", "rgb(10, 20%, 255)", "rgba(10,20,30,0.5)", "cornflowerblue",
+        "hsl(120, 50%, 50%)", "var(--accent, #123456)"};
+    ColorImpl color;
+    for (auto _ : state)
+    {
+        for (const auto& colorString : colors)
+            benchmark::DoNotOptimize(SVGStringParser::ParseColor(colorString, color));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * colors.size()));
+}
+BENCHMARK(BM_ParseColor);
+
+// Base64 payloads of embedded images. Arg is the number of encoded bytes,
+// Arg 1 breaks lines after 76 characters like MIME encoders do.
+
+static void BM_DecodeBase64(benchmark::State& state)
+{
+    const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string base64;
+    for (int64_t i = 0; i < state.range(0); ++i)
+    {
+        base64 += alphabet[(i * 7) % 64];
+        if (state.range(1) && i % 76 == 75)
+            base64 += '\n';
+    }
+    std::vector<std::uint8_t> data(DecodedBase64Size(base64.size()));
+    size_t size{};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(DecodeBase64(base64.data(), base64.size(), data.data(), size));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * base64.size()));
+}
+BENCHMARK(BM_DecodeBase64)->Args({4 << 10, 0})->Args({4 << 20, 0})->Args({4 << 20, 1});
+
+// Tree building: XML parsing, attribute parsing, path construction and
+// bounds computation.
+
+static void BM_BuildTreeCorpus(benchmark::State& state)
+{
+    auto renderer = std::make_shared<NullSVGRenderer>();
+    const auto& corpus = Corpus();
+    DocumentCounters counters{state, corpus.size()};
+    for (auto _ : state)
+    {
+        for (const auto& source : corpus)
+            benchmark::DoNotOptimize(CreateDocument(source, renderer));
+    }
+}
+BENCHMARK(BM_BuildTreeCorpus);
+
+static void BM_BuildTreeSynthetic(benchmark::State& state)
+{
+    auto renderer = std::make_shared<NullSVGRenderer>();
+    const auto source = SyntheticDocument(static_cast<int>(state.range(0)), 8);
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(CreateDocument(source, renderer));
+}
+BENCHMARK(BM_BuildTreeSynthetic)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Rendering of parsed documents.
+
+static void BM_RenderNullCorpus(benchmark::State& state)
+{
+    auto documents = CreateCorpusDocuments(std::make_shared<NullSVGRenderer>());
+    DocumentCounters counters{state, documents.size()};
+    for (auto _ : state)
+    {
+        for (auto& document : documents)
+            document->Render(256, 256);
+    }
+}
+BENCHMARK(BM_RenderNullCorpus);
+
+static void BM_RenderNullSynthetic(benchmark::State& state)
+{
+    auto document = CreateDocument(SyntheticDocument(static_cast<int>(state.range(0)), 8), std::make_shared<NullSVGRenderer>());
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+        document->Render(256, 256);
+}
+BENCHMARK(BM_RenderNullSynthetic)->Arg(100)->Arg(1000)->Arg(10000);
+
+// Scaling. Every family grows one feature of a stress document. The
+// complexity fit over the range flags super-linear behavior in parsing,
+// reference resolution and traversal.
+
+namespace
+{
+StressOptions PathsStress(int n)
+{
+    StressOptions options;
+    options.paths = n;
+    return options;
+}
+
+StressOptions DepthStress(int n)
+{
+    StressOptions options;
+    options.paths = 16;
+    options.depth = n;
+    return options;
+}
+
+StressOptions UseChainsStress(int n)
+{
+    StressOptions options;
+    options.useChains = n;
+    return options;
+}
+
+StressOptions UseChainLengthStress(int n)
+{
+    StressOptions options;
+    options.useChains = 1;
+    options.useChainLength = n;
+    options.useFanOut = 1;
+    return options;
+}
+
+StressOptions GradientsStress(int n)
+{
+    StressOptions options;
+    options.gradients = n;
+    options.gradientUsers = n;
+    return options;
+}
+
+StressOptions SpritesStress(int n)
+{
+    StressOptions options;
+    options.sprites = n;
+    options.spriteUses = n;
+    return options;
+}
+
+StressOptions ImagesStress(int n)
+{
+    StressOptions options;
+    options.pngImages = n;
+    options.jpegImages = n;
+    options.imageSize = 64;
+    return options;
+}
+} // namespace
+
+static void BM_BuildTreeStress(benchmark::State& state, StressOptions (*stress)(int))
+{
+    auto renderer = std::make_shared<NullSVGRenderer>();
+    const auto source = StressDocument(stress(static_cast<int>(state.range(0))));
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(CreateDocument(source, renderer));
+    state.SetComplexityN(state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+
+static void BM_RenderNullStress(benchmark::State& state, StressOptions (*stress)(int))
+{
+    auto document = CreateDocument(StressDocument(stress(static_cast<int>(state.range(0)))), std::make_shared<NullSVGRenderer>());
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+        document->Render(256, 256);
+    state.SetComplexityN(state.range(0));
+}
+
+#define STRESS_BENCHMARK(name, stress, low, high) \
+    BENCHMARK_CAPTURE(BM_BuildTreeStress, name, stress)->RangeMultiplier(4)->Range(low, high)->Complexity(); \
+    BENCHMARK_CAPTURE(BM_RenderNullStress, name, stress)->RangeMultiplier(4)->Range(low, high)->Complexity()
+
+STRESS_BENCHMARK(paths, PathsStress, 64, 16384);
+STRESS_BENCHMARK(depth, DepthStress, 16, 4096);
+STRESS_BENCHMARK(use_chains, UseChainsStress, 16, 4096);
+STRESS_BENCHMARK(use_chain_length, UseChainLengthStress, 16, 4096);
+STRESS_BENCHMARK(gradients, GradientsStress, 16, 4096);
+STRESS_BENCHMARK(sprites, SpritesStress, 16, 4096);
+STRESS_BENCHMARK(images, ImagesStress, 1, 64);
+
+#ifdef USE_TEXT
+static void BM_RenderStringCorpus(benchmark::State& state)
+{
+    auto renderer = std::make_shared<StringSVGRenderer>();
+    auto documents = CreateCorpusDocuments(renderer);
+    DocumentCounters counters{state, documents.size()};
+    for (auto _ : state)
+    {
+        for (auto& document : documents)
+        {
+            document->Render(256, 256);
+            renderer->Clear();
+        }
+    }
+}
+BENCHMARK(BM_RenderStringCorpus);
+
+static void BM_RenderStringSynthetic(benchmark::State& state)
+{
+    auto renderer = std::make_shared<StringSVGRenderer>();
+    auto document = CreateDocument(SyntheticDocument(static_cast<int>(state.range(0)), 8), renderer);
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+    {
+        document->Render(256, 256);
+        renderer->Clear();
+    }
+}
+BENCHMARK(BM_RenderStringSynthetic)->Arg(100)->Arg(1000);
+#endif
+
+#ifdef USE_STREAM
+// Serializing the corpus, with the stream size as IPC cost.
+static void BM_RenderStreamCorpus(benchmark::State& state)
+{
+    auto renderer = std::make_shared<StreamSVGRenderer>();
+    auto documents = CreateCorpusDocuments(renderer);
+    DocumentCounters counters{state, documents.size()};
+    size_t bytes{};
+    for (auto _ : state)
+    {
+        bytes = 0;
+        for (auto& document : documents)
+        {
+            renderer->Clear();
+            document->Render(256, 256);
+            bytes += renderer->Stream().size();
+        }
+    }
+    state.counters["bytes/doc"] = static_cast<double>(bytes) / documents.size();
+}
+BENCHMARK(BM_RenderStreamCorpus);
+
+static void BM_PlayStreamCorpus(benchmark::State& state)
+{
+    auto renderer = std::make_shared<StreamSVGRenderer>();
+    std::vector<std::vector<std::uint8_t>> streams;
+    for (auto& document : CreateCorpusDocuments(renderer))
+    {
+        renderer->Clear();
+        document->Render(256, 256);
+        streams.push_back(renderer->Stream());
+    }
+    NullSVGRenderer target;
+    DocumentCounters counters{state, streams.size()};
+    for (auto _ : state)
+    {
+        for (const auto& stream : streams)
+            benchmark::DoNotOptimize(PlayStream(stream.data(), stream.size(), target));
+    }
+}
+BENCHMARK(BM_PlayStreamCorpus);
+#endif
+
+#ifdef USE_CAIRO
+static void BM_RenderCairoCorpus(benchmark::State& state)
+{
+    auto renderer = std::make_shared<CairoSVGRenderer>();
+    auto documents = CreateCorpusDocuments(renderer);
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 256, 256);
+    DocumentCounters counters{state, documents.size()};
+    for (auto _ : state)
+    {
+        for (auto& document : documents)
+        {
+            cairo_t* cr = cairo_create(surface);
+            renderer->SetCairo(cr);
+            document->Render(256, 256);
+            cairo_destroy(cr);
+        }
+    }
+    cairo_surface_destroy(surface);
+}
+BENCHMARK(BM_RenderCairoCorpus);
+
+static void BM_RenderCairoSynthetic(benchmark::State& state)
+{
+    auto renderer = std::make_shared<CairoSVGRenderer>();
+    auto document = CreateDocument(SyntheticDocument(static_cast<int>(state.range(0)), 8), renderer);
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1024, 1024);
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+    {
+        cairo_t* cr = cairo_create(surface);
+        renderer->SetCairo(cr);
+        document->Render(1024, 1024);
+        cairo_destroy(cr);
+    }
+    cairo_surface_destroy(surface);
+}
+BENCHMARK(BM_RenderCairoSynthetic)->Arg(100)->Arg(1000);
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,126 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "stress-corpus.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace SVGNativeBenchmarks;
+
+namespace
+{
+void PrintUsage(const char* program)
+{
+    std::cerr << program << " [options] [<output.svg>]\n"
+              << "Writes a stress document to output.svg or stdout.\n"
+              << "  --paths N            paths (0)\n"
+              << "  --segments M         cubic segments per path (8)\n"
+              << "  --depth D            nested groups around the paths (0)\n"
+              << "  --use-chains K       <use> chains (0)\n"
+              << "  --use-length L       levels per chain (4)\n"
+              << "  --fan-out F          <use> elements per level (2)\n"
+              << "  --gradients G        gradients in <defs> (0)\n"
+              << "  --gradient-users U   rectangles filled with gradients (0)\n"
+              << "  --png N              embedded PNG images (0)\n"
+              << "  --jpeg N             embedded JPEG images (0)\n"
+              << "  --image-size S       width and height of images (256)\n"
+              << "  --sprites S          <symbol> sprites in <defs> (0)\n"
+              << "  --sprite-uses U      <use> elements of random sprites (0)\n"
+              << "  --seed X             random seed (1)" << std::endl;
+}
+} // namespace
+
+int main(int argc, char* const argv[])
+{
+    StressOptions options;
+    struct
+    {
+        const char* name;
+        int* value;
+    } const intOptions[] = {
+        {"--paths", &options.paths},
+        {"--segments", &options.segments},
+        {"--depth", &options.depth},
+        {"--use-chains", &options.useChains},
+        {"--use-length", &options.useChainLength},
+        {"--fan-out", &options.useFanOut},
+        {"--gradients", &options.gradients},
+        {"--gradient-users", &options.gradientUsers},
+        {"--png", &options.pngImages},
+        {"--jpeg", &options.jpegImages},
+        {"--image-size", &options.imageSize},
+        {"--sprites", &options.sprites},
+        {"--sprite-uses", &options.spriteUses},
+    };
+
+    const char* outputPath{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help"))
+        {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+        if (arg[0] != '-')
+        {
+            outputPath = arg;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Error! Missing value for " << arg << "." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        const char* value = argv[++i];
+        if (!strcmp(arg, "--seed"))
+        {
+            options.seed = static_cast<std::uint32_t>(strtoul(value, nullptr, 10));
+            continue;
+        }
+        bool known = false;
+        for (const auto& option : intOptions)
+        {
+            if (!strcmp(arg, option.name))
+            {
+                *option.value = atoi(value);
+                known = true;
+                break;
+            }
+        }
+        if (!known)
+        {
+            std::cerr << "Error! Unknown option " << arg << "." << std::endl;
+            PrintUsage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const auto document = StressDocument(options);
+    if (!outputPath)
+    {
+        std::cout << document;
+        return 0;
+    }
+    std::ofstream output(outputPath, std::ios::binary);
+    if (!output)
+    {
+        std::cerr << "Error! Could not open output file." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    output << document;
+    return 0;
+}
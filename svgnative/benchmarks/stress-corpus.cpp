@@ -0,0 +1,396 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "stress-corpus.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace SVGNativeBenchmarks
+{
+
+namespace
+{
+// xorshift32. Unlike the <random> distributions, the sequence is the same
+// with every standard library.
+class Random
+{
+public:
+    explicit Random(std::uint32_t seed)
+        : mState{seed ? seed : 0x9e3779b9u}
+    {
+    }
+
+    std::uint32_t Next()
+    {
+        mState ^= mState << 13;
+        mState ^= mState >> 17;
+        mState ^= mState << 5;
+        return mState;
+    }
+
+    int Uniform(int bound) { return bound > 0 ? static_cast<int>(Next() % static_cast<std::uint32_t>(bound)) : 0; }
+
+private:
+    std::uint32_t mState;
+};
+
+void AppendBigEndian(std::string& out, std::uint32_t value, int bytes)
+{
+    for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8)
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+std::uint32_t CRC32(const std::string& data, size_t offset)
+{
+    static const std::vector<std::uint32_t> table = [] {
+        std::vector<std::uint32_t> t(256);
+        for (std::uint32_t n = 0; n < 256; ++n)
+        {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    std::uint32_t crc = 0xffffffffu;
+    for (size_t i = offset; i < data.size(); ++i)
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+void AppendPNGChunk(std::string& png, const char* type, const std::string& data)
+{
+    AppendBigEndian(png, static_cast<std::uint32_t>(data.size()), 4);
+    const size_t typeOffset = png.size();
+    png.append(type, 4);
+    png.append(data);
+    AppendBigEndian(png, CRC32(png, typeOffset), 4);
+}
+
+// Writes Huffman coded JPEG entropy data with 0xff byte stuffing.
+class JPEGBitWriter
+{
+public:
+    explicit JPEGBitWriter(std::string& out)
+        : mOut(out)
+    {
+    }
+
+    void Write(std::uint32_t bits, int count)
+    {
+        for (int i = count - 1; i >= 0; --i)
+        {
+            mByte = static_cast<std::uint8_t>((mByte << 1) | ((bits >> i) & 1));
+            if (++mCount == 8)
+                Emit();
+        }
+    }
+
+    // Pads the last byte with 1 bits.
+    void Flush()
+    {
+        while (mCount)
+            Write(1, 1);
+    }
+
+private:
+    void Emit()
+    {
+        mOut.push_back(static_cast<char>(mByte));
+        if (mByte == 0xff)
+            mOut.push_back('\0');
+        mByte = 0;
+        mCount = 0;
+    }
+
+    std::string& mOut;
+    std::uint8_t mByte{};
+    int mCount{};
+};
+
+int BitLength(int value)
+{
+    int length = 0;
+    for (value = std::abs(value); value; value >>= 1)
+        ++length;
+    return length;
+}
+
+// Coefficient as JPEG magnitude category and additional bits.
+void WriteCoefficient(JPEGBitWriter& writer, int value, int category)
+{
+    if (category)
+        writer.Write(static_cast<std::uint32_t>(value < 0 ? value + (1 << category) - 1 : value), category);
+}
+
+void AppendJPEGSegment(std::string& jpeg, std::uint8_t marker, const std::string& data)
+{
+    jpeg.push_back('\xff');
+    jpeg.push_back(static_cast<char>(marker));
+    AppendBigEndian(jpeg, static_cast<std::uint32_t>(data.size() + 2), 2);
+    jpeg.append(data);
+}
+
+// Huffman table with all symbols coded in 4 bits. Canonical code of the
+// n-th symbol is n.
+std::string FourBitHuffmanTable(std::uint8_t tableClass, int symbolCount)
+{
+    std::string table;
+    table.push_back(static_cast<char>(tableClass << 4));
+    for (int length = 1; length <= 16; ++length)
+        table.push_back(static_cast<char>(length == 4 ? symbolCount : 0));
+    for (int symbol = 0; symbol < symbolCount; ++symbol)
+        table.push_back(static_cast<char>(symbol));
+    return table;
+}
+
+// Random opaque color as #rrggbb.
+std::string RandomColor(Random& random)
+{
+    static const char* kDigits = "0123456789abcdef";
+    std::string color{"#"};
+    const std::uint32_t rgb = random.Next();
+    for (int shift = 20; shift >= 0; shift -= 4)
+        color.push_back(kDigits[(rgb >> shift) & 0xf]);
+    return color;
+}
+
+constexpr int kJPEGQuantizer{8};
+constexpr int kJPEGACCoefficients{10};
+} // namespace
+
+std::string StressPNG(int width, int height, std::uint32_t seed)
+{
+    Random random{seed};
+    std::string png{"\x89PNG\r\n\x1a\n", 8};
+
+    std::string header;
+    AppendBigEndian(header, static_cast<std::uint32_t>(width), 4);
+    AppendBigEndian(header, static_cast<std::uint32_t>(height), 4);
+    header.append("\x08\x02\x00\x00\x00", 5); // 8 bit RGB, no interlacing.
+    AppendPNGChunk(png, "IHDR", header);
+
+    std::string scanlines;
+    scanlines.reserve(static_cast<size_t>(height) * (3 * width + 1));
+    for (int y = 0; y < height; ++y)
+    {
+        scanlines.push_back('\0'); // No filter.
+        for (int x = 0; x < width; ++x)
+        {
+            const std::uint32_t noise = random.Next();
+            scanlines.push_back(static_cast<char>((x * 255 / std::max(width, 1)) ^ (noise & 0x1f)));
+            scanlines.push_back(static_cast<char>((y * 255 / std::max(height, 1)) ^ ((noise >> 8) & 0x1f)));
+            scanlines.push_back(static_cast<char>(noise >> 24));
+        }
+    }
+
+    // zlib stream of stored deflate blocks. Decoding cost and data size
+    // scale with the pixel count.
+    std::string zlib{"\x78\x01", 2};
+    size_t offset = 0;
+    do
+    {
+        const size_t blockSize = std::min<size_t>(scanlines.size() - offset, 0xffff);
+        zlib.push_back(offset + blockSize == scanlines.size() ? 1 : 0);
+        zlib.push_back(static_cast<char>(blockSize & 0xff));
+        zlib.push_back(static_cast<char>(blockSize >> 8));
+        zlib.push_back(static_cast<char>(~blockSize & 0xff));
+        zlib.push_back(static_cast<char>((~blockSize >> 8) & 0xff));
+        zlib.append(scanlines, offset, blockSize);
+        offset += blockSize;
+    } while (offset < scanlines.size());
+    std::uint32_t a = 1, b = 0;
+    for (char c : scanlines)
+    {
+        a = (a + static_cast<unsigned char>(c)) % 65521;
+        b = (b + a) % 65521;
+    }
+    AppendBigEndian(zlib, (b << 16) | a, 4);
+    AppendPNGChunk(png, "IDAT", zlib);
+    AppendPNGChunk(png, "IEND", {});
+    return png;
+}
+
+std::string StressJPEG(int width, int height, std::uint32_t seed)
+{
+    Random random{seed};
+    std::string jpeg{"\xff\xd8", 2};
+    AppendJPEGSegment(jpeg, 0xe0, std::string{"JFIF\0\x01\x01\x00\x00\x01\x00\x01\x00\x00", 14});
+    AppendJPEGSegment(jpeg, 0xdb, std::string(1, '\0') + std::string(64, static_cast<char>(kJPEGQuantizer)));
+
+    std::string frame{"\x08", 1};
+    AppendBigEndian(frame, static_cast<std::uint32_t>(height), 2);
+    AppendBigEndian(frame, static_cast<std::uint32_t>(width), 2);
+    frame.append("\x01\x01\x11\x00", 4); // One component, no subsampling.
+    AppendJPEGSegment(jpeg, 0xc0, frame);
+
+    // DC symbols are the categories 0..11. AC symbols are end of block (0)
+    // and run 0 with categories 1..10, which is all the encoder below emits.
+    AppendJPEGSegment(jpeg, 0xc4, FourBitHuffmanTable(0, 12));
+    AppendJPEGSegment(jpeg, 0xc4, FourBitHuffmanTable(1, 11));
+    AppendJPEGSegment(jpeg, 0xda, std::string{"\x01\x01\x00\x00\x3f\x00", 6});
+
+    JPEGBitWriter writer{jpeg};
+    const int blocksX = (width + 7) / 8;
+    const int blocksY = (height + 7) / 8;
+    int previousDC = 0;
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            const int gray = (bx * 255 / std::max(blocksX, 1) + by * 255 / std::max(blocksY, 1)) / 2;
+            const int dc = (gray - 128) * 8 / kJPEGQuantizer;
+            const int difference = dc - previousDC;
+            previousDC = dc;
+            const int dcCategory = BitLength(difference);
+            writer.Write(static_cast<std::uint32_t>(dcCategory), 4);
+            WriteCoefficient(writer, difference, dcCategory);
+
+            // Nonzero noise in the first zigzag positions, then end of block.
+            for (int i = 0; i < kJPEGACCoefficients; ++i)
+            {
+                int ac = random.Uniform(41) - 20;
+                if (!ac)
+                    ac = 1;
+                const int acCategory = BitLength(ac);
+                writer.Write(static_cast<std::uint32_t>(acCategory), 4);
+                WriteCoefficient(writer, ac, acCategory);
+            }
+            writer.Write(0, 4);
+        }
+    }
+    writer.Flush();
+    jpeg.append("\xff\xd9", 2);
+    return jpeg;
+}
+
+std::string Base64Encode(const std::string& data)
+{
+    static const char* kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3)
+    {
+        const std::uint32_t triple = static_cast<std::uint32_t>(static_cast<unsigned char>(data[i]) << 16
+            | static_cast<unsigned char>(data[i + 1]) << 8 | static_cast<unsigned char>(data[i + 2]));
+        encoded.push_back(kAlphabet[triple >> 18]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3f]);
+        encoded.push_back(kAlphabet[(triple >> 6) & 0x3f]);
+        encoded.push_back(kAlphabet[triple & 0x3f]);
+    }
+    if (i < data.size())
+    {
+        std::uint32_t triple = static_cast<std::uint32_t>(static_cast<unsigned char>(data[i]) << 16);
+        if (i + 1 < data.size())
+            triple |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[i + 1]) << 8);
+        encoded.push_back(kAlphabet[triple >> 18]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3f]);
+        encoded.push_back(i + 1 < data.size() ? kAlphabet[(triple >> 6) & 0x3f] : '=');
+        encoded.push_back('=');
+    }
+    return encoded;
+}
+
+std::string StressDocument(const StressOptions& options)
+{
+    Random random{options.seed};
+    std::ostringstream svg;
+    svg << "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 1000 1000'>";
+
+    svg << "<defs>";
+    for (int i = 0; i < options.gradients; ++i)
+    {
+        if (i % 2)
+            svg << "<radialGradient id='grad" << i << "' cx='0.5' cy='0.5' r='" << 0.25f + random.Uniform(50) / 100.0f
+                << "' spreadMethod='reflect'>";
+        else
+            svg << "<linearGradient id='grad" << i << "' x1='0' y1='0' x2='1' y2='" << random.Uniform(100) / 100.0f << "'>";
+        svg << "<stop offset='0' stop-color='" << RandomColor(random) << "'/>"
+            << "<stop offset='0.5' stop-color='rgb(" << random.Uniform(256) << ",20,200)' stop-opacity='0.5'/>"
+            << "<stop offset='1' stop-color='white'/>";
+        svg << (i % 2 ? "</radialGradient>" : "</linearGradient>");
+    }
+    for (int i = 0; i < options.sprites; ++i)
+    {
+        svg << "<symbol id='sprite" << i << "' viewBox='0 0 32 32'>"
+            << "<rect x='2' y='2' width='28' height='28' rx='4' fill='" << RandomColor(random)
+            << "'/><path d='M8 16 L16 6 L24 16 Q16 30 8 16z' fill='white'/></symbol>";
+    }
+    for (int chain = 0; chain < options.useChains; ++chain)
+    {
+        svg << "<path id='chain" << chain << "_0' d='M0 0 h6 v6 h-6z' fill='" << RandomColor(random) << "'/>";
+        for (int level = 1; level <= options.useChainLength; ++level)
+        {
+            svg << "<g id='chain" << chain << '_' << level << "'>";
+            for (int i = 0; i < options.useFanOut; ++i)
+                svg << "<use xlink:href='#chain" << chain << '_' << level - 1 << "' x='" << i * 8 << "' y='" << level % 2 * 8 << "'/>";
+            svg << "</g>";
+        }
+    }
+    svg << "</defs>";
+
+    for (int i = 0; i < options.depth; ++i)
+        svg << "<g transform='translate(" << (i % 3) - 1 << ' ' << (i % 5) - 2 << ")'>";
+    for (int i = 0; i < options.paths; ++i)
+    {
+        svg << "<path d='M" << random.Uniform(1000) << ' ' << random.Uniform(1000);
+        for (int s = 0; s < options.segments; ++s)
+        {
+            svg << " c" << random.Uniform(20) - 10 << ',' << random.Uniform(20) - 10 << ' ' << random.Uniform(20) - 10 << ','
+                << random.Uniform(20) - 10 << ' ' << random.Uniform(20) - 10 << ',' << random.Uniform(20) - 10;
+        }
+        svg << "z' fill='" << RandomColor(random) << "' stroke='black' stroke-width='0.5'/>";
+    }
+    for (int i = 0; i < options.depth; ++i)
+        svg << "</g>";
+
+    for (int i = 0; i < options.gradientUsers; ++i)
+    {
+        svg << "<rect x='" << random.Uniform(950) << "' y='" << random.Uniform(950) << "' width='50' height='50' fill='";
+        if (options.gradients)
+            svg << "url(#grad" << i % options.gradients << ")";
+        else
+            svg << "gray";
+        svg << "'/>";
+    }
+    for (int chain = 0; chain < options.useChains; ++chain)
+    {
+        svg << "<use xlink:href='#chain" << chain << '_' << options.useChainLength << "' x='" << random.Uniform(900)
+            << "' y='" << random.Uniform(900) << "'/>";
+    }
+    for (int i = 0; i < options.spriteUses && options.sprites; ++i)
+    {
+        svg << "<use xlink:href='#sprite" << random.Uniform(options.sprites) << "' x='" << random.Uniform(968) << "' y='"
+            << random.Uniform(968) << "' width='32' height='32'/>";
+    }
+
+    // Every image gets its own seed, so no two data URIs are equal.
+    const int imageCount = options.pngImages + options.jpegImages;
+    for (int i = 0; i < imageCount; ++i)
+    {
+        const bool png = i < options.pngImages;
+        const auto data = png ? StressPNG(options.imageSize, options.imageSize, random.Next())
+                              : StressJPEG(options.imageSize, options.imageSize, random.Next());
+        svg << "<image x='" << random.Uniform(900) << "' y='" << random.Uniform(900) << "' width='100' height='100' xlink:href='"
+            << (png ? "data:image/png;base64," : "data:image/jpeg;base64,") << Base64Encode(data) << "'/>";
+    }
+
+    svg << "</svg>";
+    return svg.str();
+}
+
+} // namespace SVGNativeBenchmarks
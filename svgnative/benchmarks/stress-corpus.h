@@ -0,0 +1,67 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace SVGNativeBenchmarks
+{
+
+// Parameters of a stress document. Every feature is off by default, so
+// sweeping one parameter isolates the code that handles it.
+struct StressOptions
+{
+    // Filled and stroked paths with cubic segments each.
+    int paths{};
+    int segments{8};
+    // Number of nested groups around the paths. Exercises the recursion
+    // of ParseChild and TraverseTree.
+    int depth{};
+
+    // Independent <use> chains. Level 0 of a chain is a path, every further
+    // level is a group with useFanOut <use> elements of the level below.
+    // One chain draws useFanOut^useChainLength paths.
+    int useChains{};
+    int useChainLength{4};
+    int useFanOut{2};
+
+    // Gradients in <defs> and rectangles referencing them round-robin.
+    int gradients{};
+    int gradientUsers{};
+
+    // <image> elements with embedded data URIs of imageSize x imageSize
+    // pixels. PNG data is stored uncompressed, so a PNG URI takes about
+    // 4 * imageSize^2 bytes.
+    int pngImages{};
+    int jpegImages{};
+    int imageSize{256};
+
+    // <symbol> sprites in <defs> and <use> elements picking sprites at
+    // random. Grows mIdToElementMap.
+    int sprites{};
+    int spriteUses{};
+
+    std::uint32_t seed{1};
+};
+
+// Creates a deterministic document for options.
+std::string StressDocument(const StressOptions& options);
+
+// Encoded noise images. JPEG is baseline grayscale.
+std::string StressPNG(int width, int height, std::uint32_t seed);
+std::string StressJPEG(int width, int height, std::uint32_t seed);
+
+std::string Base64Encode(const std::string& data);
+
+} // namespace SVGNativeBenchmarks
@@ -0,0 +1,74 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+// Built once per available XML back end. Only the back end source is
+// compiled in, so the numbers are free of any SVG processing.
+
+#include "benchmark-utils.h"
+#include "xml/XMLParser.h"
+
+#include <string>
+
+using namespace SVGNative;
+using namespace SVGNativeBenchmarks;
+
+// Visit every node and look up an attribute, like the SVG parser does.
+static size_t VisitNodes(std::unique_ptr<xml::XMLNode> node)
+{
+    size_t count{};
+    while (node)
+    {
+        ++count;
+        benchmark::DoNotOptimize(node->GetAttribute("id").found);
+        count += VisitNodes(node->GetFirstNode());
+        node = node->GetNextSibling();
+    }
+    return count;
+}
+
+static size_t ParseDocument(const std::string& source)
+{
+    // Some back ends parse in place. Give every run a fresh copy.
+    std::string buffer{source};
+    auto document = xml::XMLDocument::CreateXMLDocument(buffer.c_str());
+    if (!document)
+        return 0;
+    return VisitNodes(document->GetFirstNode());
+}
+
+static void BM_XMLParseCorpus(benchmark::State& state)
+{
+    const auto& corpus = Corpus();
+    size_t bytes{};
+    for (const auto& source : corpus)
+        bytes += source.size();
+    DocumentCounters counters{state, corpus.size()};
+    for (auto _ : state)
+    {
+        for (const auto& source : corpus)
+            benchmark::DoNotOptimize(ParseDocument(source));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_XMLParseCorpus);
+
+static void BM_XMLParseSynthetic(benchmark::State& state)
+{
+    const auto source = SyntheticDocument(static_cast<int>(state.range(0)), 8);
+    DocumentCounters counters{state, 1};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ParseDocument(source));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+BENCHMARK(BM_XMLParseSynthetic)->Arg(100)->Arg(1000)->Arg(10000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,281 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/SVGDocument.h"
+#include "svgnative/ports/cairo/CairoSVGRenderer.h"
+#include "cairo.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Size
+{
+    int width;
+    int height;
+};
+
+struct NamedColorMap
+{
+    std::string name;
+    SVGNative::ColorMap colorMap;
+};
+
+static void usage(const char* program)
+{
+    std::cerr << program << " [-o <output dir>] [-s <size>[,<size>...]] [-c <color map file>]... [-j <threads>] <input>..." << std::endl
+              << "  <input>  SVG file, directory with SVG files or manifest file with one path per line." << std::endl
+              << "  -s       Output sizes as <width> or <width>x<height>. Default: 256." << std::endl
+              << "  -c       Lines of \"<variable> <r> <g> <b> [<a>]\" with components from 0 to 1." << std::endl
+              << "           Every color map renders every size once." << std::endl
+              << "  -j       Worker threads. Default: all hardware threads." << std::endl;
+}
+
+static bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string stem(const std::string& path)
+{
+    auto name = path.substr(path.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
+
+static void collectInputs(const std::string& path, std::vector<std::string>& files)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+    {
+        std::cerr << "Warning: Could not find " << path << std::endl;
+        return;
+    }
+    if (S_ISDIR(info.st_mode))
+    {
+        DIR* dir = opendir(path.c_str());
+        if (!dir)
+            return;
+        std::vector<std::string> entries;
+        while (auto entry = readdir(dir))
+        {
+            std::string name{entry->d_name};
+            if (name != "." && name != "..")
+                entries.push_back(path + "/" + name);
+        }
+        closedir(dir);
+        std::sort(entries.begin(), entries.end());
+        for (const auto& entry : entries)
+        {
+            struct stat entryInfo;
+            if (stat(entry.c_str(), &entryInfo) == 0 && (S_ISDIR(entryInfo.st_mode) || endsWith(entry, ".svg")))
+                collectInputs(entry, files);
+        }
+    }
+    else if (endsWith(path, ".svg"))
+        files.push_back(path);
+    else
+    {
+        // Manifest. Relative paths are relative to the working directory.
+        std::ifstream manifest(path);
+        for (std::string line; std::getline(manifest, line);)
+        {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#')
+                collectInputs(line, files);
+        }
+    }
+}
+
+static bool parseSizes(const std::string& arg, std::vector<Size>& sizes)
+{
+    std::stringstream stream{arg};
+    for (std::string item; std::getline(stream, item, ',');)
+    {
+        Size size{};
+        auto x = item.find('x');
+        size.width = atoi(item.substr(0, x).c_str());
+        size.height = x == std::string::npos ? size.width : atoi(item.substr(x + 1).c_str());
+        if (size.width <= 0 || size.height <= 0)
+            return false;
+        sizes.push_back(size);
+    }
+    return !sizes.empty();
+}
+
+static bool parseColorMap(const std::string& path, NamedColorMap& colorMap)
+{
+    std::ifstream input(path);
+    if (!input)
+        return false;
+    colorMap.name = stem(path);
+    for (std::string line; std::getline(input, line);)
+    {
+        std::stringstream stream{line};
+        std::string name;
+        SVGNative::Color color{{0, 0, 0, 1}};
+        if (!(stream >> name) || name[0] == '#')
+            continue;
+        if (!(stream >> color[0] >> color[1] >> color[2]))
+            return false;
+        stream >> color[3];
+        colorMap.colorMap[name] = color;
+    }
+    return true;
+}
+
+static bool readFile(const std::string& path, std::string& content)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+        return false;
+    std::stringstream stream;
+    stream << input.rdbuf();
+    content = stream.str();
+    return true;
+}
+
+int main(int argc, char* const argv[])
+{
+    std::string outputDir{"."};
+    std::vector<Size> sizes;
+    std::vector<NamedColorMap> colorMaps;
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg{argv[i]};
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue)
+            outputDir = argv[++i];
+        else if (arg == "-s" && hasValue)
+        {
+            if (!parseSizes(argv[++i], sizes))
+            {
+                std::cerr << "Error! Invalid sizes " << argv[i] << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (arg == "-c" && hasValue)
+        {
+            NamedColorMap colorMap;
+            if (!parseColorMap(argv[++i], colorMap))
+            {
+                std::cerr << "Error! Could not read color map " << argv[i] << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            colorMaps.push_back(colorMap);
+        }
+        else if (arg == "-j" && hasValue)
+            threadCount = std::max(1, atoi(argv[++i]));
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else
+            collectInputs(arg, files);
+    }
+    if (files.empty())
+    {
+        usage(argv[0]);
+        return 0;
+    }
+    if (sizes.empty())
+        sizes.push_back({256, 256});
+    if (colorMaps.empty())
+        colorMaps.push_back({});
+
+    // Workers take whole documents, parse them once and render all sizes
+    // and color maps. Every worker owns one renderer.
+    std::atomic<size_t> nextFile{0};
+    std::atomic<size_t> documents{0};
+    std::atomic<size_t> failures{0};
+    std::atomic<std::uint64_t> pixels{0};
+    std::atomic<size_t> images{0};
+
+    auto work = [&]() {
+        auto renderer = std::make_shared<SVGNative::CairoSVGRenderer>();
+        std::string source;
+        for (size_t index = nextFile++; index < files.size(); index = nextFile++)
+        {
+            const auto& file = files[index];
+            if (!readFile(file, source))
+            {
+                ++failures;
+                continue;
+            }
+            auto doc = SVGNative::SVGDocument::CreateSVGDocument(source.c_str(), renderer);
+            if (!doc)
+            {
+                ++failures;
+                continue;
+            }
+            for (const auto& colorMap : colorMaps)
+            {
+                for (const auto& size : sizes)
+                {
+                    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size.width, size.height);
+                    cairo_t* cr = cairo_create(surface);
+                    renderer->SetCairo(cr);
+                    doc->Render(colorMap.colorMap, static_cast<float>(size.width), static_cast<float>(size.height));
+                    cairo_destroy(cr);
+
+                    std::string output = outputDir + "/" + stem(file) + "_" + std::to_string(size.width) + "x" + std::to_string(size.height);
+                    if (!colorMap.name.empty())
+                        output += "_" + colorMap.name;
+                    output += ".png";
+                    if (cairo_surface_write_to_png(surface, output.c_str()) != CAIRO_STATUS_SUCCESS)
+                        ++failures;
+                    cairo_surface_destroy(surface);
+
+                    pixels += static_cast<std::uint64_t>(size.width) * size.height;
+                    ++images;
+                }
+            }
+            ++documents;
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < std::min<size_t>(threadCount, files.size()); ++i)
+        threads.emplace_back(work);
+    work();
+    for (auto& thread : threads)
+        thread.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "threads:       " << std::min<size_t>(threadCount, files.size()) << std::endl
+              << "documents:     " << documents << " (" << failures << " failures)" << std::endl
+              << "images:        " << images << std::endl
+              << "seconds:       " << elapsed.count() << std::endl
+              << "documents/s:   " << documents / elapsed.count() << std::endl
+              << "images/s:      " << images / elapsed.count() << std::endl
+              << "megapixels/s:  " << pixels / 1e6 / elapsed.count() << std::endl;
+
+    return failures ? EXIT_FAILURE : 0;
+}
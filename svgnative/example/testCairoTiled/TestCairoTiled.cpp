@@ -0,0 +1,88 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ports/cairo/CairoTiledRasterizer.h"
+#include "cairo.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char* const argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << argv[0] << " <input.svg> <width> <height> [<output.png>] [<tile size>]" << std::endl;
+        return 0;
+    }
+
+    std::string svgInput{};
+    std::ifstream input(argv[1]);
+    if (!input)
+    {
+        std::cerr << "Error! Could not open input file." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for (std::string line; std::getline(input, line);)
+        svgInput.append(line);
+    input.close();
+
+    const int width = atoi(argv[2]);
+    const int height = atoi(argv[3]);
+    const int tileSize = argc > 5 ? atoi(argv[5]) : 512;
+    SVGNative::ColorMap colorMap;
+
+    // Scaling curve. Tiles are streamed and dropped, so only rendering is measured.
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "threads    seconds    speedup    efficiency" << std::endl;
+    double baseline{};
+    for (unsigned int threads = 1; threads <= 64; threads *= 2)
+    {
+        SVGNative::CairoTiledRasterizer rasterizer{svgInput, threads};
+        rasterizer.SetTileSize(tileSize);
+
+        const auto start = std::chrono::steady_clock::now();
+        if (!rasterizer.Render(colorMap, width, height, [](int, int, cairo_surface_t*) {}))
+        {
+            std::cerr << "Error! Could not render document." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (threads == 1)
+            baseline = elapsed.count();
+        const double speedup = baseline / elapsed.count();
+        std::cout << std::setw(7) << threads << std::fixed << std::setprecision(3)
+                  << std::setw(11) << elapsed.count() << std::setw(11) << speedup
+                  << std::setw(14) << speedup / threads << std::endl;
+    }
+
+    if (argc > 4)
+    {
+        SVGNative::CairoTiledRasterizer rasterizer{svgInput};
+        rasterizer.SetTileSize(tileSize);
+        cairo_surface_t* surface = rasterizer.RenderToSurface(colorMap, width, height);
+        if (!surface)
+        {
+            std::cerr << "Error! Could not render document." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        cairo_surface_write_to_png(surface, argv[4]);
+        cairo_surface_destroy(surface);
+    }
+
+    return 0;
+}
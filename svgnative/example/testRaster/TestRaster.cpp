@@ -0,0 +1,77 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/SVGDocument.h"
+#include "svgnative/ports/raster/RasterSVGRenderer.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+int main(int argc, char* const argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << argv[0] << " <input.svg> <output.ppm> [scale]" << std::endl;
+        return 0;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input)
+    {
+        std::cerr << "Error! Could not open input file." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string svgInput{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    const float scale = argc > 3 ? std::strtof(argv[3], nullptr) : 1.0f;
+
+    auto renderer = std::make_shared<SVGNative::RasterSVGRenderer>();
+    auto doc = std::unique_ptr<SVGNative::SVGDocument>(SVGNative::SVGDocument::CreateSVGDocument(svgInput.c_str(), renderer));
+    if (!doc)
+    {
+        std::cerr << "Error! Could not parse input file." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const int width = static_cast<int>(std::ceil(doc->Width() * scale));
+    const int height = static_cast<int>(std::ceil(doc->Height() * scale));
+    if (width <= 0 || height <= 0)
+    {
+        std::cerr << "Error! Document has no size." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::uint8_t> pixels(4 * static_cast<size_t>(width) * height, 0);
+    renderer->SetTarget(pixels.data(), width, height, 4 * width);
+    doc->Render(width, height);
+
+    // Premultiplied pixels over white.
+    std::ofstream output(argv[2], std::ios::binary);
+    if (!output)
+    {
+        std::cerr << "Error! Could not open output file." << std::endl;
+        return EXIT_FAILURE;
+    }
+    output << "P6\n" << width << " " << height << "\n255\n";
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        const std::uint8_t background = 255 - pixels[i + 3];
+        for (int c = 0; c < 3; ++c)
+            output.put(static_cast<char>(pixels[i + c] + background));
+    }
+    return output ? EXIT_SUCCESS : EXIT_FAILURE;
+}
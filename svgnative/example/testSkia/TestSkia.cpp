@@ -18,15 +18,18 @@ governing permissions and limitations under the License.
 #include "SkSurface.h"
 #include "svgnative/ports/skia/SkiaSVGRenderer.h"
 
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <string>
 
 int main(int argc, char* const argv[])
 {
-    if (argc != 3)
+    if (argc != 3 && argc != 4)
     {
         std::cout << "Incorrect number of arguments." << std::endl;
+        std::cout << argv[0] << " <input.svg> <output.png> [<iterations>]" << std::endl;
         return 0;
     }
 
@@ -62,6 +65,20 @@ int main(int argc, char* const argv[])
     renderer->SetSkCanvas(skRasterCanvas);
     doc->Render();
 
+    // Repeated renders reuse the cached gradient shaders of the renderer.
+    const int iterations = argc > 3 ? atoi(argv[3]) : 0;
+    if (iterations > 0)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            skRasterCanvas->clear(SK_ColorTRANSPARENT);
+            doc->Render();
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "average render time: " << elapsed.count() / iterations << " ms" << std::endl;
+    }
+
     auto skImage = skRasterSurface->makeImageSnapshot();
     if (!skImage)
         return 0;
@@ -0,0 +1,156 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_ImageCache_h
+#define SVGViewer_ImageCache_h
+
+#include "svgnative/SVGRenderer.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace SVGNative
+{
+
+/**
+ * Thread-safe cache of decoded images, shared by any number of documents.
+ *
+ * Documents keep embedded images undecoded with a fingerprint of their
+ * base64 payload. An image gets decoded with SVGRenderer::CreateImageData
+ * when it is drawn first and is cached by fingerprint, encoding and the
+ * type of the renderer, so equal payloads decode once across all documents.
+ * Entries keep a reference to their payload. A hit compares the payloads,
+ * so payloads with colliding fingerprints never get each other's image.
+ * If the summed size of all decoded images exceeds the byte budget, the
+ * least recently used images are evicted. The size of an image is
+ * estimated as 4 bytes per pixel of ImageData::Width() and Height().
+ *
+ * With worker threads, the first rendering of a document starts decoding
+ * all of its images in the background and draws wait for their image only.
+ * The CreateImageData implementation of the renderer must be thread-safe
+ * then.
+ */
+class SVG_IMP_EXP ImageCache
+{
+public:
+    struct Stats
+    {
+        std::uint64_t hits{};
+        std::uint64_t misses{};
+        std::uint64_t evictions{};
+        size_t entries{};
+        size_t bytes{};
+    };
+
+    /**
+     * @param byteBudget Maximal summed size of all decoded images.
+     * @param threadCount Number of worker threads decoding ahead of drawing.
+     *      0 decodes on the drawing thread only.
+     */
+    ImageCache(size_t byteBudget, unsigned int threadCount = 0);
+    ~ImageCache();
+
+    /**
+     * Fingerprint of a base64 payload.
+     */
+    static std::uint64_t Fingerprint(const std::string& base64);
+
+    /**
+     * Returns the decoded image of a payload. Decodes and caches it on a
+     * miss, or waits for a worker thread that decodes it already.
+     * @return The image, or nullptr if the renderer could not decode it.
+     *      Images stay valid after eviction.
+     */
+    std::shared_ptr<ImageData> Get(SVGRenderer& renderer, std::uint64_t fingerprint,
+        const std::shared_ptr<const std::string>& base64, ImageEncoding encoding);
+
+    /**
+     * Queues a payload for decoding on a worker thread unless it is cached
+     * or queued already. Does nothing without worker threads.
+     */
+    void Prefetch(const std::shared_ptr<SVGRenderer>& renderer, std::uint64_t fingerprint,
+        const std::shared_ptr<const std::string>& base64, ImageEncoding encoding);
+
+    bool HasWorkers() const { return !mWorkers.empty(); }
+
+    void SetByteBudget(size_t byteBudget);
+    void Clear();
+    Stats GetStats() const;
+
+private:
+    struct Key
+    {
+        std::uint64_t fingerprint;
+        size_t size;
+        ImageEncoding encoding;
+        std::type_index rendererType;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Job
+    {
+        Key key;
+        std::shared_ptr<SVGRenderer> renderer;
+        std::shared_ptr<const std::string> base64;
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const std::string> base64;
+        // nullptr if the renderer could not decode the payload. Failures
+        // are cached as well, so that they do not get decoded every frame.
+        std::shared_ptr<ImageData> image;
+        size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    std::shared_ptr<ImageData> Decode(std::unique_lock<std::mutex>& lock, const Key& key, SVGRenderer& renderer,
+        const std::shared_ptr<const std::string>& base64);
+    void Work();
+    void Evict();
+
+    mutable std::mutex mMutex;
+    std::condition_variable mJobsChanged;
+    std::condition_variable mDecoded;
+    // Most recently used first.
+    EntryList mEntries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> mIndex;
+    // Payloads that get decoded right now, by any thread.
+    std::unordered_set<Key, KeyHash> mPending;
+    std::deque<Job> mJobs;
+    std::vector<std::thread> mWorkers;
+    bool mStopping{};
+    size_t mByteBudget{};
+    Stats mStats;
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_ImageCache_h
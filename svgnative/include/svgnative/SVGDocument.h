@@ -17,6 +17,7 @@ governing permissions and limitations under the License.
 #include "svgnative/SVGRenderer.h"
 
 #include <array>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -33,8 +34,55 @@ namespace SVGNative
 {
 class SVGDocumentImpl;
 class SVGRenderer;
+class ImageCache;
 using ColorMap = std::map<std::string, std::array<float, 4>>;
 
+/**
+ * Counters of the rendering work of a document, see
+ * /ref SVGDocument::GetRenderStats().
+ */
+struct RenderStats
+{
+    // Referenced content recorded once for instancing.
+    std::uint64_t instancesRecorded{};
+    // <use> elements drawn by replaying a recording.
+    std::uint64_t instancesReplayed{};
+    // <use> elements drawn by traversing the referenced content.
+    std::uint64_t referencesTraversed{};
+    // Elements a rendering of the whole document traverses, with the
+    // content of every <use> expanded. Known after parsing, for cost
+    // estimates.
+    std::uint64_t expandedElements{};
+};
+
+/**
+ * Size of the render tree before and after
+ * /ref SVGDocument::SimplifyRenderTree().
+ */
+struct SimplifyStats
+{
+    // Elements a rendering of the whole document traverses, with the
+    // content of every <use> expanded.
+    std::uint64_t elementsBefore{};
+    std::uint64_t elementsAfter{};
+    // Paths and images a rendering of the whole document draws.
+    std::uint64_t drawsBefore{};
+    std::uint64_t drawsAfter{};
+};
+
+/**
+ * Options of /ref SVGDocument::CreateSVGDocument(const char*, std::shared_ptr<SVGNative::SVGRenderer>,
+ * std::shared_ptr<SVGNative::ImageCache>, const ParseOptions&).
+ */
+struct ParseOptions
+{
+    // Keeps a copy of the geometry of every shape, so that
+    // /ref SVGDocument::SimplifyRenderTree() can merge them. Without it,
+    // only paths with enough segments for level of detail keep a copy and
+    // get merged.
+    bool keepShapeGeometry{};
+};
+
 class SVG_IMP_EXP SVGDocument
 {
 public:
@@ -47,6 +95,30 @@ public:
      */
     static std::unique_ptr<SVGDocument> CreateSVGDocument(const char* s, std::shared_ptr<SVGNative::SVGRenderer> renderer);
 
+    /**
+     * Parses the passed string as SVG. Embedded images get decoded when they
+     * are drawn first and are shared with all other documents of imageCache.
+     * Without a cache, each document decodes its images once and keeps them.
+     * @param s SVG content as string.
+     * @param renderer See /ref CreateSVGDocument(const char*, std::shared_ptr<SVGNative::SVGRenderer>).
+     * @param imageCache Cache of decoded images, see ImageCache.
+     * @return Returns a pointer to a new SVGDocument object.
+     */
+    static std::unique_ptr<SVGDocument> CreateSVGDocument(const char* s, std::shared_ptr<SVGNative::SVGRenderer> renderer,
+        std::shared_ptr<SVGNative::ImageCache> imageCache);
+
+    /**
+     * Parses the passed string as SVG.
+     * @param s SVG content as string.
+     * @param renderer See /ref CreateSVGDocument(const char*, std::shared_ptr<SVGNative::SVGRenderer>).
+     * @param imageCache Cache of decoded images or nullptr, see
+     *      /ref CreateSVGDocument(const char*, std::shared_ptr<SVGNative::SVGRenderer>, std::shared_ptr<SVGNative::ImageCache>).
+     * @param options See ParseOptions.
+     * @return Returns a pointer to a new SVGDocument object.
+     */
+    static std::unique_ptr<SVGDocument> CreateSVGDocument(const char* s, std::shared_ptr<SVGNative::SVGRenderer> renderer,
+        std::shared_ptr<SVGNative::ImageCache> imageCache, const ParseOptions& options);
+
     ~SVGDocument();
 
     /**
@@ -175,23 +247,122 @@ public:
      */
     void Render(const char* id, const ColorMap& colorMap, float width, float height);
 
+    /**
+     * Renders only the parts of the SVG document that are visible in a viewport.
+     * The document is scaled like in /ref Render(float width, float height).
+     * Subtrees whose bounds are entirely outside of viewport are skipped without
+     * any calls to the renderer. Clipping to the viewport is left to the renderer.
+     * @param viewport Visible area in the coordinate system of the output surface,
+     *      e.g. the tile or the zoomed-in region the renderer is set up to draw.
+     * @param width Horizontal dimension of surface.
+     * @param height Vertical dimension of surface.
+     */
+    void Render(const Rect& viewport, float width, float height);
+
+    /**
+     * Renders only the parts of the SVG document that are visible in a viewport.
+     * See /ref Render(const Rect& viewport, float width, float height) and
+     * /ref Render(const ColorMap& colorMap, float width, float height) for details.
+     */
+    void Render(const Rect& viewport, const ColorMap& colorMap, float width, float height);
+
+    /**
+     * Enables the recording cache for documents that get drawn many times at
+     * different sizes. The first call of /ref Render(const ColorMap& colorMap, float width, float height)
+     * or any of its overloads without ID or viewport records the whole document into a
+     * native vector recording of the renderer, e.g. an SkPicture or a Cairo
+     * recording surface. Later calls replay the recording with a new root transform.
+     * The recording is created again if the color map changes. Renderers without
+     * recording support keep drawing the render tree.
+     * Disabling the cache releases the recording.
+     * @param enabled Enable or disable the recording cache.
+     */
+    void SetRecordingEnabled(bool enabled);
+
+    /**
+     * Releases the recording and the recordings of instanced <use> content.
+     * The next /ref Render call creates a new one if the recording cache is
+     * enabled.
+     */
+    void ClearRecording();
+
+    /**
+     * Enables level of detail for large paths. Paths with many segments get
+     * drawn simplified when the output scale is small, e.g. for thumbnails:
+     * segments shorter than the tolerance are merged and curves flatter than
+     * the tolerance are drawn as lines. Simplified paths are cached for each
+     * power of two of the output scale. Not applied while the recording cache
+     * replays.
+     * @param tolerance Maximal deviation from the original paths in device
+     *      pixels. 0 disables level of detail, the default.
+     */
+    void SetPathLevelOfDetail(float tolerance);
+
+    /**
+     * Enables instancing of repeated <use> content. Content that is
+     * referenced by more than one <use> element and draws at least 8 paths
+     * or images gets recorded once into a native vector recording of the
+     * renderer, e.g. an SkPicture or a Cairo recording surface. Every <use>
+     * element then replays the recording with its own transform. Recordings
+     * are created again if the color map changes and get released by
+     * /ref ClearRecording(). Renderers without recording support keep
+     * drawing the referenced content. Enabled by default.
+     * @param enabled Enable or disable instancing.
+     */
+    void SetInstancingEnabled(bool enabled);
+
+    /**
+     * Counters of the rendering work since the document was created, e.g.
+     * how many <use> elements were instanced.
+     */
+    RenderStats GetRenderStats() const;
+
+    /**
+     * Simplifies the render tree for faster rendering. Optional, call it
+     * once after parsing for documents that get rendered often.
+     * - Elements that never draw anything are removed: elements with
+     *   opacity 0, elements clipped by a clipping path without content and
+     *   graphics without fill and stroke. Like rendering, the pass ignores
+     *   `display` and `visibility`, so the output stays the same.
+     * - Groups without transform, clipping path and opacity are replaced by
+     *   their children. Groups with a single child pass their attributes to
+     *   the child where possible.
+     * - Consecutive sibling graphics with the same solid fill and no stroke
+     *   or clipping path, whose bounds do not overlap, are merged into one
+     *   path and drawn with a single call. Small shapes only get merged if
+     *   the document was parsed with ParseOptions::keepShapeGeometry.
+     * Elements with an XML ID keep rendering the same with /ref Render(const char* id).
+     * Releases all recordings.
+     * @return Element and draw counts of the whole document before and after.
+     */
+    SimplifyStats SimplifyRenderTree();
+
     /**
      * Retrieves the bounds of the SVG Document.
      *
-     * The bounds are as tightly computed as possible. The rendering port's canvas
-     * is used to calculate the bounds so the user must make sure that a context has been
-     * set, otherwise an assertion will fire.
+     * The bounds are computed from the path geometry once after parsing and work with
+     * every port. Curves contribute their exact extrema, strokes are outset by their
+     * width, line join and miter limit, and clipping paths are intersected.
+     * The bounds are in the coordinate system of the viewBox without scaling.
      */
     bool GetBoundingBox(Rect& bounds);
 
     /**
      * Retrieves the bounds of the subtree of an element with the given XML ID.
-     *
-     * The bounds are as tightly computed as possible. The rendering port's canvas
-     * is used to calculate the bounds so the user must make sure that a context has been
-     * set, otherwise an assertion will fire.
+     * See /ref GetBoundingBox(Rect& bounds) for details.
+     * @return false if there is no element with the given XML ID.
      */
     bool GetBoundingBox(const char* id, Rect& bounds);
+
+    /**
+     * Retrieves the bounds of the subtrees of several elements at once.
+     * See /ref GetBoundingBox(Rect& bounds) for details.
+     * @param ids XML IDs of the elements.
+     * @param bounds Receives one Rect per ID in the same order. IDs without an
+     *      element get an empty Rect.
+     * @return false if there is no element for at least one of the IDs.
+     */
+    bool GetBoundingBoxes(const std::vector<std::string>& ids, std::vector<Rect>& bounds);
     
     void GetViewBox(Rect& viewBox);
     
@@ -16,6 +16,8 @@ governing permissions and limitations under the License.
 #include "Config.h"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <memory>
@@ -149,6 +151,14 @@ struct Gradient
     std::shared_ptr<Transform> transform; /** Joined transformation matrix based to the "transform" attribute. **/
 };
 
+/**
+ * Appends the value of a gradient drawn with opacity to key, for ports that
+ * cache gradient resources. Gradients get resolved for every draw, so they
+ * are compared by value. NaN coordinates of unused attributes compare equal
+ * as bytes. The transform is opaque, ports append its matrix themselves.
+ */
+SVG_IMP_EXP void AppendGradientKey(std::string& key, const Gradient& gradient, float opacity);
+
 /**
  * Stroke style information.
  */
@@ -191,6 +201,17 @@ public:
     virtual void Concat(float a, float b, float c, float d, float tx, float ty) = 0;
 };
 
+/**
+ * Axis-aligned rectangle of a clipping path.
+ */
+struct ClipRect
+{
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+};
+
 struct ClippingPath
 {
     ClippingPath(bool aHasClipContent, WindingRule aClipRule, std::shared_ptr<Path> aPath, std::shared_ptr<Transform> aTransform)
@@ -204,6 +225,8 @@ struct ClippingPath
     WindingRule clipRule = WindingRule::kNonZero;
     std::shared_ptr<Path> path; /** Clipping path. **/
     std::shared_ptr<Transform> transform; /** Joined transformation matrix based to the "transform" attribute. **/
+    bool isRect = false; /** True if path with transform is the axis-aligned rectangle clipRect. Ports can clip to clipRect directly then. **/
+    ClipRect clipRect; /** Clipping rectangle with transform already applied. Only valid if isRect is set. **/
 };
 
 /**
@@ -215,6 +238,19 @@ struct GraphicStyle
     float opacity = 1.0; /** Corresponds to the "opacity" CSS property. **/
     std::shared_ptr<Transform> transform; /** Joined transformation matrix based to the "transform" attribute. **/
     std::shared_ptr<ClippingPath> clippingPath;
+    bool needsSave = true; /** False if there is neither a transform nor a clipping path. Ports that apply the opacity to their paints can draw without saving their state then. **/
+};
+
+/**
+ * Segment types of Path::Append and the number of points they consume.
+ */
+enum class PathVerb : std::uint8_t
+{
+    kMove, /** 1 point, see Path::MoveTo. **/
+    kLine, /** 1 point, see Path::LineTo. **/
+    kCurve, /** 3 points, see Path::CurveTo. **/
+    kQuadCurve, /** 2 points, see Path::CurveToV. **/
+    kClose /** No points, see Path::ClosePath. **/
 };
 
 /**
@@ -234,6 +270,25 @@ public:
     virtual void CurveTo(float x1, float y1, float x2, float y2, float x3, float y3) = 0;
     virtual void CurveToV(float x2, float y2, float x3, float y3) = 0;
     virtual void ClosePath() = 0;
+
+    /**
+     * Appends many segments at once.
+     * The default implementation calls the functions above for each segment.
+     * Ports override it to reserve their storage once and to avoid a virtual
+     * call per segment.
+     * @param verbs PathVerb values.
+     * @param points x and y coordinates of \p pointCount points, consumed by
+     *      the verbs in order. Verbs without enough points left are ignored.
+     */
+    virtual void Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount);
+
+    /**
+     * The fill rule the path is usually drawn with, set once the path is
+     * built. Ports whose paths carry the fill rule store it here instead of
+     * setting it on every draw. Draw calls still pass the fill rule to use.
+     * The default implementation ignores it.
+     */
+    virtual void SetFillRule(WindingRule /*fillRule*/) {}
 };
 
 /**
@@ -250,6 +305,16 @@ public:
     virtual float Height() const = 0;
 };
 
+/**
+ * A native vector recording of drawing calls, e.g. a picture or a recording
+ * surface. Created by ports that support recordings.
+ **/
+class Recording
+{
+public:
+    virtual ~Recording() = default;
+};
+
 /**
  * Base class for deriving, platform dependent renderer classes with immediate
  * graphic library calls.
@@ -271,6 +336,25 @@ public:
         const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) = 0;
     virtual void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) = 0;
     virtual Rect GetBounds(const Path&, const GraphicStyle&, const FillStyle&, const StrokeStyle&);
+
+    /**
+     * Redirects all following drawing calls into a new vector recording until
+     * EndRecording() is called. Ports without recording support return false
+     * and keep drawing to their target. Recordings nest: the core records
+     * instanced <use> content while the whole document gets recorded.
+     * @param bounds Area that the recorded drawing calls are expected to cover.
+     */
+    virtual bool BeginRecording(const Rect& bounds);
+    /**
+     * Finishes the recording started by BeginRecording() and restores the
+     * previous drawing target.
+     */
+    virtual std::unique_ptr<Recording> EndRecording();
+    /**
+     * Replays a recording created by this port with transform applied on top
+     * of the current transformation matrix.
+     */
+    virtual void DrawRecording(const Recording& recording, const Transform& transform);
 };
 
 class SaveRestoreHelper
@@ -0,0 +1,123 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_CairoRasterCache_h
+#define SVGViewer_CairoRasterCache_h
+
+#include "svgnative/SVGRenderer.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SVGNative
+{
+
+/**
+ * Thread-safe in-process cache of rasterized SVG documents.
+ *
+ * Rasters are keyed by a fingerprint of the SVG source, the XML ID of the
+ * rendered element, the pixel size and the color map. If the summed size of
+ * all rasters exceeds the byte budget, the least recently used rasters are
+ * evicted. Rendering happens outside of the cache lock with a private
+ * SVGDocument and CairoSVGRenderer per miss.
+ */
+class SVG_IMP_EXP CairoRasterCache
+{
+public:
+    /**
+     * Premultiplied ARGB32 pixels in native byte order, as used by
+     * CAIRO_FORMAT_ARGB32.
+     */
+    struct Raster
+    {
+        int width{};
+        int height{};
+        int stride{};
+        std::vector<std::uint8_t> pixels;
+    };
+
+    struct Stats
+    {
+        std::uint64_t hits{};
+        std::uint64_t misses{};
+        std::uint64_t evictions{};
+        size_t entries{};
+        size_t bytes{};
+    };
+
+    /**
+     * @param byteBudget Maximal summed size of all cached pixel buffers.
+     */
+    CairoRasterCache(size_t byteBudget);
+
+    /**
+     * Fingerprint of an SVG source. Callers that look up the same document
+     * often can compute it once and use the Get() overload that takes it.
+     */
+    static std::uint64_t Fingerprint(const std::string& svgSource);
+
+    /**
+     * Returns the raster of a document or of the subtree of an element,
+     * scaled like SVGDocument::Render(width, height). Renders and caches
+     * the raster on a miss.
+     * @param svgSource SVG content as string.
+     * @param id XML ID of the element to render, or an empty string for the
+     *      whole document.
+     * @return The raster, or nullptr if the document could not be parsed or
+     *      the size is invalid. Rasters stay valid after eviction.
+     */
+    std::shared_ptr<const Raster> Get(const std::string& svgSource, const std::string& id, int width, int height,
+        const ColorMap& colorMap);
+    std::shared_ptr<const Raster> Get(std::uint64_t fingerprint, const std::string& svgSource, const std::string& id,
+        int width, int height, const ColorMap& colorMap);
+
+    void SetByteBudget(size_t byteBudget);
+    void Clear();
+    Stats GetStats() const;
+
+private:
+    struct Key
+    {
+        std::uint64_t fingerprint;
+        std::string id;
+        int width;
+        int height;
+        ColorMap colorMap;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    using EntryList = std::list<std::pair<Key, std::shared_ptr<const Raster>>>;
+
+    void Evict();
+
+    mutable std::mutex mMutex;
+    // Most recently used first.
+    EntryList mEntries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> mIndex;
+    size_t mByteBudget{};
+    Stats mStats;
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_CairoRasterCache_h
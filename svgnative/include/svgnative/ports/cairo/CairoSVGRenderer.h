@@ -14,21 +14,25 @@ governing permissions and limitations under the License.
 #define SVGViewer_CairoSVGRenderer_h
 
 #include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "svgnative/SVGRenderer.h"
 #include "cairo.h"
 
 namespace SVGNative
 {
 
-  // SkiaSVGPath object is able to be amended, but Cairo has no API to append something
-  // to existing cairo_path_t object. Thus, we hold cairo_t object. Its surface could
-  // be retrieved in later, by cairo_get_target().
+  // Cairo has no API to append something to an existing cairo_path_t object.
+  // Thus, we record the path data in the same layout as cairo_path_t ourselves,
+  // so that it can be passed to cairo_append_path() without any copy.
 
 class CairoSVGPath final : public Path
 {
 public:
-    CairoSVGPath();
-    ~CairoSVGPath();
+    CairoSVGPath() = default;
 
     void Rect(float x, float y, float width, float height) override;
     void RoundedRect(float x, float y, float width, float height, float rx, float ry) override;
@@ -40,11 +44,27 @@ public:
     void CurveToV(float x2, float y2, float x3, float y3) override;
     void ClosePath() override;
 
-    cairo_t* mPathCtx{};
+    void Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount) override;
+
+    // Appends the path to the current path of cr.
+    void AppendTo(cairo_t* cr) const;
+
+    // Appends the path transformed by matrix to the current path of cr. Used
+    // for clipping paths, which carry their own transform.
+    void AppendTransformedTo(cairo_t* cr, const cairo_matrix_t& matrix) const;
+
+    std::vector<cairo_path_data_t> mData;
 
 private:
+    void AddHeader(cairo_path_data_type_t type, int length);
+    void AddPoint(double x, double y);
+    void ArcTo(double cx, double cy, double rx, double ry, double angle1, double angle2);
+
     float mCurrentX{};
     float mCurrentY{};
+    float mSubpathX{};
+    float mSubpathY{};
+    bool mHasCurrentPoint{};
 };
 
 class CairoSVGTransform final : public Transform
@@ -71,8 +91,36 @@ public:
 
     float Height() const override;
 
+    /**
+     * The image at mip level \p level, downscaled by 2^level. JPEG images
+     * get downscaled while decoding. Levels are decoded on first use and
+     * stay cached. Level 0 carries the encoded image as MIME data.
+     * @return The surface, owned by the image, or nullptr if decoding
+     *      failed.
+     */
+    cairo_surface_t* Level(int level) const;
 
-    cairo_surface_t* mImageData{};
+private:
+    cairo_surface_t* CreateLevel(int level) const;
+
+    // Encoded image, shared with the MIME data of level 0.
+    std::shared_ptr<unsigned char> mEncoded;
+    size_t mEncodedSize{};
+    ImageEncoding mEncoding;
+    int mWidth{};
+    int mHeight{};
+
+    mutable std::mutex mLevelsMutex;
+    mutable std::vector<cairo_surface_t*> mLevels;
+};
+
+class CairoSVGRecording final : public Recording
+{
+public:
+    CairoSVGRecording(cairo_surface_t* surface);
+    ~CairoSVGRecording() override;
+
+    cairo_surface_t* mSurface{};
 };
 
 class SVG_IMP_EXP CairoSVGRenderer final : public SVGRenderer
@@ -97,10 +145,38 @@ public:
     void DrawPath(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) override;
     void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override;
 
+    bool BeginRecording(const Rect& bounds) override;
+    std::unique_ptr<Recording> EndRecording() override;
+    void DrawRecording(const Recording& recording, const Transform& transform) override;
+
     void SetCairo(cairo_t* cairo);
 
+    /**
+     * Gradient patterns are cached and reused across draws and frames. If more
+     * than capacity different gradients are in use, the least recently used
+     * patterns get destroyed. 0 disables the cache.
+     */
+    void SetGradientCacheCapacity(size_t capacity);
+
 private:
+    void SetSource(const Paint& paint, float opacity);
+    cairo_pattern_t* GradientPattern(const Gradient& gradient, float opacity);
+
     cairo_t* mCairo{};
+    // Targets of the drawing calls before each recording in progress,
+    // innermost last. Recordings nest for instanced <use> content.
+    std::vector<cairo_t*> mRecordingTargets;
+
+    // Scratch buffers, kept to avoid allocations while drawing.
+    std::vector<double> mDashes;
+    std::string mPatternKey;
+
+    // LRU cache of gradient patterns, most recently used first. The key holds
+    // the bytes of the resolved gradient and the opacity.
+    using PatternList = std::list<std::pair<std::string, cairo_pattern_t*>>;
+    PatternList mPatterns;
+    std::unordered_map<std::string, PatternList::iterator> mPatternIndex;
+    size_t mPatternCapacity{64};
 };
 
 } // namespace SVGNative
@@ -0,0 +1,80 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_CairoTiledRasterizer_h
+#define SVGViewer_CairoTiledRasterizer_h
+
+#include "svgnative/SVGRenderer.h"
+#include "cairo.h"
+
+#include <functional>
+#include <string>
+
+namespace SVGNative
+{
+
+/**
+ * Rasterizes one SVG document into a large ARGB32 image by splitting the output
+ * into tiles and rendering the tiles in parallel.
+ *
+ * Every worker thread parses its own SVGDocument with its own CairoSVGRenderer,
+ * so no rendering state is shared between threads. Tiles are distributed over
+ * per-worker queues; idle workers steal tiles from the other queues.
+ * Every tile renders with the tile as viewport, so subtrees outside of the
+ * tile are skipped before any path geometry is sent to Cairo.
+ */
+class SVG_IMP_EXP CairoTiledRasterizer
+{
+public:
+    /**
+     * Called once per finished tile. Calls are serialized, but may happen
+     * on any worker thread. The tile surface is only valid during the call.
+     * @param x Horizontal offset of the tile in the output image.
+     * @param y Vertical offset of the tile in the output image.
+     * @param tile ARGB32 image surface with the rendered tile.
+     */
+    using TileCallback = std::function<void(int x, int y, cairo_surface_t* tile)>;
+
+    /**
+     * @param svgSource SVG content as string. Parsed once per worker thread.
+     * @param threadCount Number of worker threads. 0 uses all hardware threads.
+     */
+    CairoTiledRasterizer(std::string svgSource, unsigned int threadCount = 0);
+
+    void SetTileSize(int tileSize) { mTileSize = tileSize > 0 ? tileSize : mTileSize; }
+    int TileSize() const { return mTileSize; }
+    unsigned int ThreadCount() const { return mThreadCount; }
+
+    /**
+     * Renders the document scaled uniformly into width x height pixels and streams
+     * every finished tile to callback.
+     * @return false if the document could not be parsed or a tile surface could
+     *      not be created.
+     */
+    bool Render(const ColorMap& colorMap, int width, int height, const TileCallback& callback);
+
+    /**
+     * Renders the document scaled uniformly into width x height pixels and
+     * assembles all tiles into one image surface.
+     * @return New ARGB32 image surface owned by the caller, or nullptr on failure.
+     */
+    cairo_surface_t* RenderToSurface(const ColorMap& colorMap, int width, int height);
+
+private:
+    std::string mSource;
+    unsigned int mThreadCount{};
+    int mTileSize{512};
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_CairoTiledRasterizer_h
@@ -0,0 +1,160 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_RasterSVGRenderer_h
+#define SVGViewer_RasterSVGRenderer_h
+
+#include "svgnative/SVGRenderer.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SVGNative
+{
+
+enum class RasterVerb : std::uint8_t
+{
+    kMoveTo, /** 1 point **/
+    kLineTo, /** 1 point **/
+    kCurveTo, /** 3 points **/
+    kClose /** no points **/
+};
+
+class RasterSVGPath final : public Path
+{
+public:
+    RasterSVGPath() = default;
+
+    void Rect(float x, float y, float width, float height) override;
+    void RoundedRect(float x, float y, float width, float height, float rx, float ry) override;
+    void Ellipse(float cx, float cy, float rx, float ry) override;
+
+    void MoveTo(float x, float y) override;
+    void LineTo(float x, float y) override;
+    void CurveTo(float x1, float y1, float x2, float y2, float x3, float y3) override;
+    void CurveToV(float x2, float y2, float x3, float y3) override;
+    void ClosePath() override;
+
+    // Bounding box of all points, including control points. Computed on
+    // first use.
+    void Extents(float& x1, float& y1, float& x2, float& y2) const;
+
+    std::vector<RasterVerb> mVerbs;
+    std::vector<float> mPoints; /** x, y pairs **/
+
+private:
+    void AddPoint(float x, float y);
+    void ArcTo(float cx, float cy, float rx, float ry, float angle1, float angle2, bool connect);
+
+    float mCurrentX{};
+    float mCurrentY{};
+    float mSubpathX{};
+    float mSubpathY{};
+
+    mutable bool mHasExtents{};
+    mutable float mExtents[4]{};
+};
+
+class RasterSVGTransform final : public Transform
+{
+public:
+    RasterSVGTransform(float aA, float aB, float aC, float aD, float aE, float aF);
+
+    void Set(float a, float b, float c, float d, float tx, float ty) override;
+    void Rotate(float r) override;
+    void Translate(float tx, float ty) override;
+    void Scale(float sx, float sy) override;
+    void Concat(float a, float b, float c, float d, float tx, float ty) override;
+
+    float a{1};
+    float b{0};
+    float c{0};
+    float d{1};
+    float e{0};
+    float f{0};
+};
+
+/**
+ * Decoded image. Pixels are premultiplied RGBA, 8 bits per channel, without
+ * row padding.
+ */
+class RasterSVGImageData final : public ImageData
+{
+public:
+    RasterSVGImageData() = default;
+
+    float Width() const override { return static_cast<float>(mWidth); }
+    float Height() const override { return static_cast<float>(mHeight); }
+
+    int mWidth{};
+    int mHeight{};
+    std::vector<std::uint8_t> mPixels;
+};
+
+/**
+ * Dependency free software renderer. Draws with anti-aliasing into a caller
+ * provided buffer of premultiplied RGBA pixels, 8 bits per channel.
+ *
+ * The port does not decode PNG or JPEG itself. Images are drawn only if an
+ * image decoder was set before the document was created.
+ */
+class SVG_IMP_EXP RasterSVGRenderer final : public SVGRenderer
+{
+public:
+    /**
+     * Decodes the image file in data into image. Returns false if the data
+     * could not be decoded.
+     */
+    using ImageDecoder = std::function<bool(const std::string& data, ImageEncoding encoding, RasterSVGImageData& image)>;
+
+    RasterSVGRenderer();
+    ~RasterSVGRenderer();
+
+    std::unique_ptr<ImageData> CreateImageData(const std::string& base64, ImageEncoding encoding) override;
+
+    std::unique_ptr<Path> CreatePath() override { return std::unique_ptr<RasterSVGPath>(new RasterSVGPath); }
+
+    std::unique_ptr<Transform> CreateTransform(
+        float a = 1.0, float b = 0.0, float c = 0.0, float d = 1.0, float tx = 0.0, float ty = 0.0) override
+    {
+        return std::unique_ptr<RasterSVGTransform>(new RasterSVGTransform(a, b, c, d, tx, ty));
+    }
+
+    void Save(const GraphicStyle& graphicStyle) override;
+    void Restore() override;
+
+    void DrawPath(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) override;
+    void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override;
+
+    /**
+     * Sets the buffer to draw into. The buffer must stay valid until the
+     * next call or until the renderer is destroyed.
+     * @param pixels Premultiplied RGBA pixels, 8 bits per channel.
+     * @param stride Bytes per row, at least 4 * width.
+     */
+    void SetTarget(std::uint8_t* pixels, int width, int height, int stride);
+
+    void SetImageDecoder(ImageDecoder decoder) { mImageDecoder = std::move(decoder); }
+
+private:
+    class Context;
+
+    std::unique_ptr<Context> mContext;
+    ImageDecoder mImageDecoder;
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_RasterSVGRenderer_h
@@ -15,7 +15,20 @@ governing permissions and limitations under the License.
 
 #include "svgnative/SVGRenderer.h"
 #include "svgnative/Rect.h"
+#include "SkData.h"
+#include "SkEncodedOrigin.h"
+#include "SkPaint.h"
 #include "SkPath.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
+#include "SkShader.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 struct SkRect;
 class SkCanvas;
@@ -38,6 +51,17 @@ public:
     void CurveToV(float x2, float y2, float x3, float y3) override;
     void ClosePath() override;
 
+    void Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount) override;
+
+    void SetFillRule(WindingRule fillRule) override;
+
+    /**
+     * The path with the fill type of \p fillRule. Returns the stored path if
+     * it already has that fill type, otherwise \p copy set to it. The copy
+     * shares the point data with the stored path.
+     */
+    const SkPath& WithFillRule(WindingRule fillRule, SkPath& copy) const;
+
     SkPath mPath;
 
 private:
@@ -69,7 +93,36 @@ public:
 
     float Height() const override;
 
-    sk_sp<SkImage> mImageData;
+    /**
+     * The image at mip level \p level, downscaled by 2^level and oriented.
+     * Codecs that support it downscale while decoding. Levels are decoded
+     * on first use and stay cached.
+     * @return The image, or nullptr if decoding failed.
+     */
+    sk_sp<SkImage> Level(int level) const;
+
+private:
+    sk_sp<SkImage> CreateLevel(int level) const;
+
+    sk_sp<SkData> mEncoded;
+    SkEncodedOrigin mOrigin{kDefault_SkEncodedOrigin};
+    // Size of the encoded image, before orientation.
+    int mEncodedWidth{};
+    int mEncodedHeight{};
+    // Size of the oriented image.
+    int mWidth{};
+    int mHeight{};
+
+    mutable std::mutex mLevelsMutex;
+    mutable std::vector<sk_sp<SkImage>> mLevels;
+};
+
+class SkiaSVGRecording final : public Recording
+{
+public:
+    SkiaSVGRecording(sk_sp<SkPicture> picture);
+
+    sk_sp<SkPicture> mPicture;
 };
 
 class SVG_IMP_EXP SkiaSVGRenderer final : public SVGRenderer
@@ -94,10 +147,47 @@ public:
     void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override;
     Rect GetBounds(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) override;
 
+    bool BeginRecording(const Rect& bounds) override;
+    std::unique_ptr<Recording> EndRecording() override;
+    void DrawRecording(const Recording& recording, const Transform& transform) override;
+
     void SetSkCanvas(SkCanvas* canvas);
 
+    /**
+     * Gradient shaders are cached and reused across draws and frames. If more
+     * than capacity different gradients are in use, the least recently used
+     * shaders get released. 0 disables the cache.
+     */
+    void SetGradientCacheCapacity(size_t capacity);
+
 private:
+    void Save(const GraphicStyle& graphicStyle, bool opacityLayer);
+    void SetPaint(const Paint& paint, float opacity, SkPaint& skPaint);
+    sk_sp<SkShader> GradientShader(const Gradient& gradient, float opacity);
+
     SkCanvas* mCanvas;
+    // Targets of the drawing calls before each recording in progress,
+    // innermost last. Recordings nest for instanced <use> content.
+    std::vector<SkCanvas*> mRecordingTargets;
+    std::vector<std::unique_ptr<SkPictureRecorder>> mRecorders;
+
+    // Reused for every draw. Only the properties that differ between
+    // draws get updated.
+    SkPaint mFillPaint;
+    SkPaint mStrokePaint;
+    SkPaint mImagePaint;
+
+    // Scratch buffers, kept to avoid allocations while drawing.
+    std::vector<SkColor> mColors;
+    std::vector<SkScalar> mPositions;
+    std::string mShaderKey;
+
+    // LRU cache of gradient shaders, most recently used first. The key holds
+    // the bytes of the resolved gradient and the opacity.
+    using ShaderList = std::list<std::pair<std::string, sk_sp<SkShader>>>;
+    ShaderList mShaders;
+    std::unordered_map<std::string, ShaderList::iterator> mShaderIndex;
+    size_t mShaderCapacity{64};
 };
 
 } // namespace SVGNative
@@ -0,0 +1,149 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_StreamSVGRenderer_h
+#define SVGViewer_StreamSVGRenderer_h
+
+#include "svgnative/SVGRenderer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SVGNative
+{
+
+enum class StreamVerb : std::uint8_t
+{
+    kRect, /** x, y, width, height **/
+    kRoundedRect, /** x, y, width, height, rx, ry **/
+    kEllipse, /** cx, cy, rx, ry **/
+    kMoveTo, /** x, y **/
+    kLineTo, /** x, y **/
+    kCurveTo, /** x1, y1, x2, y2, x3, y3 **/
+    kCurveToV, /** x2, y2, x3, y3 **/
+    kClosePath /** no values **/
+};
+
+/**
+ * Path calls as recorded, so that the player can repeat them on the path of
+ * another port.
+ */
+class StreamSVGPath final : public Path
+{
+public:
+    StreamSVGPath();
+
+    void Rect(float x, float y, float width, float height) override;
+    void RoundedRect(float x, float y, float width, float height, float rx, float ry) override;
+    void Ellipse(float cx, float cy, float rx, float ry) override;
+
+    void MoveTo(float x, float y) override;
+    void LineTo(float x, float y) override;
+    void CurveTo(float x1, float y1, float x2, float y2, float x3, float y3) override;
+    void CurveToV(float x2, float y2, float x3, float y3) override;
+    void ClosePath() override;
+
+    std::vector<StreamVerb> mVerbs;
+    std::vector<float> mValues;
+    const std::uint64_t mSerial; /** Unique for the lifetime of the process. **/
+};
+
+class StreamSVGImageData final : public ImageData
+{
+public:
+    StreamSVGImageData(const std::string& base64, ImageEncoding encoding);
+
+    /**
+     * Dimensions from the PNG or JPEG header. 0 if the header is invalid,
+     * in which case the image does not get drawn.
+     */
+    float Width() const override { return mWidth; }
+    float Height() const override { return mHeight; }
+
+    std::string mBase64;
+    ImageEncoding mEncoding;
+    float mWidth{};
+    float mHeight{};
+    const std::uint64_t mSerial; /** Unique for the lifetime of the process. **/
+};
+
+/**
+ * Serializes all drawing calls into a compact binary stream, for example
+ * to render in one process and draw with another port in another process.
+ * Paths and images get written once per stream and are referenced by
+ * index afterwards. Replay the stream with PlayStream().
+ *
+ * Streams are self-contained: Clear() starts a new one. Paints of disabled
+ * fills and strokes are not written.
+ */
+class SVG_IMP_EXP StreamSVGRenderer final : public SVGRenderer
+{
+public:
+    StreamSVGRenderer();
+
+    std::unique_ptr<ImageData> CreateImageData(const std::string& base64, ImageEncoding encoding) override;
+
+    std::unique_ptr<Path> CreatePath() override;
+
+    std::unique_ptr<Transform> CreateTransform(
+        float a = 1.0, float b = 0.0, float c = 0.0, float d = 1.0, float tx = 0.0, float ty = 0.0) override;
+
+    void Save(const GraphicStyle& graphicStyle) override;
+    void Restore() override;
+
+    void DrawPath(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) override;
+    void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override;
+
+    /**
+     * The stream written so far, starting with its header.
+     */
+    const std::vector<std::uint8_t>& Stream() const { return mStream; }
+
+    /**
+     * Drops the stream and starts a new one. Paths and images get written
+     * again on their next use.
+     */
+    void Clear();
+
+private:
+    std::uint32_t PathIndex(const Path& path);
+    std::uint32_t ImageIndex(const ImageData& image);
+
+    void DefineClippingPath(const GraphicStyle& graphicStyle);
+    void WriteGraphic(const GraphicStyle& graphicStyle);
+    void WriteFill(const FillStyle& fillStyle);
+    void WriteStroke(const StrokeStyle& strokeStyle);
+    void WritePaint(const Paint& paint);
+    void WriteTransform(const Transform& transform);
+
+    std::vector<std::uint8_t> mStream;
+    std::unordered_map<std::uint64_t, std::uint32_t> mPathIndices;
+    std::unordered_map<std::uint64_t, std::uint32_t> mImageIndices;
+};
+
+/**
+ * Replays a stream of StreamSVGRenderer on renderer. Paths, transforms and
+ * images get created with renderer.
+ *
+ * Streams may come from untrusted processes. Malformed data never gets
+ * read past size.
+ * @return false if the stream is malformed. Playing stops at the first
+ *      error, all states saved until then get restored.
+ */
+SVG_IMP_EXP bool PlayStream(const std::uint8_t* data, std::size_t size, SVGRenderer& renderer);
+
+} // namespace SVGNative
+
+#endif // SVGViewer_StreamSVGRenderer_h
@@ -121,6 +121,8 @@ public:
     void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override;
 
     std::string String() const;
+    // Drops everything written so far.
+    void Clear();
 
 private:
     void IncIndent();
@@ -0,0 +1,197 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "Base64.h"
+
+#include <array>
+#include <cctype>
+
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_MSC_VER) && (defined(__x86_64__) || defined(__i386__))
+#define SVG_BASE64_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+namespace SVGNative
+{
+
+namespace
+{
+constexpr std::uint32_t kInvalid{0x01000000};
+
+// One table per position in a quantum of 4 characters, with the 6 bits of
+// the character already shifted into place. Characters outside of the
+// alphabet have kInvalid set, so that 4 characters decode with one OR.
+struct DecodeTables
+{
+    DecodeTables()
+    {
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (auto& table : tables)
+            table.fill(kInvalid);
+        for (std::uint32_t i = 0; i < 64; ++i)
+        {
+            const auto c = static_cast<unsigned char>(alphabet[i]);
+            tables[0][c] = i << 18;
+            tables[1][c] = i << 12;
+            tables[2][c] = i << 6;
+            tables[3][c] = i;
+        }
+    }
+
+    std::array<std::array<std::uint32_t, 256>, 4> tables;
+};
+
+const DecodeTables& Tables()
+{
+    static const DecodeTables decodeTables;
+    return decodeTables;
+}
+
+#ifdef SVG_BASE64_SSSE3
+// Decodes 16 characters to 12 bytes and writes 16 bytes. Translation and
+// validation with nibble lookups as described by Wojciech Muła in
+// "Base64 decoding with SIMD instructions".
+__attribute__((target("ssse3"))) bool DecodeBlockSSSE3(const char* base64, std::uint8_t* data)
+{
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2f);
+
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base64));
+    const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), mask2F);
+    const __m128i loNibbles = _mm_and_si128(chars, mask2F);
+    const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+    const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xffff)
+        return false;
+
+    // '/' shares its high nibble with '+'.
+    const __m128i eq2F = _mm_cmpeq_epi8(chars, mask2F);
+    const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+    chars = _mm_add_epi8(chars, roll);
+
+    // Pack 4 x 6 bits into 3 bytes per 32 bit lane, then drop the gaps.
+    const __m128i merged = _mm_maddubs_epi16(chars, _mm_set1_epi32(0x01400140));
+    const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    const __m128i bytes = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), bytes);
+    return true;
+}
+
+bool HasSSSE3()
+{
+    static const bool hasSSSE3 = __builtin_cpu_supports("ssse3");
+    return hasSSSE3;
+}
+#endif
+} // namespace
+
+bool DecodeBase64(const char* base64, std::size_t length, std::uint8_t* data, std::size_t& size)
+{
+    const auto& tables = Tables().tables;
+    const char* c = base64;
+    const char* end = base64 + length;
+    std::uint8_t* out = data;
+    size = 0;
+
+#ifdef SVG_BASE64_SSSE3
+    const bool useSSSE3 = HasSSSE3();
+#endif
+    while (c != end)
+    {
+#ifdef SVG_BASE64_SSSE3
+        // A block writes 4 bytes more than it decodes. 24 remaining
+        // characters guarantee that they fit into the buffer.
+        if (useSSSE3)
+        {
+            while (end - c >= 24 && DecodeBlockSSSE3(c, out))
+            {
+                c += 16;
+                out += 12;
+            }
+        }
+#endif
+        while (end - c >= 4)
+        {
+            const std::uint32_t bits = tables[0][static_cast<unsigned char>(c[0])] | tables[1][static_cast<unsigned char>(c[1])]
+                | tables[2][static_cast<unsigned char>(c[2])] | tables[3][static_cast<unsigned char>(c[3])];
+            if (bits & kInvalid)
+                break;
+            out[0] = static_cast<std::uint8_t>(bits >> 16);
+            out[1] = static_cast<std::uint8_t>(bits >> 8);
+            out[2] = static_cast<std::uint8_t>(bits);
+            c += 4;
+            out += 3;
+        }
+        if (c == end)
+            break;
+
+        // White space, padding or the last quantum. Decode character by
+        // character up to the end of the next complete quantum.
+        std::uint32_t bits{};
+        int count{};
+        for (; c != end; ++c)
+        {
+            if (*c == '=')
+            {
+                c = end;
+                break;
+            }
+            const std::uint32_t value = tables[3][static_cast<unsigned char>(*c)];
+            if (value & kInvalid)
+            {
+                if (std::isspace(static_cast<unsigned char>(*c)))
+                    continue;
+                return false;
+            }
+            bits = (bits << 6) | value;
+            if (++count == 4)
+            {
+                ++c;
+                break;
+            }
+        }
+        // 2 characters decode to 1 byte, 3 characters to 2 bytes.
+        if (count == 4)
+        {
+            out[0] = static_cast<std::uint8_t>(bits >> 16);
+            out[1] = static_cast<std::uint8_t>(bits >> 8);
+            out[2] = static_cast<std::uint8_t>(bits);
+            out += 3;
+        }
+        else if (count == 3)
+        {
+            out[0] = static_cast<std::uint8_t>(bits >> 10);
+            out[1] = static_cast<std::uint8_t>(bits >> 2);
+            out += 2;
+        }
+        else if (count == 2)
+        {
+            out[0] = static_cast<std::uint8_t>(bits >> 4);
+            out += 1;
+        }
+    }
+    size = static_cast<std::size_t>(out - data);
+    return true;
+}
+
+bool DecodeBase64(const std::string& base64, std::string& data)
+{
+    data.resize(DecodedBase64Size(base64.size()));
+    std::size_t size{};
+    const bool result = DecodeBase64(base64.data(), base64.size(), reinterpret_cast<std::uint8_t*>(&data[0]), size);
+    data.resize(size);
+    return result;
+}
+
+} // namespace SVGNative
@@ -0,0 +1,45 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_Base64_h
+#define SVGViewer_Base64_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SVGNative
+{
+/**
+ * Maximal number of bytes decoded from length base64 characters.
+ */
+inline std::size_t DecodedBase64Size(std::size_t length) { return (length + 3) / 4 * 3; }
+
+/**
+ * Decodes base64 with the standard alphabet straight into the buffer of
+ * the caller. White space gets skipped, decoding stops at the first
+ * padding character. Runs of 16 characters without white space get
+ * decoded with SSSE3 on CPUs that support it.
+ * @param data Receives the decoded bytes. Must hold at least
+ *      DecodedBase64Size(length) bytes.
+ * @param size Receives the number of decoded bytes.
+ * @return false on any other character.
+ */
+bool DecodeBase64(const char* base64, std::size_t length, std::uint8_t* data, std::size_t& size);
+
+/**
+ * See DecodeBase64(const char*, std::size_t, std::uint8_t*, std::size_t&).
+ */
+bool DecodeBase64(const std::string& base64, std::string& data);
+} // namespace SVGNative
+
+#endif // SVGViewer_Base64_h
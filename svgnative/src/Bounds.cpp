@@ -0,0 +1,301 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SVGNative
+{
+namespace
+{
+// Real roots of a * t^2 + b * t + c = 0. Degenerates to the linear case.
+int SolveQuadratic(double a, double b, double c, double roots[2])
+{
+    constexpr double kEpsilon = 1e-12;
+    if (std::abs(a) < kEpsilon)
+    {
+        if (std::abs(b) < kEpsilon)
+            return 0;
+        roots[0] = -c / b;
+        return 1;
+    }
+    const double discriminant = b * b - 4 * a * c;
+    if (discriminant < 0)
+        return 0;
+    // Avoid cancellation, see Numerical Recipes 5.6.
+    const double q = -0.5 * (b + std::copysign(std::sqrt(discriminant), b));
+    roots[0] = q / a;
+    if (q == 0)
+        return 1;
+    roots[1] = c / q;
+    return 2;
+}
+} // namespace
+
+Bounds::Bounds(float aMinX, float aMinY, float aMaxX, float aMaxY)
+    : minX{aMinX}
+    , minY{aMinY}
+    , maxX{aMaxX}
+    , maxY{aMaxY}
+{
+}
+
+Bounds Bounds::Infinite()
+{
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    return Bounds{-inf, -inf, inf, inf};
+}
+
+Bounds Bounds::FromRect(const SVGNative::Rect& rect)
+{
+    return Bounds{rect.x, rect.y, rect.x + rect.width, rect.y + rect.height};
+}
+
+void Bounds::Add(float x, float y)
+{
+    minX = std::min(minX, x);
+    minY = std::min(minY, y);
+    maxX = std::max(maxX, x);
+    maxY = std::max(maxY, y);
+}
+
+void Bounds::Add(const Bounds& other)
+{
+    if (other.IsEmpty())
+        return;
+    minX = std::min(minX, other.minX);
+    minY = std::min(minY, other.minY);
+    maxX = std::max(maxX, other.maxX);
+    maxY = std::max(maxY, other.maxY);
+}
+
+void Bounds::Outset(float distance)
+{
+    if (IsEmpty())
+        return;
+    minX -= distance;
+    minY -= distance;
+    maxX += distance;
+    maxY += distance;
+}
+
+Bounds Bounds::Intersection(const Bounds& other) const
+{
+    return Bounds{std::max(minX, other.minX), std::max(minY, other.minY), std::min(maxX, other.maxX), std::min(maxY, other.maxY)};
+}
+
+bool Bounds::Intersects(const Bounds& other) const
+{
+    return !IsEmpty() && !other.IsEmpty() && minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+}
+
+Rect Bounds::ToRect() const
+{
+    if (IsEmpty() || IsInfinite())
+        return SVGNative::Rect{0, 0, 0, 0};
+    return SVGNative::Rect{minX, minY, maxX - minX, maxY - minY};
+}
+
+BoundsRecordingPath::BoundsRecordingPath(Path& target)
+    : mTarget{target}
+{
+}
+
+void BoundsRecordingPath::Rect(float x, float y, float width, float height)
+{
+    mTarget.Rect(x, y, width, height);
+    mBounds.Add(x, y);
+    mBounds.Add(x + width, y + height);
+}
+
+void BoundsRecordingPath::RoundedRect(float x, float y, float width, float height, float cornerRadiusX, float cornerRadiusY)
+{
+    mTarget.RoundedRect(x, y, width, height, cornerRadiusX, cornerRadiusY);
+    mBounds.Add(x, y);
+    mBounds.Add(x + width, y + height);
+}
+
+void BoundsRecordingPath::Ellipse(float cx, float cy, float rx, float ry)
+{
+    mTarget.Ellipse(cx, cy, rx, ry);
+    mBounds.Add(cx - rx, cy - ry);
+    mBounds.Add(cx + rx, cy + ry);
+}
+
+void BoundsRecordingPath::MoveTo(float x, float y)
+{
+    mTarget.MoveTo(x, y);
+    AddMove(x, y);
+}
+
+void BoundsRecordingPath::LineTo(float x, float y)
+{
+    mTarget.LineTo(x, y);
+    AddLine(x, y);
+}
+
+void BoundsRecordingPath::CurveTo(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    mTarget.CurveTo(x1, y1, x2, y2, x3, y3);
+    AddCurve(x1, y1, x2, y2, x3, y3);
+}
+
+void BoundsRecordingPath::CurveToV(float x2, float y2, float x3, float y3)
+{
+    mTarget.CurveToV(x2, y2, x3, y3);
+    AddQuadCurve(x2, y2, x3, y3);
+}
+
+void BoundsRecordingPath::ClosePath()
+{
+    mTarget.ClosePath();
+    AddClose();
+}
+
+void BoundsRecordingPath::Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount)
+{
+    mTarget.Append(verbs, verbCount, points, pointCount);
+    AddSegments(verbs, verbCount, points, pointCount);
+}
+
+void BoundsRecordingPath::AddSegments(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount)
+{
+    // Same rules as Path::Append, so that the bounds match what the target
+    // draws.
+    const float* end = points + 2 * pointCount;
+    for (size_t i = 0; i < verbCount; ++i)
+    {
+        switch (static_cast<PathVerb>(verbs[i]))
+        {
+        case PathVerb::kMove:
+            if (end - points < 2)
+                return;
+            AddMove(points[0], points[1]);
+            points += 2;
+            break;
+        case PathVerb::kLine:
+            if (end - points < 2)
+                return;
+            AddLine(points[0], points[1]);
+            points += 2;
+            break;
+        case PathVerb::kCurve:
+            if (end - points < 6)
+                return;
+            AddCurve(points[0], points[1], points[2], points[3], points[4], points[5]);
+            points += 6;
+            break;
+        case PathVerb::kQuadCurve:
+            if (end - points < 4)
+                return;
+            AddQuadCurve(points[0], points[1], points[2], points[3]);
+            points += 4;
+            break;
+        case PathVerb::kClose:
+            AddClose();
+            break;
+        }
+    }
+}
+
+void BoundsRecordingPath::AddMove(float x, float y)
+{
+    mCurrentX = mSubpathX = x;
+    mCurrentY = mSubpathY = y;
+    mPendingMove = true;
+}
+
+void BoundsRecordingPath::AddLine(float x, float y)
+{
+    AddCurrentPoint();
+    mBounds.Add(x, y);
+    mCurrentX = x;
+    mCurrentY = y;
+}
+
+void BoundsRecordingPath::AddCurve(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    AddCurrentPoint();
+    mBounds.Add(x3, y3);
+
+    const double xs[4] = {mCurrentX, x1, x2, x3};
+    const double ys[4] = {mCurrentY, y1, y2, y3};
+    auto addExtrema = [&](const double* p) {
+        // Roots of the derivative a * t^2 + b * t + c of the cubic Bezier curve.
+        const double a = -p[0] + 3 * p[1] - 3 * p[2] + p[3];
+        const double b = 2 * (p[0] - 2 * p[1] + p[2]);
+        const double c = p[1] - p[0];
+        double roots[2];
+        int rootCount = SolveQuadratic(a, b, c, roots);
+        for (int i = 0; i < rootCount; ++i)
+        {
+            const double t = roots[i];
+            if (t <= 0 || t >= 1)
+                continue;
+            const double mt = 1 - t;
+            auto evaluate = [t, mt](const double* q) {
+                return mt * mt * mt * q[0] + 3 * mt * mt * t * q[1] + 3 * mt * t * t * q[2] + t * t * t * q[3];
+            };
+            mBounds.Add(static_cast<float>(evaluate(xs)), static_cast<float>(evaluate(ys)));
+        }
+    };
+    addExtrema(xs);
+    addExtrema(ys);
+
+    mCurrentX = x3;
+    mCurrentY = y3;
+}
+
+void BoundsRecordingPath::AddQuadCurve(float x2, float y2, float x3, float y3)
+{
+    AddCurrentPoint();
+    mBounds.Add(x3, y3);
+
+    const double xs[3] = {mCurrentX, x2, x3};
+    const double ys[3] = {mCurrentY, y2, y3};
+    auto addExtremum = [&](const double* p) {
+        // Root of the derivative of the quadratic Bezier curve.
+        const double denominator = p[0] - 2 * p[1] + p[2];
+        if (denominator == 0)
+            return;
+        const double t = (p[0] - p[1]) / denominator;
+        if (t <= 0 || t >= 1)
+            return;
+        const double mt = 1 - t;
+        auto evaluate = [t, mt](const double* q) { return mt * mt * q[0] + 2 * mt * t * q[1] + t * t * q[2]; };
+        mBounds.Add(static_cast<float>(evaluate(xs)), static_cast<float>(evaluate(ys)));
+    };
+    addExtremum(xs);
+    addExtremum(ys);
+
+    mCurrentX = x3;
+    mCurrentY = y3;
+}
+
+void BoundsRecordingPath::AddClose()
+{
+    AddCurrentPoint();
+    mCurrentX = mSubpathX;
+    mCurrentY = mSubpathY;
+}
+
+void BoundsRecordingPath::AddCurrentPoint()
+{
+    if (!mPendingMove)
+        return;
+    mBounds.Add(mCurrentX, mCurrentY);
+    mPendingMove = false;
+}
+
+} // namespace SVGNative
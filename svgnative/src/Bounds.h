@@ -0,0 +1,106 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_Bounds_h
+#define SVGViewer_Bounds_h
+
+#include "svgnative/Rect.h"
+#include "svgnative/SVGRenderer.h"
+
+#include <limits>
+
+namespace SVGNative
+{
+/**
+ * Axis aligned bounding box used by the render tree.
+ *
+ * Unlike Rect, Bounds are closed on both ends: a horizontal line has
+ * bounds with a height of 0 that are not empty. A default constructed
+ * Bounds is empty. Infinite bounds intersect everything and are used
+ * whenever geometry can not be determined.
+ */
+struct Bounds
+{
+    Bounds() = default;
+    Bounds(float aMinX, float aMinY, float aMaxX, float aMaxY);
+
+    static Bounds Infinite();
+    static Bounds FromRect(const Rect& rect);
+
+    bool IsEmpty() const { return !(minX <= maxX && minY <= maxY); }
+    bool IsInfinite() const { return minX == -std::numeric_limits<float>::infinity(); }
+
+    void Add(float x, float y);
+    void Add(const Bounds& other);
+    void Outset(float distance);
+    Bounds Intersection(const Bounds& other) const;
+    bool Intersects(const Bounds& other) const;
+
+    /**
+     * Returns an empty Rect{0, 0, 0, 0} for empty or infinite bounds.
+     */
+    Rect ToRect() const;
+
+    float minX{std::numeric_limits<float>::infinity()};
+    float minY{std::numeric_limits<float>::infinity()};
+    float maxX{-std::numeric_limits<float>::infinity()};
+    float maxY{-std::numeric_limits<float>::infinity()};
+};
+
+/**
+ * Path that forwards all segments to a port path while it collects the
+ * tight bounds of the geometry. Curves contribute their end points and
+ * their extrema, not their control points.
+ */
+class BoundsRecordingPath final : public Path
+{
+public:
+    BoundsRecordingPath(Path& target);
+
+    const Bounds& GetBounds() const { return mBounds; }
+
+    void Rect(float x, float y, float width, float height) override;
+    void RoundedRect(float x, float y, float width, float height, float cornerRadiusX, float cornerRadiusY) override;
+    void Ellipse(float cx, float cy, float rx, float ry) override;
+
+    void MoveTo(float x, float y) override;
+    void LineTo(float x, float y) override;
+    void CurveTo(float x1, float y1, float x2, float y2, float x3, float y3) override;
+    void CurveToV(float x2, float y2, float x3, float y3) override;
+    void ClosePath() override;
+
+    void Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount) override;
+
+private:
+    // Update the bounds only.
+    void AddSegments(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount);
+    void AddMove(float x, float y);
+    void AddLine(float x, float y);
+    void AddCurve(float x1, float y1, float x2, float y2, float x3, float y3);
+    void AddQuadCurve(float x2, float y2, float x3, float y3);
+    void AddClose();
+    void AddCurrentPoint();
+
+    Path& mTarget;
+    Bounds mBounds;
+    float mCurrentX{};
+    float mCurrentY{};
+    float mSubpathX{};
+    float mSubpathY{};
+    // A move does not paint anything on its own. The current point only
+    // counts once a segment follows.
+    bool mPendingMove{};
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_Bounds_h
@@ -104,6 +104,7 @@ void SVGDocumentImpl::ApplyCSSStyle(
         ParseGraphicsProperties(graphicStyle, properties);
         ParseFillProperties(fillStyle, properties);
         ParseStrokeProperties(strokeStyle, properties);
+        graphicStyle.needsSave = graphicStyle.transform || graphicStyle.clippingPath;
     }
 }
 
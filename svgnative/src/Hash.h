@@ -0,0 +1,60 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_Hash_h
+#define SVGViewer_Hash_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace SVGNative
+{
+// FNV-1a hashes for cache keys. Not collision resistant, caches compare
+// the hashed content if equal keys must mean equal content.
+
+constexpr std::uint64_t kHashOffset{14695981039346656037ull};
+constexpr std::uint64_t kHashPrime{1099511628211ull};
+
+inline std::uint64_t HashBytes(const void* data, size_t size, std::uint64_t hash = kHashOffset)
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= kHashPrime;
+    }
+    return hash;
+}
+
+/**
+ * Hash of large buffers, e.g. image payloads or SVG sources. Hashes 8 bytes
+ * per multiplication and rotates, so that the high bits of each step reach
+ * the low bits.
+ */
+inline std::uint64_t HashLargeBytes(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    std::uint64_t hash{kHashOffset};
+    size_t i{};
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * kHashPrime;
+        hash = (hash << 31) | (hash >> 33);
+    }
+    return HashBytes(bytes + i, size - i, hash);
+}
+} // namespace SVGNative
+
+#endif // SVGViewer_Hash_h
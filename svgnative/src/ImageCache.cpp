@@ -0,0 +1,194 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ImageCache.h"
+#include "Hash.h"
+
+#include <typeinfo>
+
+namespace SVGNative
+{
+
+namespace
+{
+size_t ImageBytes(const ImageData* image)
+{
+    if (!image || !(image->Width() > 0) || !(image->Height() > 0))
+        return 0;
+    return static_cast<size_t>(image->Width()) * static_cast<size_t>(image->Height()) * 4;
+}
+} // namespace
+
+bool ImageCache::Key::operator==(const Key& other) const
+{
+    return fingerprint == other.fingerprint && size == other.size && encoding == other.encoding
+        && rendererType == other.rendererType;
+}
+
+size_t ImageCache::KeyHash::operator()(const Key& key) const
+{
+    std::uint64_t hash = HashBytes(&key.size, sizeof(key.size), key.fingerprint);
+    hash = HashBytes(&key.encoding, sizeof(key.encoding), hash);
+    return static_cast<size_t>(hash) ^ key.rendererType.hash_code();
+}
+
+ImageCache::ImageCache(size_t byteBudget, unsigned int threadCount)
+    : mByteBudget{byteBudget}
+{
+    for (unsigned int i = 0; i < threadCount; ++i)
+        mWorkers.emplace_back(&ImageCache::Work, this);
+}
+
+ImageCache::~ImageCache()
+{
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+        mStopping = true;
+        mJobs.clear();
+    }
+    mJobsChanged.notify_all();
+    for (auto& worker : mWorkers)
+        worker.join();
+}
+
+std::uint64_t ImageCache::Fingerprint(const std::string& base64)
+{
+    return HashLargeBytes(base64.data(), base64.size());
+}
+
+std::shared_ptr<ImageData> ImageCache::Get(SVGRenderer& renderer, std::uint64_t fingerprint,
+    const std::shared_ptr<const std::string>& base64, ImageEncoding encoding)
+{
+    if (!base64)
+        return nullptr;
+    const Key key{fingerprint, base64->size(), encoding, std::type_index{typeid(renderer)}};
+    std::unique_lock<std::mutex> lock{mMutex};
+    // Another thread decodes the same payload. Wait for it instead of
+    // decoding twice.
+    mDecoded.wait(lock, [&] { return !mPending.count(key); });
+    auto indexIt = mIndex.find(key);
+    if (indexIt != mIndex.end())
+    {
+        // Documents share their payloads with the entry, other documents
+        // with the same payload get compared.
+        const auto& entry = *indexIt->second;
+        if (entry.base64 == base64 || *entry.base64 == *base64)
+        {
+            ++mStats.hits;
+            mEntries.splice(mEntries.begin(), mEntries, indexIt->second);
+            return indexIt->second->image;
+        }
+    }
+    return Decode(lock, key, renderer, base64);
+}
+
+void ImageCache::Prefetch(const std::shared_ptr<SVGRenderer>& renderer, std::uint64_t fingerprint,
+    const std::shared_ptr<const std::string>& base64, ImageEncoding encoding)
+{
+    if (mWorkers.empty() || !renderer || !base64)
+        return;
+    Key key{fingerprint, base64->size(), encoding, std::type_index{typeid(*renderer)}};
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+        if (mIndex.count(key) || mPending.count(key))
+            return;
+        mJobs.push_back(Job{std::move(key), renderer, base64});
+    }
+    mJobsChanged.notify_one();
+}
+
+std::shared_ptr<ImageData> ImageCache::Decode(std::unique_lock<std::mutex>& lock, const Key& key, SVGRenderer& renderer,
+    const std::shared_ptr<const std::string>& base64)
+{
+    ++mStats.misses;
+    mPending.insert(key);
+    lock.unlock();
+    std::shared_ptr<ImageData> image;
+    // Some ports throw on broken images. Decoding happens while drawing,
+    // where exceptions must not escape.
+    try
+    {
+        image = renderer.CreateImageData(*base64, key.encoding);
+    }
+    catch (...)
+    {
+    }
+    const size_t bytes = ImageBytes(image.get());
+    lock.lock();
+    mPending.erase(key);
+    // Images larger than the whole budget are not cached. Payloads whose
+    // fingerprint collides with a cached one do not replace it.
+    if (bytes <= mByteBudget && !mIndex.count(key))
+    {
+        mEntries.push_front(Entry{key, base64, image, bytes});
+        mIndex.emplace(key, mEntries.begin());
+        mStats.bytes += bytes;
+        ++mStats.entries;
+        Evict();
+    }
+    mDecoded.notify_all();
+    return image;
+}
+
+void ImageCache::Work()
+{
+    std::unique_lock<std::mutex> lock{mMutex};
+    for (;;)
+    {
+        mJobsChanged.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+        if (mStopping)
+            return;
+        Job job = std::move(mJobs.front());
+        mJobs.pop_front();
+        // Payloads get queued once per document. Skip those that were
+        // decoded in the meantime.
+        if (mIndex.count(job.key) || mPending.count(job.key))
+            continue;
+        Decode(lock, job.key, *job.renderer, job.base64);
+    }
+}
+
+void ImageCache::Evict()
+{
+    while (mStats.bytes > mByteBudget && !mEntries.empty())
+    {
+        mStats.bytes -= mEntries.back().bytes;
+        --mStats.entries;
+        ++mStats.evictions;
+        mIndex.erase(mEntries.back().key);
+        mEntries.pop_back();
+    }
+}
+
+void ImageCache::SetByteBudget(size_t byteBudget)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    mByteBudget = byteBudget;
+    Evict();
+}
+
+void ImageCache::Clear()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    mIndex.clear();
+    mEntries.clear();
+    mStats.bytes = 0;
+    mStats.entries = 0;
+}
+
+ImageCache::Stats ImageCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mStats;
+}
+
+} // namespace SVGNative
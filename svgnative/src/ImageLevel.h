@@ -0,0 +1,46 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_ImageLevel_h
+#define SVGViewer_ImageLevel_h
+
+#include <algorithm>
+#include <cstdint>
+
+namespace SVGNative
+{
+// Mip levels of raster images. Level n has the size of the image divided
+// by 2^n and rounded up, like JPEG DCT scaling rounds.
+
+constexpr int kMaxImageLevel{15};
+
+inline int ImageLevelSize(int size, int level)
+{
+    const std::int64_t divisor = std::int64_t{1} << level;
+    return std::max(1, static_cast<int>((size + divisor - 1) / divisor));
+}
+
+/**
+ * The smallest level that still has at least the device size in both
+ * dimensions. Invalid device sizes select level 0.
+ */
+inline int ImageLevelForDeviceSize(int width, int height, float deviceWidth, float deviceHeight)
+{
+    int level{};
+    while (level < kMaxImageLevel && (ImageLevelSize(width, level) > 1 || ImageLevelSize(height, level) > 1)
+        && ImageLevelSize(width, level + 1) >= deviceWidth && ImageLevelSize(height, level + 1) >= deviceHeight)
+        ++level;
+    return level;
+}
+} // namespace SVGNative
+
+#endif // SVGViewer_ImageLevel_h
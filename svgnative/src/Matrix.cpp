@@ -0,0 +1,129 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "Matrix.h"
+
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <cmath>
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace SVGNative
+{
+Matrix::Matrix(float aA, float aB, float aC, float aD, float aE, float aF)
+    : a{aA}
+    , b{aB}
+    , c{aC}
+    , d{aD}
+    , e{aE}
+    , f{aF}
+{
+}
+
+void Matrix::Set(float aA, float aB, float aC, float aD, float aE, float aF)
+{
+    *this = Matrix{aA, aB, aC, aD, aE, aF};
+}
+
+void Matrix::Rotate(float r)
+{
+    r = static_cast<float>(M_PI / 180.0 * r);
+    const float cosAngle = std::cos(r);
+    const float sinAngle = std::sin(r);
+    Concat(Matrix{cosAngle, sinAngle, -sinAngle, cosAngle, 0, 0});
+}
+
+void Matrix::Translate(float tx, float ty)
+{
+    e += tx * a + ty * c;
+    f += tx * b + ty * d;
+}
+
+void Matrix::Scale(float sx, float sy)
+{
+    a *= sx;
+    b *= sx;
+    c *= sy;
+    d *= sy;
+}
+
+void Matrix::Concat(float aA, float aB, float aC, float aD, float aE, float aF)
+{
+    Concat(Matrix{aA, aB, aC, aD, aE, aF});
+}
+
+void Matrix::Concat(const Matrix& o)
+{
+    Matrix result;
+    result.a = o.a * a + o.b * c;
+    result.b = o.a * b + o.b * d;
+    result.c = o.c * a + o.d * c;
+    result.d = o.c * b + o.d * d;
+    result.e = o.e * a + o.f * c + e;
+    result.f = o.e * b + o.f * d + f;
+    *this = result;
+}
+
+bool Matrix::IsIdentity() const
+{
+    return a == 1 && b == 0 && c == 0 && d == 1 && e == 0 && f == 0;
+}
+
+bool Matrix::Invert(Matrix& inverse) const
+{
+    const double determinant = static_cast<double>(a) * d - static_cast<double>(b) * c;
+    if (determinant == 0 || !std::isfinite(determinant))
+        return false;
+    const double invDet = 1.0 / determinant;
+    inverse.a = static_cast<float>(d * invDet);
+    inverse.b = static_cast<float>(-b * invDet);
+    inverse.c = static_cast<float>(-c * invDet);
+    inverse.d = static_cast<float>(a * invDet);
+    inverse.e = static_cast<float>((c * static_cast<double>(f) - d * static_cast<double>(e)) * invDet);
+    inverse.f = static_cast<float>((b * static_cast<double>(e) - a * static_cast<double>(f)) * invDet);
+    return true;
+}
+
+void Matrix::MapPoint(float& x, float& y) const
+{
+    const float tx = a * x + c * y + e;
+    y = b * x + d * y + f;
+    x = tx;
+}
+
+Bounds Matrix::MapBounds(const Bounds& bounds) const
+{
+    if (bounds.IsEmpty() || bounds.IsInfinite())
+        return bounds;
+    if (b == 0 && c == 0)
+    {
+        return Bounds{std::min(a * bounds.minX, a * bounds.maxX) + e, std::min(d * bounds.minY, d * bounds.maxY) + f,
+            std::max(a * bounds.minX, a * bounds.maxX) + e, std::max(d * bounds.minY, d * bounds.maxY) + f};
+    }
+    Bounds result;
+    const float xs[2] = {bounds.minX, bounds.maxX};
+    const float ys[2] = {bounds.minY, bounds.maxY};
+    for (float x : xs)
+    {
+        for (float y : ys)
+        {
+            float px{x}, py{y};
+            MapPoint(px, py);
+            result.Add(px, py);
+        }
+    }
+    return result;
+}
+
+} // namespace SVGNative
@@ -0,0 +1,64 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_Matrix_h
+#define SVGViewer_Matrix_h
+
+#include "svgnative/SVGRenderer.h"
+#include "Bounds.h"
+
+namespace SVGNative
+{
+/**
+ * Renderer independent 2D affine transform with the components
+ * [a c e]
+ * [b d f]
+ * [0 0 1]
+ *
+ * Follows the semantics of the port transforms: every operation is
+ * applied before the existing transform (pre-multiplication). The core
+ * parses transforms into a Matrix and creates the port transform from it
+ * so that geometry can be computed without the port.
+ */
+class Matrix final : public Transform
+{
+public:
+    Matrix() = default;
+    Matrix(float aA, float aB, float aC, float aD, float aE, float aF);
+
+    void Set(float a, float b, float c, float d, float tx, float ty) override;
+    void Rotate(float r) override;
+    void Translate(float tx, float ty) override;
+    void Scale(float sx, float sy) override;
+    void Concat(float a, float b, float c, float d, float tx, float ty) override;
+    void Concat(const Matrix& other);
+
+    bool IsIdentity() const;
+    bool Invert(Matrix& inverse) const;
+
+    void MapPoint(float& x, float& y) const;
+    /**
+     * Returns the axis aligned bounding box of the transformed box.
+     */
+    Bounds MapBounds(const Bounds& bounds) const;
+
+    float a{1};
+    float b{0};
+    float c{0};
+    float d{1};
+    float e{0};
+    float f{0};
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_Matrix_h
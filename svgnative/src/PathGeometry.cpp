@@ -0,0 +1,297 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "PathGeometry.h"
+
+#include <algorithm>
+
+namespace SVGNative
+{
+namespace
+{
+// Control point distance of a quarter circle as cubic Bézier, relative to
+// the radius.
+constexpr float kKappa{0.5522847498f};
+
+float DistanceSquared(float x0, float y0, float x1, float y1)
+{
+    return (x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0);
+}
+
+// Squared distance of (x, y) to the line segment from (x0, y0) to (x1, y1).
+float SegmentDistanceSquared(float x, float y, float x0, float y0, float x1, float y1)
+{
+    const float dx = x1 - x0;
+    const float dy = y1 - y0;
+    const float lengthSquared = dx * dx + dy * dy;
+    float t{};
+    if (lengthSquared > 0)
+        t = std::min(1.0f, std::max(0.0f, ((x - x0) * dx + (y - y0) * dy) / lengthSquared));
+    return DistanceSquared(x, y, x0 + t * dx, y0 + t * dy);
+}
+} // namespace
+
+void PathGeometry::Rect(float x, float y, float width, float height)
+{
+    MoveTo(x, y);
+    LineTo(x + width, y);
+    LineTo(x + width, y + height);
+    LineTo(x, y + height);
+    ClosePath();
+}
+
+void PathGeometry::RoundedRect(float x, float y, float width, float height, float cornerRadiusX, float cornerRadiusY)
+{
+    const float kx = cornerRadiusX * kKappa;
+    const float ky = cornerRadiusY * kKappa;
+    const float right = x + width;
+    const float bottom = y + height;
+    MoveTo(x + cornerRadiusX, y);
+    LineTo(right - cornerRadiusX, y);
+    CurveTo(right - cornerRadiusX + kx, y, right, y + cornerRadiusY - ky, right, y + cornerRadiusY);
+    LineTo(right, bottom - cornerRadiusY);
+    CurveTo(right, bottom - cornerRadiusY + ky, right - cornerRadiusX + kx, bottom, right - cornerRadiusX, bottom);
+    LineTo(x + cornerRadiusX, bottom);
+    CurveTo(x + cornerRadiusX - kx, bottom, x, bottom - cornerRadiusY + ky, x, bottom - cornerRadiusY);
+    LineTo(x, y + cornerRadiusY);
+    CurveTo(x, y + cornerRadiusY - ky, x + cornerRadiusX - kx, y, x + cornerRadiusX, y);
+    ClosePath();
+}
+
+void PathGeometry::Ellipse(float cx, float cy, float rx, float ry)
+{
+    const float kx = rx * kKappa;
+    const float ky = ry * kKappa;
+    MoveTo(cx + rx, cy);
+    CurveTo(cx + rx, cy + ky, cx + kx, cy + ry, cx, cy + ry);
+    CurveTo(cx - kx, cy + ry, cx - rx, cy + ky, cx - rx, cy);
+    CurveTo(cx - rx, cy - ky, cx - kx, cy - ry, cx, cy - ry);
+    CurveTo(cx + kx, cy - ry, cx + rx, cy - ky, cx + rx, cy);
+    ClosePath();
+}
+
+void PathGeometry::MoveTo(float x, float y)
+{
+    mVerbs.push_back(static_cast<std::uint8_t>(PathVerb::kMove));
+    mPoints.insert(mPoints.end(), {x, y});
+    mCurrentX = mSubpathX = x;
+    mCurrentY = mSubpathY = y;
+}
+
+void PathGeometry::LineTo(float x, float y)
+{
+    mVerbs.push_back(static_cast<std::uint8_t>(PathVerb::kLine));
+    mPoints.insert(mPoints.end(), {x, y});
+    ++mSegmentCount;
+    mCurrentX = x;
+    mCurrentY = y;
+}
+
+void PathGeometry::CurveTo(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    mVerbs.push_back(static_cast<std::uint8_t>(PathVerb::kCurve));
+    mPoints.insert(mPoints.end(), {x1, y1, x2, y2, x3, y3});
+    ++mSegmentCount;
+    mCurrentX = x3;
+    mCurrentY = y3;
+}
+
+void PathGeometry::CurveToV(float x2, float y2, float x3, float y3)
+{
+    mVerbs.push_back(static_cast<std::uint8_t>(PathVerb::kQuadCurve));
+    mPoints.insert(mPoints.end(), {x2, y2, x3, y3});
+    ++mSegmentCount;
+    mCurrentX = x3;
+    mCurrentY = y3;
+}
+
+void PathGeometry::ClosePath()
+{
+    mVerbs.push_back(static_cast<std::uint8_t>(PathVerb::kClose));
+    mCurrentX = mSubpathX;
+    mCurrentY = mSubpathY;
+}
+
+bool PathGeometry::IsRect(Bounds& rect) const
+{
+    size_t verbCount = mVerbs.size();
+    if (verbCount && mVerbs.back() == static_cast<std::uint8_t>(PathVerb::kClose))
+        --verbCount;
+    if ((verbCount != 4 && verbCount != 5) || mVerbs.front() != static_cast<std::uint8_t>(PathVerb::kMove))
+        return false;
+    for (size_t i = 1; i < verbCount; ++i)
+    {
+        if (mVerbs[i] != static_cast<std::uint8_t>(PathVerb::kLine))
+            return false;
+    }
+    // A fourth line has to return to the start.
+    if (verbCount == 5 && (mPoints[8] != mPoints[0] || mPoints[9] != mPoints[1]))
+        return false;
+    const bool horizontalFirst = mPoints[1] == mPoints[3];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        const float* from = &mPoints[2 * i];
+        const float* to = &mPoints[2 * ((i + 1) % 4)];
+        const bool horizontal = (i % 2 == 0) == horizontalFirst;
+        if (horizontal ? from[1] != to[1] : from[0] != to[0])
+            return false;
+    }
+    rect = Bounds{};
+    for (size_t i = 0; i < 4; ++i)
+        rect.Add(mPoints[2 * i], mPoints[2 * i + 1]);
+    return true;
+}
+
+void PathGeometry::Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount)
+{
+    // Find the verbs that have all their points and copy them at once.
+    const float* p = points;
+    const float* end = points + 2 * pointCount;
+    size_t i{};
+    for (; i < verbCount; ++i)
+    {
+        const auto verb = static_cast<PathVerb>(verbs[i]);
+        const ptrdiff_t size = verb == PathVerb::kMove || verb == PathVerb::kLine ? 2
+            : verb == PathVerb::kCurve ? 6
+            : verb == PathVerb::kQuadCurve ? 4 : 0;
+        if (end - p < size)
+            break;
+        switch (verb)
+        {
+        case PathVerb::kMove:
+            mCurrentX = mSubpathX = p[0];
+            mCurrentY = mSubpathY = p[1];
+            break;
+        case PathVerb::kLine:
+        case PathVerb::kCurve:
+        case PathVerb::kQuadCurve:
+            ++mSegmentCount;
+            mCurrentX = p[size - 2];
+            mCurrentY = p[size - 1];
+            break;
+        case PathVerb::kClose:
+            mCurrentX = mSubpathX;
+            mCurrentY = mSubpathY;
+            break;
+        }
+        p += size;
+    }
+    mVerbs.insert(mVerbs.end(), verbs, verbs + i);
+    mPoints.insert(mPoints.end(), points, p);
+}
+
+void PathGeometry::Clear()
+{
+    mVerbs.clear();
+    mPoints.clear();
+    mSegmentCount = 0;
+    mCurrentX = mCurrentY = mSubpathX = mSubpathY = 0;
+}
+
+void PathGeometry::Replay(Path& target) const
+{
+    target.Append(mVerbs.data(), mVerbs.size(), mPoints.data(), mPoints.size() / 2);
+}
+
+size_t PathGeometry::Simplify(Path& target, float tolerance) const
+{
+    const float toleranceSquared = tolerance * tolerance;
+    size_t segmentCount{};
+    // Last point passed to the target and the start of its subpath.
+    float lastX{}, lastY{}, subpathX{}, subpathY{};
+    // End point of merged segments that was not passed yet.
+    bool hasPending{};
+    float pendingX{}, pendingY{};
+
+    auto flushPending = [&]() {
+        if (!hasPending)
+            return;
+        target.LineTo(pendingX, pendingY);
+        ++segmentCount;
+        lastX = pendingX;
+        lastY = pendingY;
+        hasPending = false;
+    };
+    auto lineTo = [&](float x, float y) {
+        if (DistanceSquared(lastX, lastY, x, y) < toleranceSquared)
+        {
+            hasPending = true;
+            pendingX = x;
+            pendingY = y;
+            return;
+        }
+        // Merged segments are replaced by the line from the last passed
+        // point, which is less than the tolerance away from them.
+        hasPending = false;
+        target.LineTo(x, y);
+        ++segmentCount;
+        lastX = x;
+        lastY = y;
+    };
+
+    const float* p = mPoints.data();
+    for (auto value : mVerbs)
+    {
+        const auto verb = static_cast<PathVerb>(value);
+        switch (verb)
+        {
+        case PathVerb::kMove:
+            flushPending();
+            target.MoveTo(p[0], p[1]);
+            lastX = subpathX = p[0];
+            lastY = subpathY = p[1];
+            p += 2;
+            break;
+        case PathVerb::kLine:
+            lineTo(p[0], p[1]);
+            p += 2;
+            break;
+        case PathVerb::kCurve:
+        case PathVerb::kQuadCurve:
+        {
+            const bool isCubic = verb == PathVerb::kCurve;
+            const float* end = isCubic ? p + 4 : p + 2;
+            // A curve stays within the hull of its control points.
+            const float startX = hasPending ? pendingX : lastX;
+            const float startY = hasPending ? pendingY : lastY;
+            if (SegmentDistanceSquared(p[0], p[1], startX, startY, end[0], end[1]) <= toleranceSquared
+                && (!isCubic || SegmentDistanceSquared(p[2], p[3], startX, startY, end[0], end[1]) <= toleranceSquared))
+                lineTo(end[0], end[1]);
+            else
+            {
+                flushPending();
+                if (isCubic)
+                    target.CurveTo(p[0], p[1], p[2], p[3], p[4], p[5]);
+                else
+                    target.CurveToV(p[0], p[1], p[2], p[3]);
+                ++segmentCount;
+                lastX = end[0];
+                lastY = end[1];
+            }
+            p = end + 2;
+            break;
+        }
+        case PathVerb::kClose:
+            // Closing draws the line to the start. A pending point is close
+            // enough to the last passed point to be dropped.
+            hasPending = false;
+            target.ClosePath();
+            lastX = subpathX;
+            lastY = subpathY;
+            break;
+        }
+    }
+    flushPending();
+    return segmentCount;
+}
+
+} // namespace SVGNative
@@ -0,0 +1,92 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_PathGeometry_h
+#define SVGViewer_PathGeometry_h
+
+#include "Bounds.h"
+#include "svgnative/SVGRenderer.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace SVGNative
+{
+/**
+ * Path geometry kept by the core, so that large paths can be drawn
+ * simplified at small output scales. Rectangles, rounded rectangles and
+ * ellipses are stored as lines and curves.
+ */
+class PathGeometry final : public Path
+{
+public:
+    void Rect(float x, float y, float width, float height) override;
+    void RoundedRect(float x, float y, float width, float height, float cornerRadiusX, float cornerRadiusY) override;
+    void Ellipse(float cx, float cy, float rx, float ry) override;
+
+    void MoveTo(float x, float y) override;
+    void LineTo(float x, float y) override;
+    void CurveTo(float x1, float y1, float x2, float y2, float x3, float y3) override;
+    void CurveToV(float x2, float y2, float x3, float y3) override;
+    void ClosePath() override;
+
+    void Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount) override;
+
+    /**
+     * Removes all segments and keeps the allocated storage.
+     */
+    void Clear();
+
+    /**
+     * Number of lines and curves.
+     */
+    size_t SegmentCount() const { return mSegmentCount; }
+
+    /**
+     * True if the geometry is a single axis-aligned rectangle: a move and
+     * 3 or 4 horizontal and vertical lines that alternate. \p rect receives
+     * its bounds.
+     */
+    bool IsRect(Bounds& rect) const;
+
+    /**
+     * Passes the geometry unchanged to \p target with a single
+     * Path::Append call.
+     */
+    void Replay(Path& target) const;
+
+    /**
+     * Passes the geometry to \p target with fewer segments. The result
+     * deviates at most \p tolerance from the original geometry:
+     * - Lines and curves ending closer than \p tolerance to the last
+     *   passed point get merged into the following segment. End points of
+     *   open subpaths are kept.
+     * - Curves whose control points are closer than \p tolerance to their
+     *   chord are passed as lines.
+     * @return Number of lines and curves passed to \p target.
+     */
+    size_t Simplify(Path& target, float tolerance) const;
+
+private:
+    // PathVerb values, as passed to Path::Append.
+    std::vector<std::uint8_t> mVerbs;
+    std::vector<float> mPoints;
+    size_t mSegmentCount{};
+    float mCurrentX{};
+    float mCurrentY{};
+    float mSubpathX{};
+    float mSubpathY{};
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_PathGeometry_h
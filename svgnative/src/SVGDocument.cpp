@@ -28,6 +28,18 @@ governing permissions and limitations under the License.
 namespace SVGNative
 {
 std::unique_ptr<SVGDocument> SVGDocument::CreateSVGDocument(const char* s, std::shared_ptr<SVGRenderer> renderer)
+{
+    return CreateSVGDocument(s, std::move(renderer), nullptr);
+}
+
+std::unique_ptr<SVGDocument> SVGDocument::CreateSVGDocument(
+    const char* s, std::shared_ptr<SVGRenderer> renderer, std::shared_ptr<ImageCache> imageCache)
+{
+    return CreateSVGDocument(s, std::move(renderer), std::move(imageCache), ParseOptions{});
+}
+
+std::unique_ptr<SVGDocument> SVGDocument::CreateSVGDocument(
+    const char* s, std::shared_ptr<SVGRenderer> renderer, std::shared_ptr<ImageCache> imageCache, const ParseOptions& options)
 {
     try
     {
@@ -39,7 +51,7 @@ std::unique_ptr<SVGDocument> SVGDocument::CreateSVGDocument(const char* s, std::
         auto rootNode = xmlDocument->GetFirstNode();
         if (!rootNode)
             return nullptr;
-        auto realSVGDoc = std::unique_ptr<SVGDocumentImpl>(new SVGDocumentImpl(renderer));
+        auto realSVGDoc = std::unique_ptr<SVGDocumentImpl>(new SVGDocumentImpl(renderer, std::move(imageCache), options));
         if (!realSVGDoc)
             return nullptr;
         realSVGDoc->TraverseSVGTree(rootNode.get());
@@ -127,6 +139,71 @@ void SVGDocument::Render(const char* id, const ColorMap& colorMap, float width,
     mDocument->Render(id, colorMap, width, height);
 }
 
+void SVGDocument::Render(const Rect& viewport, float width, float height)
+{
+    if (!mDocument)
+        return;
+
+    ColorMap colorMap;
+    mDocument->Render(viewport, colorMap, width, height);
+}
+
+void SVGDocument::Render(const Rect& viewport, const ColorMap& colorMap, float width, float height)
+{
+    if (!mDocument)
+        return;
+
+    mDocument->Render(viewport, colorMap, width, height);
+}
+
+void SVGDocument::SetRecordingEnabled(bool enabled)
+{
+    if (!mDocument)
+        return;
+
+    mDocument->SetRecordingEnabled(enabled);
+}
+
+void SVGDocument::ClearRecording()
+{
+    if (!mDocument)
+        return;
+
+    mDocument->ClearRecording();
+}
+
+void SVGDocument::SetPathLevelOfDetail(float tolerance)
+{
+    if (!mDocument)
+        return;
+
+    mDocument->SetPathLevelOfDetail(tolerance);
+}
+
+void SVGDocument::SetInstancingEnabled(bool enabled)
+{
+    if (!mDocument)
+        return;
+
+    mDocument->SetInstancingEnabled(enabled);
+}
+
+RenderStats SVGDocument::GetRenderStats() const
+{
+    if (!mDocument)
+        return RenderStats{};
+
+    return mDocument->GetRenderStats();
+}
+
+SimplifyStats SVGDocument::SimplifyRenderTree()
+{
+    if (!mDocument)
+        return SimplifyStats{};
+
+    return mDocument->SimplifyRenderTree();
+}
+
 bool SVGDocument::GetBoundingBox(Rect& bounds)
 {
     if (!mDocument)
@@ -141,6 +218,13 @@ bool SVGDocument::GetBoundingBox(const char *id, Rect& bounds)
     return mDocument->GetBoundingBox(id, bounds);
 }
 
+bool SVGDocument::GetBoundingBoxes(const std::vector<std::string>& ids, std::vector<Rect>& bounds)
+{
+    if (!mDocument)
+        return false;
+    return mDocument->GetBoundingBoxes(ids, bounds);
+}
+
 void SVGDocument::GetViewBox(Rect& viewBox)
 {
     viewBox.x = mDocument->mViewBox[0];
@@ -18,6 +18,7 @@ governing permissions and limitations under the License.
 #include "SVGStringParser.h"
 #include "xml/XMLParser.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -50,16 +51,68 @@ constexpr std::array<const char*, 5> gNonInheritedPropertyNames{{
     kStopColorProp
 }};
 
+// Groups with fewer children are traversed linearly during culling.
+constexpr size_t kSpatialIndexThreshold{16};
+// Group opacity is only folded into children if they do not overlap.
+// Checking more children than this costs more than the layer saves.
+constexpr size_t kOpacityFoldingMaxChildren{32};
+// Paths with fewer segments are drawn as they are at any scale.
+constexpr size_t kPathLODMinSegments{64};
+// Merged paths get culled as a whole. Runs of graphics stop growing at
+// this many segments.
+constexpr size_t kMergedPathMaxSegments{1024};
+// Content referenced by more than one <use> is recorded once if it draws at
+// least this many paths and images. Smaller content is cheaper to draw.
+constexpr size_t kInstanceMinDraws{8};
+
 template <typename T>
 bool isCloseToZero(T x)
 {
     return std::abs(x) < std::numeric_limits<T>::epsilon();
 }
 
-SVGDocumentImpl::SVGDocumentImpl(std::shared_ptr<SVGRenderer> renderer)
+// Counts of documents that reference content exponentially often saturate.
+static size_t AddCount(size_t count, size_t add)
+{
+    return count > std::numeric_limits<size_t>::max() - add ? std::numeric_limits<size_t>::max() : count + add;
+}
+
+// Keeps the core copy of a shape, drawn by draw(Path&), in *geometry if it
+// has at least minSegments segments. Shapes get drawn into scratch first, so
+// that shapes that are not kept allocate nothing.
+template <typename Draw>
+static void KeepGeometry(PathGeometry& scratch, std::shared_ptr<const PathGeometry>* geometry, size_t minSegments, Draw draw)
+{
+    if (!geometry)
+        return;
+    scratch.Clear();
+    draw(scratch);
+    if (scratch.SegmentCount() >= minSegments)
+        *geometry = std::make_shared<PathGeometry>(scratch);
+}
+
+// Distance the stroke may extend beyond the geometry of the path.
+static float StrokeOutset(const StrokeStyle& strokeStyle)
+{
+    float factor{1.0f};
+    if (strokeStyle.lineJoin == LineJoin::kMiter)
+        factor = std::max(factor, strokeStyle.miterLimit);
+    if (strokeStyle.lineCap == LineCap::kSquare)
+        factor = std::max(factor, std::sqrt(2.0f));
+    return strokeStyle.lineWidth / 2.0f * factor;
+}
+
+SVGDocumentImpl::SVGDocumentImpl(std::shared_ptr<SVGRenderer> renderer, std::shared_ptr<ImageCache> imageCache, const ParseOptions& options)
     : mViewBox{{0, 0, 320.0f, 200.0f}}
     , mRenderer{renderer}
+    , mImageCache{std::move(imageCache)}
+    , mKeepShapeGeometry{options.keepShapeGeometry}
 {
+    // Without a shared cache, images stay decoded for the lifetime of the
+    // document, like all other resources.
+    if (!mImageCache)
+        mImageCache = std::make_shared<ImageCache>(std::numeric_limits<size_t>::max());
+
     mFillStyleStack.push(FillStyleImpl());
     mStrokeStyleStack.push(StrokeStyleImpl());
 
@@ -98,6 +151,11 @@ void SVGDocumentImpl::TraverseSVGTree(XMLNode* rootNode)
 
     ParseChild(rootNode);
 
+    LinkReferences();
+    ComputeAllBounds();
+    mStats.expandedElements = mGroup->expansionCount;
+    OptimizeRenderTree();
+
     // Clear all temporary sets
     mGradients.clear();
     mClippingPaths.clear();
@@ -163,9 +221,15 @@ void SVGDocumentImpl::ParseChild(XMLNode* child)
 
     // Check if we have a shape rect, circle, ellipse, line, polygon, polyline
     // or path first.
-    if (auto path = ParseShape(child))
+    // Large paths keep their geometry for level of detail.
+    Bounds pathBounds;
+    std::shared_ptr<const PathGeometry> geometry;
+    if (auto path = ParseShape(child, pathBounds, &geometry, mKeepShapeGeometry ? 0 : kPathLODMinSegments))
     {
-        AddChildToCurrentGroup(std::unique_ptr<Graphic>(new Graphic(graphicStyle, classNames, fillStyle, strokeStyle, std::move(path))), std::move(idString));
+        path->SetFillRule(fillStyle.fillRule);
+        auto graphic = std::make_shared<Graphic>(graphicStyle, classNames, fillStyle, strokeStyle, std::move(path), pathBounds);
+        graphic->geometry = std::move(geometry);
+        AddChildToCurrentGroup(std::move(graphic), std::move(idString));
         return;
     }
 
@@ -202,28 +266,31 @@ void SVGDocumentImpl::ParseChild(XMLNode* child)
     }
     else if (!strcmp(elementName, kImageElem))
     {
-        std::unique_ptr<ImageData> imageData;
+        std::shared_ptr<const std::string> base64;
+        ImageEncoding encoding{};
         auto hrefAttr = child->GetAttribute(kHrefAttr, kXlinkNS);
         if (hrefAttr.found)
         {
-            const std::string dataURL = hrefAttr.value;
-            ImageEncoding encoding{};
-            unsigned short base64Offset{22};
-            if (dataURL.find(kDataUrlPngVal) == 0)
+            // Payloads can be megabytes. Compare the prefix in place and
+            // copy the characters after it once, into the payload.
+            const char* dataURL = hrefAttr.value;
+            size_t base64Offset{22};
+            if (!strncmp(dataURL, kDataUrlPngVal, base64Offset))
                 encoding = ImageEncoding::kPNG;
-            else if (dataURL.find(kDataUrlJpgVal) == 0)
+            else if (!strncmp(dataURL, kDataUrlJpgVal, base64Offset))
                 encoding = ImageEncoding::kJPEG;
-            else if (dataURL.find(kDataUrlJpegVal) == 0)
+            else if (!strncmp(dataURL, kDataUrlJpegVal, 23))
             {
                 encoding = ImageEncoding::kJPEG;
                 base64Offset = 23;
             }
             else
                 return;
-            imageData = mRenderer->CreateImageData(dataURL.substr(base64Offset), encoding);
+            // Decoding is deferred to the first draw.
+            base64 = std::make_shared<const std::string>(dataURL + base64Offset);
         }
 
-        if (imageData)
+        if (base64)
         {
             const float imageWidth = ParseLengthFromAttr(child, kWidthAttr, LengthType::kHorizontal);
             const float imageHeight = ParseLengthFromAttr(child, kHeightAttr, LengthType::kVertical);
@@ -311,7 +378,8 @@ void SVGDocumentImpl::ParseChild(XMLNode* child)
             // Do not render 0-sized elements.
             if (imageWidth && imageHeight && clipArea.width && clipArea.height && fillArea.width && fillArea.height)
             {
-                auto image = std::unique_ptr<Image>(new Image(graphicStyle, classNames, std::move(imageData), clipArea, fillArea));
+                auto image = std::make_shared<Image>(graphicStyle, classNames, std::move(base64), encoding, clipArea, fillArea);
+                mImages.push_back(image);
                 AddChildToCurrentGroup(std::move(image), std::move(idString));
             }
         }
@@ -329,6 +397,7 @@ void SVGDocumentImpl::ParseChild(XMLNode* child)
             if (!graphicStyle.transform)
                 graphicStyle.transform = mRenderer->CreateTransform();
             graphicStyle.transform->Concat(1, 0, 0, 1, x, y);
+            graphicStyle.matrix.Concat(1, 0, 0, 1, x, y);
         }
 
         std::string href{(hrefAttr.value + 1)};
@@ -343,7 +412,10 @@ void SVGDocumentImpl::ParseChild(XMLNode* child)
         {
             std::vector<float> numberList;
             if (SVGStringParser::ParseListOfNumbers(attr.value, numberList) && numberList.size() == 4)
+            {
                 graphicStyle.transform = mRenderer->CreateTransform(1, 0, 0, 1, -numberList[0], -numberList[1]);
+                graphicStyle.matrix = Matrix{1, 0, 0, 1, -numberList[0], -numberList[1]};
+            }
         }
 
         auto group = std::make_shared<Group>(graphicStyle, classNames);
@@ -383,34 +455,55 @@ void SVGDocumentImpl::ParseChild(XMLNode* child)
         for (auto clipPathChild = child->GetFirstNode(); clipPathChild != nullptr; clipPathChild = clipPathChild->GetNextSibling())
         {
             // WebKit and Blink allow the clipping path if there is at least one valid basic shape child.
-            if (auto path = ParseShape(clipPathChild.get()))
+            Bounds clipBounds;
+            std::shared_ptr<const PathGeometry> geometry;
+            if (auto path = ParseShape(clipPathChild.get(), clipBounds, &geometry))
             {
                 std::unique_ptr<Transform> transform;
                 auto attr = clipPathChild->GetAttribute(kTransformAttr);
-                if (attr.found)
+                // Stays the identity if the transform is invalid, like the
+                // transform of the path.
+                Matrix matrix;
+                Matrix parsedMatrix;
+                if (attr.found && SVGStringParser::ParseTransform(attr.value, parsedMatrix))
                 {
                     SVG_ASSERT(mRenderer != nullptr);
-                    transform = mRenderer->CreateTransform();
-                    if (!SVGStringParser::ParseTransform(attr.value, *transform))
-                        transform.reset();
+                    matrix = parsedMatrix;
+                    transform = mRenderer->CreateTransform(matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f);
+                    clipBounds = matrix.MapBounds(clipBounds);
                 }
                 auto fillStyleChild = mFillStyleStack.top();
                 auto strokeStyleChild = mStrokeStyleStack.top();
                 std::set<std::string> classNames;
                 ParseGraphic(child, fillStyleChild, strokeStyleChild, classNames);
-                mClippingPaths[id.value] = std::make_shared<ClippingPath>(true, fillStyleChild.clipRule, std::move(path), std::move(transform));
+                auto clippingPath = std::make_shared<ClippingPathImpl>(true, fillStyleChild.clipRule, std::move(path), std::move(transform));
+                clippingPath->bounds = clipBounds;
+                // Rectangles stay rectangles under translations, scales and
+                // quarter rotations. Ports clip to them without the path.
+                Bounds rect;
+                if (((matrix.b == 0 && matrix.c == 0) || (matrix.a == 0 && matrix.d == 0)) && geometry->IsRect(rect))
+                {
+                    rect = matrix.MapBounds(rect);
+                    clippingPath->isRect = true;
+                    clippingPath->clipRect.x = rect.minX;
+                    clippingPath->clipRect.y = rect.minY;
+                    clippingPath->clipRect.width = rect.maxX - rect.minX;
+                    clippingPath->clipRect.height = rect.maxY - rect.minY;
+                }
+                mClippingPaths[id.value] = std::move(clippingPath);
                 hasClipContent = true;
                 break;
             }
         }
         if (!hasClipContent)
-            mClippingPaths[id.value] = std::make_shared<ClippingPath>(false, WindingRule::kNonZero, nullptr, nullptr);
+            mClippingPaths[id.value] = std::make_shared<ClippingPathImpl>(false, WindingRule::kNonZero, nullptr, nullptr);
         mFillStyleStack.pop();
         mStrokeStyleStack.pop();
     }
 }
 
-std::unique_ptr<Path> SVGDocumentImpl::ParseShape(XMLNode* child)
+std::unique_ptr<Path> SVGDocumentImpl::ParseShape(
+    XMLNode* child, Bounds& bounds, std::shared_ptr<const PathGeometry>* geometry, size_t minGeometrySegments)
 {
     SVG_ASSERT(child != nullptr);
 
@@ -460,15 +553,17 @@ std::unique_ptr<Path> SVGDocumentImpl::ParseShape(XMLNode* child)
         rx = std::min(rx, width / 2.0f);
         ry = std::min(ry, height / 2.0f);
 
+        auto drawRect = [&](Path& target) {
+            if (isCloseToZero(rx) || isCloseToZero(ry))
+                target.Rect(x, y, width, height);
+            else
+                target.RoundedRect(x, y, width, height, rx, ry);
+        };
         auto path = mRenderer->CreatePath();
-        if (isCloseToZero(rx) || isCloseToZero(ry))
-        {
-            path->Rect(x, y, width, height);
-        }
-        else
-        {
-            path->RoundedRect(x, y, width, height, rx, ry);
-        }
+        BoundsRecordingPath recorder{*path};
+        drawRect(recorder);
+        KeepGeometry(mParsedPath, geometry, minGeometrySegments, drawRect);
+        bounds = recorder.GetBounds();
         return path;
     }
     else if (!strcmp(elementName, kEllipseElem) || !strcmp(elementName, kCircleElem))
@@ -493,8 +588,12 @@ std::unique_ptr<Path> SVGDocumentImpl::ParseShape(XMLNode* child)
         float cx = ParseLengthFromAttr(child, kCxAttr, LengthType::kHorizontal);
         float cy = ParseLengthFromAttr(child, kCyAttr, LengthType::kVertical);
 
+        auto drawEllipse = [&](Path& target) { target.Ellipse(cx, cy, rx, ry); };
         auto path = mRenderer->CreatePath();
-        path->Ellipse(cx, cy, rx, ry);
+        BoundsRecordingPath recorder{*path};
+        drawEllipse(recorder);
+        KeepGeometry(mParsedPath, geometry, minGeometrySegments, drawEllipse);
+        bounds = recorder.GetBounds();
 
         return path;
     }
@@ -507,20 +606,22 @@ std::unique_ptr<Path> SVGDocumentImpl::ParseShape(XMLNode* child)
         // coordinate pairs. However, Blink and WebKit do it the same way.
         std::vector<float> numberList;
         SVGStringParser::ParseListOfNumbers(attr.value, numberList);
-        auto size = numberList.size();
-        auto path = mRenderer->CreatePath();
-        if (size > 1)
+        // The list already holds the points in the layout of Path::Append.
+        const auto pointCount = numberList.size() / 2;
+        std::vector<std::uint8_t> verbs;
+        if (pointCount)
         {
-            if (size % 2 == 1)
-                --size;
-            decltype(size) i{};
-            path->MoveTo(numberList[i], numberList[i + 1]);
-            i += 2;
-            for (; i < size; i += 2)
-                path->LineTo(numberList[i], numberList[i + 1]);
+            verbs.assign(pointCount, static_cast<std::uint8_t>(PathVerb::kLine));
+            verbs.front() = static_cast<std::uint8_t>(PathVerb::kMove);
             if (!strcmp(elementName, kPolygonElem))
-                path->ClosePath();
+                verbs.push_back(static_cast<std::uint8_t>(PathVerb::kClose));
         }
+        auto drawPolyline = [&](Path& target) { target.Append(verbs.data(), verbs.size(), numberList.data(), pointCount); };
+        auto path = mRenderer->CreatePath();
+        BoundsRecordingPath recorder{*path};
+        drawPolyline(recorder);
+        KeepGeometry(mParsedPath, geometry, minGeometrySegments, drawPolyline);
+        bounds = recorder.GetBounds();
 
         return path;
     }
@@ -530,16 +631,34 @@ std::unique_ptr<Path> SVGDocumentImpl::ParseShape(XMLNode* child)
         if (!attr.found)
             return nullptr;
 
+        // Parse into reused storage and pass all segments to the port at once.
+        mParsedPath.Clear();
+        SVGStringParser::ParsePathString(attr.value, mParsedPath);
         auto path = mRenderer->CreatePath();
-        SVGStringParser::ParsePathString(attr.value, *path);
+        BoundsRecordingPath recorder{*path};
+        mParsedPath.Replay(recorder);
+        // Copy, so that the storage stays reused.
+        if (geometry && mParsedPath.SegmentCount() >= minGeometrySegments)
+            *geometry = std::make_shared<PathGeometry>(mParsedPath);
+        bounds = recorder.GetBounds();
 
         return path;
     }
     else if (!strcmp(elementName, kLineElem))
     {
+        const float x1 = ParseLengthFromAttr(child, kX1Attr, LengthType::kHorizontal);
+        const float y1 = ParseLengthFromAttr(child, kY1Attr, LengthType::kVertical);
+        const float x2 = ParseLengthFromAttr(child, kX2Attr, LengthType::kHorizontal);
+        const float y2 = ParseLengthFromAttr(child, kY2Attr, LengthType::kVertical);
+        auto drawLine = [&](Path& target) {
+            target.MoveTo(x1, y1);
+            target.LineTo(x2, y2);
+        };
         auto path = mRenderer->CreatePath();
-        path->MoveTo(ParseLengthFromAttr(child, kX1Attr, LengthType::kHorizontal), ParseLengthFromAttr(child, kY1Attr, LengthType::kVertical));
-        path->LineTo(ParseLengthFromAttr(child, kX2Attr, LengthType::kHorizontal), ParseLengthFromAttr(child, kY2Attr, LengthType::kVertical));
+        BoundsRecordingPath recorder{*path};
+        drawLine(recorder);
+        KeepGeometry(mParsedPath, geometry, minGeometrySegments, drawLine);
+        bounds = recorder.GetBounds();
 
         return path;
     }
@@ -567,9 +686,12 @@ GraphicStyleImpl SVGDocumentImpl::ParseGraphic(
     if (transformAttr.found && node != mRootNode) // Ignore transforms on root SVG node
     {
         SVG_ASSERT(mRenderer != nullptr);
-        graphicStyle.transform = mRenderer->CreateTransform();
-        if (!SVGStringParser::ParseTransform(transformAttr.value, *graphicStyle.transform))
-            graphicStyle.transform.reset();
+        Matrix matrix;
+        if (SVGStringParser::ParseTransform(transformAttr.value, matrix))
+        {
+            graphicStyle.matrix = matrix;
+            graphicStyle.transform = mRenderer->CreateTransform(matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f);
+        }
     }
 
     return graphicStyle;
@@ -775,7 +897,7 @@ void SVGDocumentImpl::ParseGraphicsProperties(GraphicStyleImpl& graphicStyle, co
     prop = propertySet.find(kDisplayProp);
     if (prop != iterEnd)
     {
-        if (prop->second.compare(kNoneVal))
+        if (prop->second.compare(kNoneVal) == 0)
             graphicStyle.display = false;
     }
 
@@ -940,9 +1062,141 @@ void SVGDocumentImpl::Render(const ColorMap& colorMap, float width, float height
     if (!mGroup)
         return;
 
+    PrefetchImages();
+
+    if (mRecordingEnabled && RenderRecording(colorMap, width, height))
+        return;
+
     RenderElement(*mGroup, colorMap, width, height);
 }
 
+void SVGDocumentImpl::PrefetchImages()
+{
+    if (mImagesPrefetched || !mImageCache->HasWorkers())
+        return;
+    mImagesPrefetched = true;
+    for (const auto& image : mImages)
+        mImageCache->Prefetch(mRenderer, image->fingerprint, image->base64, image->encoding);
+}
+
+void SVGDocumentImpl::SetRecordingEnabled(bool enabled)
+{
+    mRecordingEnabled = enabled;
+    if (!enabled)
+        ClearRecording();
+}
+
+void SVGDocumentImpl::ClearRecording()
+{
+    mRecording.reset();
+    mRecordingColorMap.clear();
+    ClearInstances();
+}
+
+void SVGDocumentImpl::SetPathLevelOfDetail(float tolerance)
+{
+    mPathLODTolerance = tolerance > 0 ? tolerance : 0;
+}
+
+bool SVGDocumentImpl::RenderRecording(const ColorMap& colorMap, float width, float height)
+{
+#ifdef STYLE_SUPPORT
+    // Override styles can change at any time. Do not replay stale content.
+    if (mOverrideStyle)
+        return false;
+#endif
+
+    if (!mRecording || colorMap != mRecordingColorMap)
+    {
+        ClearRecording();
+        // Record without the root transform. Only the root transform
+        // changes with the output size.
+        if (!mRenderer->BeginRecording(RecordingBounds(mGroup->bounds)))
+            return false;
+        PrepareInstances(colorMap);
+        mRecordingTree = true;
+        TraverseTree(colorMap, *mGroup, Matrix{});
+        mRecordingTree = false;
+        mRecording = mRenderer->EndRecording();
+        if (!mRecording)
+            return false;
+        mRecordingColorMap = colorMap;
+    }
+
+    mRenderer->DrawRecording(*mRecording, *CreateRootTransform(width, height));
+    return true;
+}
+
+Rect SVGDocumentImpl::RecordingBounds(const Bounds& bounds) const
+{
+    if (bounds.IsInfinite())
+    {
+        const float extent = std::numeric_limits<float>::max() / 4;
+        return Rect{-extent, -extent, 2 * extent, 2 * extent};
+    }
+    return bounds.ToRect();
+}
+
+void SVGDocumentImpl::SetInstancingEnabled(bool enabled)
+{
+    mInstancingEnabled = enabled;
+    if (!enabled)
+        ClearInstances();
+}
+
+void SVGDocumentImpl::PrepareInstances(const ColorMap& colorMap)
+{
+    if (mInstancedElements.empty() || colorMap == mInstanceColorMap)
+        return;
+    ClearInstances();
+    mInstanceColorMap = colorMap;
+}
+
+void SVGDocumentImpl::ClearInstances()
+{
+    for (auto element : mInstancedElements)
+        element->instance.reset();
+    mInstancedElements.clear();
+}
+
+bool SVGDocumentImpl::DrawInstance(const ColorMap& colorMap, const Element& element)
+{
+    if (!mInstancingEnabled || element.referenceCount < 2 || element.drawCount < kInstanceMinDraws)
+        return false;
+#ifdef STYLE_SUPPORT
+    if (mOverrideStyle)
+        return false;
+#endif
+
+    if (!element.instance)
+    {
+        // The recording gets replayed in the coordinate system of the <use>
+        // element. Record everything at any scale.
+        if (!mRenderer->BeginRecording(RecordingBounds(element.bounds)))
+            return false;
+        if (mInstancedElements.empty())
+            mInstanceColorMap = colorMap;
+        const bool recordingTree = mRecordingTree;
+        const bool cullToViewport = mCullToViewport;
+        mRecordingTree = true;
+        mCullToViewport = false;
+        TraverseTree(colorMap, element, Matrix{});
+        mRecordingTree = recordingTree;
+        mCullToViewport = cullToViewport;
+        element.instance = mRenderer->EndRecording();
+        if (!element.instance)
+            return false;
+        mInstancedElements.push_back(&element);
+        ++mStats.instancesRecorded;
+    }
+
+    if (!mInstanceTransform)
+        mInstanceTransform = mRenderer->CreateTransform();
+    mRenderer->DrawRecording(*element.instance, *mInstanceTransform);
+    ++mStats.instancesReplayed;
+    return true;
+}
+
 void SVGDocumentImpl::Render(const char* id, const ColorMap& colorMap, float width, float height)
 {
     // Referenced glyph identifiers shall be rendered as if they were contained in a <defs> section under
@@ -953,24 +1207,71 @@ void SVGDocumentImpl::Render(const char* id, const ColorMap& colorMap, float wid
     // https://docs.microsoft.com/en-us/typography/opentype/spec/svg#glyph-identifiers
     auto elementIter = mIdToElementMap.find(id);
     if (elementIter != mIdToElementMap.end())
+    {
+        PrefetchImages();
         RenderElement(*elementIter->second, colorMap, width, height);
+    }
 }
 
-void SVGDocumentImpl::RenderElement(const Element& element, const ColorMap& colorMap, float width, float height)
+void SVGDocumentImpl::Render(const Rect& viewport, const ColorMap& colorMap, float width, float height)
+{
+    SVG_ASSERT(mGroup);
+    if (!mGroup)
+        return;
+
+    PrefetchImages();
+
+#ifdef STYLE_SUPPORT
+    // Override styles may change strokes and clipping paths after bounds
+    // were computed. Render everything.
+    if (mOverrideStyle)
+    {
+        RenderElement(*mGroup, colorMap, width, height);
+        return;
+    }
+#endif
+
+    mViewport = Bounds::FromRect(viewport);
+    mCullToViewport = true;
+    RenderElement(*mGroup, colorMap, width, height);
+    mCullToViewport = false;
+}
+
+Matrix SVGDocumentImpl::RootMatrix(float width, float height) const
 {
     float scale = width / mViewBox[2];
     if (scale > height / mViewBox[3])
         scale = height / mViewBox[3];
 
+    Matrix matrix;
+    matrix.Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
+    matrix.Scale(scale, scale);
+    return matrix;
+}
+
+std::unique_ptr<Transform> SVGDocumentImpl::CreateRootTransform(float width, float height) const
+{
+    const Matrix matrix = RootMatrix(width, height);
+    return mRenderer->CreateTransform(matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f);
+}
+
+void SVGDocumentImpl::RenderElement(const Element& element, const ColorMap& colorMap, float width, float height)
+{
     GraphicStyleImpl graphicStyle{};
-    graphicStyle.transform = mRenderer->CreateTransform();
-    graphicStyle.transform->Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
-    graphicStyle.transform->Scale(scale, scale);
+    graphicStyle.transform = CreateRootTransform(width, height);
 
     auto saveRestore = SaveRestoreHelper{mRenderer, graphicStyle};
 
-    TraverseTree(colorMap, element);
-    SVG_ASSERT(mVisitedElements.empty());
+    PrepareInstances(colorMap);
+    TraverseTree(colorMap, element, RootMatrix(width, height));
+}
+
+Rect SVGDocumentImpl::DocumentBounds(const Element& element) const
+{
+    // Like GetBoundingBox always did, ignore the scaling to the output size.
+    Matrix matrix;
+    matrix.Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
+    return matrix.MapBounds(element.bounds).ToRect();
 }
 
 bool SVGDocumentImpl::GetBoundingBox(Rect& bound)
@@ -979,21 +1280,7 @@ bool SVGDocumentImpl::GetBoundingBox(Rect& bound)
     if (!mGroup)
         return false;
 
-    GraphicStyleImpl graphicStyle{};
-    graphicStyle.transform = mRenderer->CreateTransform();
-    graphicStyle.transform->Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
-    auto saveRestore = SaveRestoreHelper{mRenderer, graphicStyle};
-    ExtractBounds(*mGroup);
-    SVG_ASSERT(mVisitedElements.empty());
-
-    Rect sumBound{0, 0, 0, 0};
-#ifdef DEBUG_API
-    for(auto const& bound : mBounds)
-        sumBound = sumBound | bound;
-#else
-    sumBound = mBound;
-#endif
-    bound = sumBound;
+    bound = DocumentBounds(*mGroup);
     return true;
 }
 
@@ -1003,146 +1290,580 @@ bool SVGDocumentImpl::GetBoundingBox(const char* id, Rect& bound)
     if (!mGroup)
         return false;
 
-    // TODO: Maybe this needs fixing as I'm not doing any scaling, we must
-    // figure out a way to supply width/height for this I guess?
-    GraphicStyleImpl graphicStyle{};
-    graphicStyle.transform = mRenderer->CreateTransform();
-    graphicStyle.transform->Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
-    auto saveRestore = SaveRestoreHelper{mRenderer, graphicStyle};
     const auto elementIter = mIdToElementMap.find(id);
-    SVG_ASSERT(elementIter != mIdToElementMap.end());
-    ExtractBounds(*elementIter->second);
-    SVG_ASSERT(mVisitedElements.empty());
+    if (elementIter == mIdToElementMap.end())
+        return false;
 
-    Rect sumBound{0, 0, 0, 0};
-#ifdef DEBUG_API
-    for(auto const& bound : mBounds)
-        sumBound = sumBound | bound;
-#else
-    sumBound = mBound;
-#endif
-    bound = sumBound;
+    bound = DocumentBounds(*elementIter->second);
     return true;
 }
 
+bool SVGDocumentImpl::GetBoundingBoxes(const std::vector<std::string>& ids, std::vector<Rect>& bounds)
+{
+    SVG_ASSERT(mGroup);
+    if (!mGroup)
+        return false;
+
+    bool foundAll{true};
+    bounds.clear();
+    bounds.reserve(ids.size());
+    for (const auto& id : ids)
+    {
+        const auto elementIter = mIdToElementMap.find(id);
+        if (elementIter != mIdToElementMap.end())
+            bounds.push_back(DocumentBounds(*elementIter->second));
+        else
+        {
+            bounds.push_back(Rect{0, 0, 0, 0});
+            foundAll = false;
+        }
+    }
+    return foundAll;
+}
+
 #ifdef DEBUG_API
-bool GetSubBoundingBoxes(std::vector<Rect>& bounds);
+bool SVGDocumentImpl::GetSubBoundingBoxes(std::vector<Rect>& bounds)
 {
     SVG_ASSERT(mGroup);
     if (!mGroup)
         return false;
-    GraphicStyleImpl graphicStyle{};
-    graphicStyle.transform = mRenderer->CreateTransform();
-    graphicStyle.transform->Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
-    auto saveRestore = SaveRestoreHelper{mRenderer, graphicStyle};
-    ExtractBounds(*mGroup);
-    SVG_ASSERT(mVisitedElements.empty());
-    bounds = mBounds;
+
+    Matrix ctm;
+    ctm.Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
+    bounds.clear();
+    CollectLeafBounds(*mGroup, ctm, bounds);
     return true;
 }
 
-bool GetSubBoundingBoxes(const char* id, std::vector<Rect>& bounds);
+bool SVGDocumentImpl::GetSubBoundingBoxes(const char* id, std::vector<Rect>& bounds)
 {
     SVG_ASSERT(mGroup);
     if (!mGroup)
         return false;
-    GraphicStyleImpl graphicStyle{};
-    graphicStyle.transform = mRenderer->CreateTransform();
-    graphicStyle.transform->Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
-    auto saveRestore = SaveRestoreHelper{mRenderer, graphicStyle};
+
     const auto elementIter = mIdToElementMap.find(id);
-    SVG_ASSERT(elementIter != mIdToElementMap.end());
-    ExtractBounds(*elementIter->second);
-    SVG_ASSERT(mVisitedElements.empty());
-    bounds = mBounds;
+    if (elementIter == mIdToElementMap.end())
+        return false;
+
+    Matrix ctm;
+    ctm.Translate(-1 * mViewBox[0], -1 * mViewBox[1]);
+    bounds.clear();
+    CollectLeafBounds(*elementIter->second, ctm, bounds);
     return true;
 }
-#endif
 
-void SVGDocumentImpl::ExtractBounds(const Element& element)
+void SVGDocumentImpl::CollectLeafBounds(const Element& element, const Matrix& parentCTM, std::vector<Rect>& bounds)
 {
-    // This function is based on the TraverseTree function, we just calculate
-    // the bounds instead of doing any drawing.
-
-    auto graphicStyle = element.graphicStyle;
-    FillStyleImpl fillStyle{};
-    StrokeStyleImpl strokeStyle{};
-    // Has no bound contribution if there is no clipContent and clip path is set
+    // This function is based on the TraverseTree function, we just collect
+    // the bounds of every drawn path and image instead of doing any drawing.
+    const auto& graphicStyle = element.graphicStyle;
     if (graphicStyle.clippingPath && !graphicStyle.clippingPath->hasClipContent)
         return;
 
+    Matrix ctm = parentCTM;
+    ctm.Concat(graphicStyle.matrix);
     switch (element.Type())
     {
-        case ElementType::kReference:
+    case ElementType::kReference:
+    {
+        const auto& reference = static_cast<const Reference&>(element);
+        if (reference.target)
+            CollectLeafBounds(*reference.target, ctm, bounds);
+        break;
+    }
+    case ElementType::kGroup:
+    {
+        const auto& group = static_cast<const Group&>(element);
+        for (const auto& child : group.children)
+            CollectLeafBounds(*child, ctm, bounds);
+        break;
+    }
+    default:
+    {
+        const auto leafBounds = FinishBounds(element, LeafBounds(element));
+        if (!leafBounds.IsEmpty())
+            bounds.push_back(parentCTM.MapBounds(leafBounds).ToRect());
+        break;
+    }
+    }
+}
+#endif
+
+void SVGDocumentImpl::LinkReferences()
+{
+    // A pass that cuts a cycle through group children cuts a <use> on the
+    // stack instead of the edge that closed the cycle. Other cycles may
+    // then go unnoticed. Repeat until a pass cuts nothing but <use>
+    // elements that closed a cycle themselves.
+    std::vector<Element*> visitedElements;
+    std::vector<Reference*> referenceStack;
+    bool repeat{true};
+    while (repeat)
+    {
+        repeat = false;
+        for (auto element : visitedElements)
+            element->linkState = LinkState::kUnvisited;
+        visitedElements.clear();
+        // Elements in <defs> are only reachable through the ID map.
+        LinkElement(*mGroup, visitedElements, referenceStack, repeat);
+        for (auto& idElement : mIdToElementMap)
+        {
+            if (idElement.second->linkState == LinkState::kUnvisited)
+                LinkElement(*idElement.second, visitedElements, referenceStack, repeat);
+        }
+    }
+}
+
+void SVGDocumentImpl::LinkElement(
+    Element& element, std::vector<Element*>& visitedElements, std::vector<Reference*>& referenceStack, bool& repeat)
+{
+    element.linkState = LinkState::kVisiting;
+    visitedElements.push_back(&element);
+    if (element.Type() == ElementType::kReference)
+    {
+        auto& reference = static_cast<Reference&>(element);
+        reference.target = nullptr;
+        auto refIt = reference.cut ? mIdToElementMap.end() : mIdToElementMap.find(reference.href);
+        if (refIt != mIdToElementMap.end())
+        {
+            auto& target = *refIt->second;
+            // A target on the stack means the <use> closes a cycle.
+            if (target.linkState == LinkState::kVisiting)
+                reference.cut = true;
+            else
             {
-                const auto& reference = static_cast<const Reference&>(element);
-                const auto it = mVisitedElements.find(&reference);
-                if (it != mVisitedElements.end())
-                    break; // We found a cycle. Do not continue rendering.
-                auto insertResult = mVisitedElements.insert(&reference);
-
-                // Render referenced content.
-                auto refIt = mIdToElementMap.find(reference.href);
-                if (refIt != mIdToElementMap.end())
+                if (target.linkState == LinkState::kUnvisited)
                 {
-                    ApplyCSSStyle(reference.classNames, graphicStyle, fillStyle, strokeStyle);
-                    auto saveRestore = SaveRestoreHelper{mRenderer, reference.graphicStyle};
-                    ExtractBounds(*(refIt->second));
+                    referenceStack.push_back(&reference);
+                    LinkElement(target, visitedElements, referenceStack, repeat);
+                    referenceStack.pop_back();
                 }
-
-                // Done processing current element.
-                mVisitedElements.erase(insertResult.first);
-                break;
+                if (!reference.cut)
+                    reference.target = &target;
             }
-        case ElementType::kGraphic:
+        }
+    }
+    else if (element.Type() == ElementType::kGroup)
+    {
+        for (const auto& child : static_cast<Group&>(element).children)
+        {
+            if (child->linkState == LinkState::kUnvisited)
+                LinkElement(*child, visitedElements, referenceStack, repeat);
+            else if (child->linkState == LinkState::kVisiting)
             {
-                const auto& graphic = static_cast<const Graphic&>(element);
-                // TODO: Since we keep the original fill, stroke and color property values
-                // we should be able to do w/o a copy.
-                fillStyle = graphic.fillStyle;
-                strokeStyle = graphic.strokeStyle;
-                ApplyCSSStyle(graphic.classNames, graphicStyle, fillStyle, strokeStyle);
-                Rect bounds = mRenderer->GetBounds(*(graphic.path.get()), graphicStyle, fillStyle, strokeStyle);
-                if (!bounds.IsEmpty())
-                {
-#ifdef DEBUG_API
-                    mBounds.push_back(bounds);
-#else
-                    mBound = mBound | bounds;
-#endif
-                }
-                break;
+                // The child was reached through a <use> and the cycle leads
+                // back to it through its parent. Group children form a tree,
+                // so the innermost <use> on the stack is part of the cycle.
+                SVG_ASSERT(!referenceStack.empty());
+                if (!referenceStack.empty())
+                    referenceStack.back()->cut = true;
+                repeat = true;
             }
-        case ElementType::kImage:
+        }
+    }
+    element.linkState = LinkState::kLinked;
+}
+
+void SVGDocumentImpl::ComputeAllBounds()
+{
+    // Elements in <defs> are only reachable through the ID map.
+    ComputeBounds(*mGroup);
+    for (auto& idElement : mIdToElementMap)
+        ComputeBounds(*idElement.second);
+}
+
+void SVGDocumentImpl::OptimizeRenderTree()
+{
+    // Elements with an ID can be rendered by <use> or Render(id) in other
+    // contexts. Opacity of a parent must not be folded into them.
+    std::set<const Element*> sharedElements;
+    for (const auto& idElement : mIdToElementMap)
+        sharedElements.insert(idElement.second.get());
+
+    std::set<const Element*> visited;
+    OptimizeElement(*mGroup, sharedElements, visited);
+    for (auto& idElement : mIdToElementMap)
+        OptimizeElement(*idElement.second, sharedElements, visited);
+}
+
+void SVGDocumentImpl::OptimizeElement(Element& element, const std::set<const Element*>& sharedElements, std::set<const Element*>& visited)
+{
+    if (!visited.insert(&element).second)
+        return;
+
+    auto& graphicStyle = element.graphicStyle;
+    if (graphicStyle.transform && graphicStyle.matrix.IsIdentity())
+        graphicStyle.transform.reset();
+    graphicStyle.needsSave = graphicStyle.transform || graphicStyle.clippingPath;
+
+    if (element.Type() != ElementType::kGroup)
+        return;
+    auto& group = static_cast<Group&>(element);
+
+    // Drawing non-overlapping children with the group opacity each looks
+    // the same as drawing them into a layer with the group opacity.
+    bool foldOpacity = graphicStyle.opacity != 1.0f && !group.children.empty()
+        && group.children.size() <= kOpacityFoldingMaxChildren;
+    for (size_t i = 0; foldOpacity && i < group.children.size(); ++i)
+    {
+        const auto& child = *group.children[i];
+        if (sharedElements.count(&child))
+            foldOpacity = false;
+        for (size_t j = i + 1; foldOpacity && j < group.children.size(); ++j)
+        {
+            if (child.bounds.Intersects(group.children[j]->bounds))
+                foldOpacity = false;
+        }
+    }
+    if (foldOpacity)
+    {
+        for (auto& child : group.children)
+        {
+            if (child->Type() == ElementType::kGroup || child->Type() == ElementType::kReference)
+                child->graphicStyle.opacity *= graphicStyle.opacity;
+            else
+                child->foldedOpacity *= graphicStyle.opacity;
+        }
+        graphicStyle.opacity = 1.0f;
+    }
+
+    for (auto& child : group.children)
+        OptimizeElement(*child, sharedElements, visited);
+}
+
+// False if the element draws nothing with any color map. Rendering does
+// not honor display and visibility, so neither does this.
+static bool CanPaint(const SVGDocumentImpl::Element& element)
+{
+    if (!element.drawCount)
+        return false;
+    // Style sheets may change any property of elements with classes.
+    if (!element.classNames.empty())
+        return true;
+    const auto& graphicStyle = element.graphicStyle;
+    if (graphicStyle.opacity == 0 || element.foldedOpacity == 0)
+        return false;
+    if (graphicStyle.clippingPath && !graphicStyle.clippingPath->hasClipContent)
+        return false;
+    switch (element.Type())
+    {
+    case SVGDocumentImpl::ElementType::kGraphic:
+    {
+        const auto& graphic = static_cast<const SVGDocumentImpl::Graphic&>(element);
+        const auto& fillStyle = graphic.fillStyle;
+        const auto& strokeStyle = graphic.strokeStyle;
+        return (fillStyle.hasFill && fillStyle.fillOpacity > 0)
+            || (strokeStyle.hasStroke && strokeStyle.strokeOpacity > 0 && strokeStyle.lineWidth > 0);
+    }
+    case SVGDocumentImpl::ElementType::kReference:
+    {
+        const auto target = static_cast<const SVGDocumentImpl::Reference&>(element).target;
+        return target && CanPaint(*target);
+    }
+    default:
+        return true;
+    }
+}
+
+// Groups that change no state can be replaced by their children.
+static bool IsPlainGroup(const SVGDocumentImpl::Group& group)
+{
+    const auto& graphicStyle = group.graphicStyle;
+    return group.classNames.empty() && graphicStyle.matrix.IsIdentity() && !graphicStyle.clippingPath
+        && graphicStyle.opacity == 1.0f;
+}
+
+// Solid paints and colors only. Gradients never compare equal.
+template <typename T>
+static bool IsSameSolidPaint(const T& paint, const T& other)
+{
+    if (SVGNative::holds_alternative<Color>(paint))
+        return SVGNative::holds_alternative<Color>(other) && SVGNative::get<Color>(paint) == SVGNative::get<Color>(other);
+    if (SVGNative::holds_alternative<Variable>(paint))
+        return SVGNative::holds_alternative<Variable>(other) && SVGNative::get<Variable>(paint) == SVGNative::get<Variable>(other);
+    if (SVGNative::holds_alternative<ColorKeys>(paint))
+        return SVGNative::holds_alternative<ColorKeys>(other);
+    return false;
+}
+
+static bool IsSameMatrix(const Matrix& matrix, const Matrix& other)
+{
+    return matrix.a == other.a && matrix.b == other.b && matrix.c == other.c && matrix.d == other.d && matrix.e == other.e
+        && matrix.f == other.f;
+}
+
+// Graphics that only fill with a solid paint and can be merged into one path
+// with siblings.
+static bool IsMergeable(const SVGDocumentImpl::Element& element, const std::set<const SVGDocumentImpl::Element*>& sharedElements)
+{
+    if (element.Type() != SVGDocumentImpl::ElementType::kGraphic || sharedElements.count(&element) || !element.classNames.empty())
+        return false;
+    const auto& graphic = static_cast<const SVGDocumentImpl::Graphic&>(element);
+    return graphic.geometry && !graphic.graphicStyle.clippingPath && !graphic.strokeStyle.hasStroke
+        && !SVGNative::holds_alternative<GradientImpl>(graphic.fillStyle.internalPaint);
+}
+
+static bool HaveSameFill(const SVGDocumentImpl::Graphic& graphic, const SVGDocumentImpl::Graphic& other)
+{
+    return IsSameMatrix(graphic.graphicStyle.matrix, other.graphicStyle.matrix)
+        && graphic.graphicStyle.opacity == other.graphicStyle.opacity && graphic.foldedOpacity == other.foldedOpacity
+        && graphic.fillStyle.fillRule == other.fillStyle.fillRule && graphic.fillStyle.fillOpacity == other.fillStyle.fillOpacity
+        && IsSameSolidPaint(graphic.fillStyle.internalPaint, other.fillStyle.internalPaint)
+        && IsSameSolidPaint(graphic.fillStyle.color, other.fillStyle.color);
+}
+
+SimplifyStats SVGDocumentImpl::SimplifyRenderTree()
+{
+    SimplifyStats stats;
+    stats.elementsBefore = mGroup->expansionCount;
+    stats.drawsBefore = mGroup->drawCount;
+
+    // Elements with an ID can be rendered by <use> or Render(id). They are
+    // kept as they are, only their descendants get simplified.
+    std::set<const Element*> sharedElements;
+    for (const auto& idElement : mIdToElementMap)
+        sharedElements.insert(idElement.second.get());
+
+    std::set<const Element*> visited;
+    SimplifyGroup(*mGroup, sharedElements, visited);
+    for (auto& idElement : mIdToElementMap)
+    {
+        if (idElement.second->Type() == ElementType::kGroup)
+            SimplifyGroup(static_cast<Group&>(*idElement.second), sharedElements, visited);
+    }
+
+    // Recordings, bounds and counts describe the old tree.
+    ClearRecording();
+    visited.clear();
+    ResetBounds(*mGroup, visited);
+    for (auto& idElement : mIdToElementMap)
+        ResetBounds(*idElement.second, visited);
+    ComputeAllBounds();
+    mStats.expandedElements = mGroup->expansionCount;
+
+    stats.elementsAfter = mGroup->expansionCount;
+    stats.drawsAfter = mGroup->drawCount;
+    return stats;
+}
+
+void SVGDocumentImpl::SimplifyGroup(Group& group, std::set<const Element*>& sharedElements, std::set<const Element*>& visited)
+{
+    if (!visited.insert(&group).second)
+        return;
+
+    std::vector<std::shared_ptr<Element>> children;
+    children.reserve(group.children.size());
+    for (const auto& child : group.children)
+    {
+        if (!CanPaint(*child))
+            continue;
+        if (child->Type() != ElementType::kGroup)
+        {
+            children.push_back(child);
+            continue;
+        }
+        auto& childGroup = static_cast<Group&>(*child);
+        SimplifyGroup(childGroup, sharedElements, visited);
+        if (childGroup.children.empty())
+            continue;
+        if (IsPlainGroup(childGroup))
+        {
+            // A shared group keeps its children. They have two parents now
+            // and must not be changed for one of them.
+            if (sharedElements.count(&childGroup))
             {
-                const auto& image = static_cast<const Image&>(element);
-                ApplyCSSStyle(image.classNames, graphicStyle, fillStyle, strokeStyle);
-                // TODO: How to handle image's bounds?
-                auto path = mRenderer->CreatePath();
-                path->Rect(image.fillArea.x, image.fillArea.y, image.fillArea.width, image.fillArea.height);
-                Rect bounds = mRenderer->GetBounds(*path.get(), GraphicStyle{}, FillStyle{}, StrokeStyle{});
-                if (!bounds.IsEmpty())
-                {
-#ifdef DEBUG_API
-                    mBounds.push_back(bounds);
-#else
-                    mBound = mBound | bounds;
-#endif
-                }
-                break;
+                for (const auto& grandchild : childGroup.children)
+                    sharedElements.insert(grandchild.get());
             }
-        case ElementType::kGroup:
+            children.insert(children.end(), childGroup.children.begin(), childGroup.children.end());
+        }
+        else if (childGroup.children.size() == 1 && HoistChild(childGroup, sharedElements))
+            children.push_back(childGroup.children.front());
+        else
+            children.push_back(child);
+    }
+    MergeGraphics(children, sharedElements);
+    group.children = std::move(children);
+}
+
+bool SVGDocumentImpl::HoistChild(Group& group, const std::set<const Element*>& sharedElements)
+{
+    auto& child = *group.children.front();
+    if (sharedElements.count(&group) || sharedElements.count(&child) || !group.classNames.empty() || !child.classNames.empty())
+        return false;
+
+    const auto& groupStyle = group.graphicStyle;
+    auto& childStyle = child.graphicStyle;
+    if (groupStyle.clippingPath)
+    {
+        // The clipping path applies after the transform of the element it
+        // is set on.
+        if (childStyle.clippingPath || !childStyle.matrix.IsIdentity())
+            return false;
+        childStyle.clippingPath = groupStyle.clippingPath;
+    }
+    Matrix matrix = groupStyle.matrix;
+    matrix.Concat(childStyle.matrix);
+    childStyle.matrix = matrix;
+    if (matrix.IsIdentity())
+        childStyle.transform.reset();
+    else
+        childStyle.transform = mRenderer->CreateTransform(matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f);
+    childStyle.needsSave = childStyle.transform || childStyle.clippingPath;
+    // The opacity of a group with a single child is the opacity of the child.
+    if (child.Type() == ElementType::kGroup || child.Type() == ElementType::kReference)
+        childStyle.opacity *= groupStyle.opacity;
+    else
+        child.foldedOpacity *= groupStyle.opacity;
+    return true;
+}
+
+void SVGDocumentImpl::MergeGraphics(std::vector<std::shared_ptr<Element>>& children, const std::set<const Element*>& sharedElements)
+{
+    std::vector<std::shared_ptr<Element>> merged;
+    merged.reserve(children.size());
+    size_t begin{};
+    while (begin < children.size())
+    {
+        size_t end = begin + 1;
+        if (IsMergeable(*children[begin], sharedElements))
+        {
+            const auto& first = static_cast<const Graphic&>(*children[begin]);
+            Bounds runBounds = first.pathBounds;
+            size_t segmentCount = first.geometry->SegmentCount();
+            for (; end < children.size() && IsMergeable(*children[end], sharedElements); ++end)
             {
-                const auto& group = static_cast<const Group&>(element);
-                ApplyCSSStyle(group.classNames, graphicStyle, fillStyle, strokeStyle);
-                auto saveRestore = SaveRestoreHelper{mRenderer, group.graphicStyle};
-                for (const auto& child : group.children)
-                    ExtractBounds(*child);
-                break;
+                // Overlapping paths of one merged path may cancel out their
+                // winding, or get blended once where they were blended twice.
+                const auto& graphic = static_cast<const Graphic&>(*children[end]);
+                if (!HaveSameFill(first, graphic) || graphic.pathBounds.Intersects(runBounds)
+                    || segmentCount + graphic.geometry->SegmentCount() > kMergedPathMaxSegments)
+                    break;
+                runBounds.Add(graphic.pathBounds);
+                segmentCount += graphic.geometry->SegmentCount();
             }
-        default:
-            SVG_ASSERT_MSG(false, "Unknown element type");
+        }
+        if (end - begin > 1)
+            merged.push_back(MergeRun(children, begin, end));
+        else
+            merged.push_back(std::move(children[begin]));
+        begin = end;
+    }
+    children = std::move(merged);
+}
+
+std::shared_ptr<SVGDocumentImpl::Element> SVGDocumentImpl::MergeRun(
+    const std::vector<std::shared_ptr<Element>>& children, size_t begin, size_t end)
+{
+    auto& first = static_cast<Graphic&>(*children[begin]);
+    auto geometry = std::make_shared<PathGeometry>();
+    Bounds pathBounds;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const auto& graphic = static_cast<const Graphic&>(*children[i]);
+        graphic.geometry->Replay(*geometry);
+        pathBounds.Add(graphic.pathBounds);
     }
+    std::shared_ptr<Path> path = mRenderer->CreatePath();
+    geometry->Replay(*path);
+    path->SetFillRule(first.fillStyle.fillRule);
+    auto graphic = std::make_shared<Graphic>(first.graphicStyle, first.classNames, first.fillStyle, first.strokeStyle, std::move(path), pathBounds);
+    graphic->geometry = std::move(geometry);
+    graphic->foldedOpacity = first.foldedOpacity;
+    return graphic;
+}
+
+void SVGDocumentImpl::ResetBounds(Element& element, std::set<const Element*>& visited)
+{
+    if (!visited.insert(&element).second)
+        return;
+
+    element.bounds = Bounds{};
+    element.hasBounds = false;
+    element.drawCount = 0;
+    element.expansionCount = 1;
+    element.referenceCount = 0;
+    if (element.Type() != ElementType::kGroup)
+        return;
+    auto& group = static_cast<Group&>(element);
+    group.index.reset();
+    for (auto& child : group.children)
+        ResetBounds(*child, visited);
+}
+
+Bounds SVGDocumentImpl::LeafBounds(const Element& element) const
+{
+    Bounds bounds;
+    if (element.Type() == ElementType::kGraphic)
+    {
+        const auto& graphic = static_cast<const Graphic&>(element);
+        bounds = graphic.pathBounds;
+        if (graphic.strokeStyle.hasStroke)
+            bounds.Outset(StrokeOutset(graphic.strokeStyle));
+    }
+    else if (element.Type() == ElementType::kImage)
+    {
+        const auto& image = static_cast<const Image&>(element);
+        bounds = Bounds::FromRect(image.clipArea).Intersection(Bounds::FromRect(image.fillArea));
+    }
+    return bounds;
+}
+
+Bounds SVGDocumentImpl::FinishBounds(const Element& element, const Bounds& contentBounds) const
+{
+    const auto& graphicStyle = element.graphicStyle;
+    if (!graphicStyle.clippingPath)
+        return graphicStyle.matrix.MapBounds(contentBounds);
+    // Clipping paths without content have empty bounds.
+    const auto& clippingPath = static_cast<const ClippingPathImpl&>(*graphicStyle.clippingPath);
+    return graphicStyle.matrix.MapBounds(contentBounds.Intersection(clippingPath.bounds));
+}
+
+Bounds SVGDocumentImpl::ComputeBounds(Element& element)
+{
+    // References are linked without cycles. Every element gets computed once.
+    if (element.hasBounds)
+        return element.bounds;
+
+    Bounds contentBounds;
+    switch (element.Type())
+    {
+    case ElementType::kReference:
+    {
+        const auto& reference = static_cast<const Reference&>(element);
+        if (reference.target)
+        {
+            ++reference.target->referenceCount;
+            contentBounds = ComputeBounds(*reference.target);
+            element.drawCount = reference.target->drawCount;
+            element.expansionCount = AddCount(element.expansionCount, reference.target->expansionCount);
+        }
+        break;
+    }
+    case ElementType::kGroup:
+    {
+        auto& group = static_cast<Group&>(element);
+        std::vector<Bounds> childBounds;
+        childBounds.reserve(group.children.size());
+        for (const auto& child : group.children)
+        {
+            childBounds.push_back(ComputeBounds(*child));
+            contentBounds.Add(childBounds.back());
+            group.drawCount = AddCount(group.drawCount, child->drawCount);
+            group.expansionCount = AddCount(group.expansionCount, child->expansionCount);
+        }
+        if (childBounds.size() >= kSpatialIndexThreshold)
+            group.index.reset(new SpatialIndex(childBounds));
+        break;
+    }
+    default:
+        contentBounds = LeafBounds(element);
+        element.drawCount = 1;
+    }
+
+    element.bounds = FinishBounds(element, contentBounds);
+    element.hasBounds = true;
+    return element.bounds;
 }
 
 void SVGDocumentImpl::AddChildToCurrentGroup(std::shared_ptr<Element> element, std::string idString)
@@ -1215,7 +1936,37 @@ static void ResolvePaintImpl(const ColorMap& colorMap, const PaintImpl& internal
         SVG_ASSERT_MSG(false, "Unhandled PaintImpl type");
 }
 
-void SVGDocumentImpl::TraverseTree(const ColorMap& colorMap, const Element& element)
+const Path& SVGDocumentImpl::LevelOfDetailPath(const Graphic& graphic, const Matrix& ctm)
+{
+    const float scale = std::max(std::hypot(ctm.a, ctm.b), std::hypot(ctm.c, ctm.d));
+    if (!(scale > 0) || std::isinf(scale))
+        return *graphic.path;
+    // Simplify for the power of two above the scale, so that all scales of
+    // a bucket stay within the tolerance in device pixels.
+    int bucket{};
+    std::frexp(scale, &bucket);
+    if (graphic.lodTolerance != mPathLODTolerance)
+    {
+        graphic.lodPaths.clear();
+        graphic.lodTolerance = mPathLODTolerance;
+    }
+    auto& lodPath = graphic.lodPaths[bucket];
+    if (!lodPath)
+    {
+        std::shared_ptr<Path> path = mRenderer->CreatePath();
+        // Share the original path if nothing could be simplified.
+        if (graphic.geometry->Simplify(*path, std::ldexp(mPathLODTolerance, -bucket)) < graphic.geometry->SegmentCount())
+        {
+            path->SetFillRule(graphic.fillStyle.fillRule);
+            lodPath = std::move(path);
+        }
+        else
+            lodPath = graphic.path;
+    }
+    return *lodPath;
+}
+
+void SVGDocumentImpl::TraverseTree(const ColorMap& colorMap, const Element& element, const Matrix& parentCTM)
 {
     // Inheritance doesn't work for override styles. Since override styles
     // are deprecated, we are not going to fix this nor is this expected by
@@ -1226,27 +1977,37 @@ void SVGDocumentImpl::TraverseTree(const ColorMap& colorMap, const Element& elem
     // Do not draw element if an applied clipPath has no content.
     if (graphicStyle.clippingPath && !graphicStyle.clippingPath->hasClipContent)
         return;
+    // Skip the whole subtree if it is outside of the viewport.
+    Matrix ctm;
+    const bool usePathLOD = mPathLODTolerance > 0 && !mRecordingTree;
+    if (mCullToViewport || usePathLOD)
+    {
+        if (mCullToViewport && !parentCTM.MapBounds(element.bounds).Intersects(mViewport))
+            return;
+        ctm = parentCTM;
+        ctm.Concat(element.graphicStyle.matrix);
+    }
     switch (element.Type())
     {
     case ElementType::kReference:
     {
+        // Render referenced content. References without target were not
+        // found or closed a cycle.
         const auto& reference = static_cast<const Reference&>(element);
-        const auto it = mVisitedElements.find(&reference);
-        if (it != mVisitedElements.end())
-            break; // We found a cycle. Do not continue rendering.
-        auto insertResult = mVisitedElements.insert(&reference);
-
-        // Render referenced content.
-        auto refIt = mIdToElementMap.find(reference.href);
-        if (refIt != mIdToElementMap.end())
+        if (reference.target)
         {
             ApplyCSSStyle(reference.classNames, graphicStyle, fillStyle, strokeStyle);
-            auto saveRestore = SaveRestoreHelper{mRenderer, reference.graphicStyle};
-            TraverseTree(colorMap, *(refIt->second));
+            const bool needsSave = reference.graphicStyle.needsSave || reference.graphicStyle.opacity != 1.0f;
+            if (needsSave)
+                mRenderer->Save(reference.graphicStyle);
+            if (!DrawInstance(colorMap, *reference.target))
+            {
+                ++mStats.referencesTraversed;
+                TraverseTree(colorMap, *reference.target, ctm);
+            }
+            if (needsSave)
+                mRenderer->Restore();
         }
-
-        // Done processing current element.
-        mVisitedElements.erase(insertResult.first);
         break;
     }
     case ElementType::kGraphic:
@@ -1257,29 +2018,53 @@ void SVGDocumentImpl::TraverseTree(const ColorMap& colorMap, const Element& elem
         fillStyle = graphic.fillStyle;
         strokeStyle = graphic.strokeStyle;
         ApplyCSSStyle(graphic.classNames, graphicStyle, fillStyle, strokeStyle);
+        graphicStyle.opacity *= graphic.foldedOpacity;
         // If we have a CSS var() function we need to replace the placeholder with
         // an actual color from our externally provided color map here.
         Color color{{0.0f, 0.0f, 0.0f, 1.0f}};
         ResolveColorImpl(colorMap, fillStyle.color, color);
         ResolvePaintImpl(colorMap, fillStyle.internalPaint, color, fillStyle.paint);
         ResolvePaintImpl(colorMap, strokeStyle.internalPaint, color, strokeStyle.paint);
-        mRenderer->DrawPath(*(graphic.path.get()), graphicStyle, fillStyle, strokeStyle);
+        const bool drawLOD = usePathLOD && graphic.geometry && graphic.geometry->SegmentCount() >= kPathLODMinSegments;
+        const Path& path = drawLOD ? LevelOfDetailPath(graphic, ctm) : *graphic.path;
+        mRenderer->DrawPath(path, graphicStyle, fillStyle, strokeStyle);
         break;
     }
     case ElementType::kImage:
     {
         const auto& image = static_cast<const Image&>(element);
         ApplyCSSStyle(image.classNames, graphicStyle, fillStyle, strokeStyle);
-        mRenderer->DrawImage(*(image.imageData.get()), graphicStyle, image.clipArea, image.fillArea);
+        graphicStyle.opacity *= image.foldedOpacity;
+        // Payloads the renderer cannot decode are skipped.
+        auto imageData = mImageCache->Get(*mRenderer, image.fingerprint, image.base64, image.encoding);
+        if (imageData)
+            mRenderer->DrawImage(*imageData, graphicStyle, image.clipArea, image.fillArea);
         break;
     }
     case ElementType::kGroup:
     {
         const auto& group = static_cast<const Group&>(element);
         ApplyCSSStyle(group.classNames, graphicStyle, fillStyle, strokeStyle);
-        auto saveRestore = SaveRestoreHelper{mRenderer, group.graphicStyle};
-        for (const auto& child : group.children)
-            TraverseTree(colorMap, *child);
+        // Groups without transform, clipping path and opacity do not change
+        // any state.
+        const bool needsSave = group.graphicStyle.needsSave || group.graphicStyle.opacity != 1.0f;
+        if (needsSave)
+            mRenderer->Save(group.graphicStyle);
+        Matrix inverse;
+        if (mCullToViewport && group.index && ctm.Invert(inverse))
+        {
+            std::vector<std::uint32_t> visibleChildren;
+            group.index->Query(inverse.MapBounds(mViewport), visibleChildren);
+            for (auto i : visibleChildren)
+                TraverseTree(colorMap, *group.children[i], ctm);
+        }
+        else
+        {
+            for (const auto& child : group.children)
+                TraverseTree(colorMap, *child, ctm);
+        }
+        if (needsSave)
+            mRenderer->Restore();
         break;
     }
     default:
@@ -12,7 +12,13 @@ governing permissions and limitations under the License.
 
 #pragma once
 
+#include "Bounds.h"
+#include "Matrix.h"
+#include "PathGeometry.h"
+#include "SpatialIndex.h"
+#include "svgnative/ImageCache.h"
 #include "svgnative/Rect.h"
+#include "svgnative/SVGDocument.h"
 #include "svgnative/SVGRenderer.h"
 #ifdef STYLE_SUPPORT
 #include "StyleSheet/Document.h"
@@ -78,6 +84,17 @@ struct GraphicStyleImpl : public GraphicStyle
     bool display{true};
     float stopOpacity{1.0f};
     ColorImpl stopColor = Color{{0.0f, 0.0f, 0.0f, 1.0f}};
+
+    // Core copy of transform. Identity if there is no transform.
+    Matrix matrix;
+};
+
+struct ClippingPathImpl : public ClippingPath
+{
+    using ClippingPath::ClippingPath;
+
+    // Bounds of the clipping path with its transform applied.
+    Bounds bounds;
 };
 
 class SVGDocumentImpl
@@ -91,6 +108,14 @@ public:
         kReference
     };
 
+    // Depth-first search state of LinkReferences().
+    enum class LinkState : std::uint8_t
+    {
+        kUnvisited,
+        kVisiting,
+        kLinked
+    };
+
     struct Element
     {
         Element(GraphicStyleImpl& aGraphicStyle, std::set<std::string>& aClasses)
@@ -104,20 +129,45 @@ public:
         GraphicStyleImpl graphicStyle;
         std::set<std::string> classNames;
         virtual ElementType Type() const = 0;
+
+        // Bounds in the coordinate system of the parent. Includes the
+        // transform and clipping path of the element. Computed after parsing.
+        Bounds bounds;
+        bool hasBounds{};
+        LinkState linkState{};
+        // Opacity of ancestor groups folded into a graphic or image. Applied
+        // on top of the opacity of the element while rendering.
+        float foldedOpacity{1.0f};
+        // Paths and images drawn by the element and everything it
+        // references. Computed with the bounds.
+        size_t drawCount{};
+        // Elements traversed to render the element, with the content of
+        // every reference expanded. Computed with the bounds.
+        size_t expansionCount{1};
+        // Number of <use> elements that reference the element.
+        size_t referenceCount{};
+        // Recording replayed for every <use> of the element if it gets
+        // instanced. Created while rendering.
+        mutable std::unique_ptr<Recording> instance;
     };
 
     struct Image : public Element
     {
-        Image(GraphicStyleImpl& aGraphicStyle, std::set<std::string>& aClasses, std::shared_ptr<ImageData> aImageData,
-            const Rect& aClipArea, const Rect& aFillArea)
+        Image(GraphicStyleImpl& aGraphicStyle, std::set<std::string>& aClasses, std::shared_ptr<const std::string> aBase64,
+            ImageEncoding aEncoding, const Rect& aClipArea, const Rect& aFillArea)
             : Element(aGraphicStyle, aClasses)
-            , imageData{std::move(aImageData)}
+            , base64{std::move(aBase64)}
+            , fingerprint{ImageCache::Fingerprint(*base64)}
+            , encoding{aEncoding}
             , clipArea{aClipArea}
             , fillArea{aFillArea}
         {
         }
 
-        std::shared_ptr<ImageData> imageData;
+        // Undecoded payload. Decoded by the image cache on first draw.
+        std::shared_ptr<const std::string> base64;
+        std::uint64_t fingerprint;
+        ImageEncoding encoding;
         Rect clipArea;
         Rect fillArea;
         ElementType Type() const override { return ElementType::kImage; }
@@ -131,23 +181,34 @@ public:
         }
 
         std::vector<std::shared_ptr<Element>> children;
+        // Index over the bounds of children. Only built for large groups.
+        std::unique_ptr<SpatialIndex> index;
         ElementType Type() const override { return ElementType::kGroup; }
     };
 
     struct Graphic : public Element
     {
         Graphic(GraphicStyleImpl& aGraphicStyle, std::set<std::string>& aClasses, FillStyleImpl& aFillStyle, StrokeStyleImpl& aStrokeStyle,
-            std::shared_ptr<Path> aPath)
+            std::shared_ptr<Path> aPath, const Bounds& aPathBounds)
             : Element(aGraphicStyle, aClasses)
             , fillStyle{aFillStyle}
             , strokeStyle{aStrokeStyle}
             , path{std::move(aPath)}
+            , pathBounds{aPathBounds}
         {
         }
 
         FillStyleImpl fillStyle;
         StrokeStyleImpl strokeStyle;
         std::shared_ptr<Path> path;
+        Bounds pathBounds;
+        // Core copy of the path for level of detail and for merging
+        // graphics.
+        std::shared_ptr<const PathGeometry> geometry;
+        // Simplified paths by scale bucket for the tolerance they were
+        // created with. Filled while rendering.
+        mutable std::map<int, std::shared_ptr<Path>> lodPaths;
+        mutable float lodTolerance{};
 
         ElementType Type() const override { return ElementType::kGraphic; }
     };
@@ -166,11 +227,17 @@ public:
         FillStyleImpl fillStyle;
         StrokeStyleImpl strokeStyle;
         std::string href;
+        // Element with the ID href, linked after parsing. nullptr if there
+        // is none or if the reference closes a cycle.
+        Element* target{};
+        // The reference closes a cycle and never gets a target.
+        bool cut{};
 
         ElementType Type() const override { return ElementType::kReference; }
     };
 
-    SVGDocumentImpl(std::shared_ptr<SVGRenderer> renderer);
+    SVGDocumentImpl(std::shared_ptr<SVGRenderer> renderer, std::shared_ptr<ImageCache> imageCache = nullptr,
+        const ParseOptions& options = ParseOptions{});
     ~SVGDocumentImpl() {}
 
     void TraverseSVGTree(xml::XMLNode* rootNode);
@@ -195,9 +262,19 @@ public:
 #endif
     void Render(const ColorMap& colorMap, float width, float height);
     void Render(const char* id, const ColorMap& colorMap, float width, float height);
+    void Render(const Rect& viewport, const ColorMap& colorMap, float width, float height);
+
+    void SetRecordingEnabled(bool enabled);
+    void ClearRecording();
+
+    void SetPathLevelOfDetail(float tolerance);
+    void SetInstancingEnabled(bool enabled);
+    RenderStats GetRenderStats() const { return mStats; }
+    SimplifyStats SimplifyRenderTree();
 
     bool GetBoundingBox(Rect& bounds);
     bool GetBoundingBox(const char* id, Rect& bounds);
+    bool GetBoundingBoxes(const std::vector<std::string>& ids, std::vector<Rect>& bounds);
 #ifdef DEBUG_API
     bool GetSubBoundingBoxes(std::vector<Rect>& bounds);
     bool GetSubBoundingBoxes(const char* id, std::vector<Rect>& bounds);
@@ -217,7 +294,10 @@ private:
     void ParseChildren(xml::XMLNode* node);
     void ParseChild(xml::XMLNode* node);
 
-    std::unique_ptr<Path> ParseShape(xml::XMLNode* node);
+    // Keeps the core copy of the shape in *geometry if it has at least
+    // minGeometrySegments segments.
+    std::unique_ptr<Path> ParseShape(xml::XMLNode* node, Bounds& bounds, std::shared_ptr<const PathGeometry>* geometry = nullptr,
+        size_t minGeometrySegments = 0);
 
     GraphicStyleImpl ParseGraphic(const xml::XMLNode* node, FillStyleImpl& fillStyle, StrokeStyleImpl& strokeStyle, std::set<std::string>& classNames);
     void ParseFillProperties(FillStyleImpl& fillStyle, const PropertySet& propertySet);
@@ -227,9 +307,37 @@ private:
     PropertySet ParsePresentationAttributes(const xml::XMLNode* node);
 
     void RenderElement(const Element& element, const ColorMap& colorMap, float width, float height);
-    void ExtractBounds(const Element& element);
+    std::unique_ptr<Transform> CreateRootTransform(float width, float height) const;
+    Matrix RootMatrix(float width, float height) const;
+    bool RenderRecording(const ColorMap& colorMap, float width, float height);
+    Rect RecordingBounds(const Bounds& bounds) const;
+    void PrepareInstances(const ColorMap& colorMap);
+    void ClearInstances();
+    bool DrawInstance(const ColorMap& colorMap, const Element& element);
+
+    void LinkReferences();
+    void LinkElement(
+        Element& element, std::vector<Element*>& visitedElements, std::vector<Reference*>& referenceStack, bool& repeat);
+    void ComputeAllBounds();
+    Bounds ComputeBounds(Element& element);
+    Bounds LeafBounds(const Element& element) const;
+    Bounds FinishBounds(const Element& element, const Bounds& contentBounds) const;
+    Rect DocumentBounds(const Element& element) const;
+
+    void OptimizeRenderTree();
+    void OptimizeElement(Element& element, const std::set<const Element*>& sharedElements, std::set<const Element*>& visited);
+    void SimplifyGroup(Group& group, std::set<const Element*>& sharedElements, std::set<const Element*>& visited);
+    bool HoistChild(Group& group, const std::set<const Element*>& sharedElements);
+    void MergeGraphics(std::vector<std::shared_ptr<Element>>& children, const std::set<const Element*>& sharedElements);
+    std::shared_ptr<Element> MergeRun(const std::vector<std::shared_ptr<Element>>& children, size_t begin, size_t end);
+    void ResetBounds(Element& element, std::set<const Element*>& visited);
+#ifdef DEBUG_API
+    void CollectLeafBounds(const Element& element, const Matrix& ctm, std::vector<Rect>& bounds);
+#endif
 
-    void TraverseTree(const ColorMap& colorMap, const Element&);
+    void PrefetchImages();
+    void TraverseTree(const ColorMap& colorMap, const Element&, const Matrix& ctm);
+    const Path& LevelOfDetailPath(const Graphic& graphic, const Matrix& ctm);
 
     void ApplyCSSStyle(
         const std::set<std::string>& classNames, GraphicStyleImpl& graphicStyle, FillStyleImpl& fillStyle, StrokeStyleImpl& strokeStyle);
@@ -249,11 +357,6 @@ private:
     // hierarchy.
     std::stack<StrokeStyleImpl> mStrokeStyleStack;
     std::stack<FillStyleImpl> mFillStyleStack;
-#ifdef DEBUG_API
-    std::vector<Rect> mBounds;
-#else
-    Rect mBound{0, 0, 0, 0};
-#endif
 
 #ifdef STYLE_SUPPORT
     const StyleSheet::CssDocument* mOverrideStyle{};
@@ -270,8 +373,41 @@ private:
     std::shared_ptr<Group> mGroup;
     std::map<std::string, std::shared_ptr<Element>> mIdToElementMap;
 
-    // Visited nodes to detect cycles.
-    std::set<const Element*> mVisitedElements;
+    // Area in device coordinates that is rendered. Elements outside of it
+    // are skipped if mCullToViewport is set.
+    Bounds mViewport;
+    bool mCullToViewport{};
+
+    // Decoded images, shared with other documents if passed by the client.
+    // All images of the document are queued on the workers of the cache
+    // with the first rendering.
+    std::shared_ptr<ImageCache> mImageCache;
+    std::vector<std::shared_ptr<const Image>> mImages;
+    bool mImagesPrefetched{};
+
+    // Maximal deviation of simplified paths in device pixels. 0 disables
+    // level of detail.
+    float mPathLODTolerance{};
+    // Segments of the shape being parsed, reused across shapes.
+    PathGeometry mParsedPath;
+    // Graphics keep their core geometry for merging, not only large paths.
+    bool mKeepShapeGeometry{};
+
+    // Vector recording of the whole document without the root transform,
+    // replayed by Render() while the color map stays the same.
+    bool mRecordingEnabled{};
+    std::unique_ptr<Recording> mRecording;
+    ColorMap mRecordingColorMap;
+    // The tree gets recorded for replay at any scale.
+    bool mRecordingTree{};
+
+    // Referenced content recorded once and replayed by every <use>.
+    bool mInstancingEnabled{true};
+    std::vector<const Element*> mInstancedElements;
+    ColorMap mInstanceColorMap;
+    std::unique_ptr<Transform> mInstanceTransform;
+
+    RenderStats mStats;
 
 #if DEBUG
     std::string mTitle;
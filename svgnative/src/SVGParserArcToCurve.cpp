@@ -1,5 +1,5 @@
 /*
-Copyright 2016 Adobe. All rights reserved.
+Copyright 2022 Adobe. All rights reserved.
 This file is licensed to you under the Apache License, Version 2.0 (the "License");
 you may not use this file except in compliance with the License. You may obtain a copy
 of the License at http://www.apache.org/licenses/LICENSE-2.0
@@ -10,206 +10,135 @@ OF ANY KIND, either express or implied. See the License for the specific languag
 governing permissions and limitations under the License.
 */
 
-#include "svgnative/SVGDocument.h"
-#include "svgnative/SVGRenderer.h"
+#include "SVGParserArcToCurve.h"
 
-#define _USE_MATH_DEFINES
+#include <algorithm>
 #include <cmath>
-#ifndef M_PI
-#define M_PI 3.14159265358979323846f
-#endif
 
 namespace SVGNative
 {
 
-void RotatePoint(float& x, float& y, float angle);
-void RotatePoint(float& /*x*/, float& /*y*/, float /*angle*/) { SVG_ASSERT(false); }
-
-void AddArcToCurve(SVGNative::Path& path, float startX, float startY, float radiusX, float radiusY, float angle,
-    float endX, float endY, float startAngle, float endAngle, float& endControlX, float& endControlY);
-void AddArcToCurve(SVGNative::Path& path, float startX, float startY, float radiusX, float radiusY, float /*angle*/,
-    float endX, float endY, float startAngle, float endAngle, float& endControlX, float& endControlY)
+namespace
 {
-    // trigonometry
-    float t = tan((endAngle - startAngle) / 4);
-    float hx = radiusX * t * 4 / 3;
-    float hy = radiusY * t * 4 / 3;
-
-    // calculate control points
-    float startCPX = startX + hx * sin(startAngle);
-    float startCPY = startY - hy * cos(startAngle);
-
-    startCPX = 2 * startX - startCPX;
-    startCPY = 2 * startY - startCPY;
-
-    float endCPX = endX + hx * sin(endAngle);
-    float endCPY = endY - hy * cos(endAngle);
-
-    // !!! don't forget to rotate points back to the original reference frame
-
-    // add curve
-    path.CurveTo(startCPX, startCPY, endCPX, endCPY, endX, endY);
-
-    endControlX = endCPX;
-    endControlY = endCPY;
-
-    SVG_PARSE_TRACE("AddArcToCurve startAngle=" << (startAngle * 180 / M_PI) << " endAngle=" << (endAngle * 180 / M_PI));
-    SVG_PARSE_TRACE("AddArcToCurve startCP=("
-        << startCPX << "," << startCPY << ") endCP=(" << endCPX << "," << endCPY << ") EndPoint=(" << endX
-        << "," << endY << ")");
+constexpr double kPi{3.14159265358979323846};
+// Segments per arc. Arcs sweep at most 360°.
+constexpr int kMaxArcSegments{4};
 }
 
-void ArcToCurve(SVGNative::Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool sweep,
-    float endX, float endY, float startAngle, float endAngle, float centerX, float centerY, float& endControlX,
-    float& endControlY);
-void ArcToCurve(SVGNative::Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool sweep,
-    float endX, float endY, float startAngle, float endAngle, float centerX, float centerY, float& endControlX,
-    float& endControlY)
-{
-    float angleDiff = endAngle - startAngle;
-    if (std::abs(angleDiff) > M_PI * 120.0f / 180.0f)
-    {
-        // too wide so we need to break it up into multiple curves
-        float endAngleNext = endAngle;
-        float endXNext = endX;
-        float endYNext = endY;
-
-        endAngle = startAngle + (M_PI * 120.0f / 180.0f) * ((sweep && (endAngle > startAngle)) ? 1 : -1);
-        endX = centerX + radiusX * cos(endAngle);
-        endY = centerY + radiusY * sin(endAngle);
-
-        AddArcToCurve(
-            path, startX, startY, radiusX, radiusY, angle, endX, endY, startAngle, endAngle, endControlX, endControlY);
-        ArcToCurve(path, endX, endY, radiusX, radiusY, angle, sweep, endXNext, endYNext, endAngle, endAngleNext,
-            centerX, centerY, endControlX, endControlY);
-    }
-    else
-    {
-        AddArcToCurve(
-            path, startX, startY, radiusX, radiusY, angle, endX, endY, startAngle, endAngle, endControlX, endControlY);
-    }
-}
-
-void ArcToCurve(SVGNative::Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool large,
-    bool sweep, float endX, float endY, float& endControlX, float& endControlY);
-void ArcToCurve(SVGNative::Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool large,
-    bool sweep, float endX, float endY, float& endControlX, float& endControlY)
+void ArcToCurve(Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool large, bool sweep,
+    float endX, float endY, float& endControlX, float& endControlY)
 {
     // https://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes
 
-    SVG_ASSERT(angle == 0); // untested
+    // F.6.2: arcs with equal end points are omitted.
+    if (startX == endX && startY == endY)
+    {
+        endControlX = endX;
+        endControlY = endY;
+        return;
+    }
 
-    if (radiusX == 0 || radiusY == 0)
+    double rx = std::abs(static_cast<double>(radiusX));
+    double ry = std::abs(static_cast<double>(radiusY));
+    if (rx == 0 || ry == 0 || !std::isfinite(rx) || !std::isfinite(ry))
     {
         // this is actually a line
         path.LineTo(endX, endY);
         return;
     }
 
-    SVG_ASSERT(radiusX == radiusY); // untested
-
-    SVG_ASSERT(radiusX != 0 && radiusY != 0);
-
-    SVG_PARSE_TRACE("ArcToCurve ----------------------------------------------");
-    SVG_PARSE_TRACE("parsePathString ArcToCurve: rx="
-                          << radiusX << " ry=" << radiusY << " large=" << large << " sweep=" << sweep << " previous=("
-                          << startX << "," << startY << ")"
-                          << " next=(" << endX << "," << endY << ")");
-
-    angle = M_PI / 180 * angle; // all radians all the time
-
-    if (radiusX != radiusY)
-        SVG_PARSE_TRACE("parsePathString ELLIPTICAL: " << angle);
-
-    // handle rotation here and when we plot points to the path.CurveTo !!!
-    //	RotatePoint(startX, startY, angle);
-    //	RotatePoint(endX, endY, angle);
-
-    // Calculate the whatchamacallit.
-    float hx = (startX - endX) / 2;
-    float hy = (startY - endY) / 2;
-
-    // correct out of range radii F.6.6
-    float validateRadii = (hx * hx) / (radiusX * radiusX) + (hy * hy) / (radiusY * radiusY);
-    if (validateRadii > 1)
+    // All trigonometry happens once per arc. Segments are rotated on by a
+    // fixed angle.
+    const double phi = kPi / 180 * angle;
+    const double cosPhi = std::cos(phi);
+    const double sinPhi = std::sin(phi);
+
+    // F.6.5.1: end points in the coordinate system of the ellipse, with
+    // the center in the middle between them.
+    const double hx = (static_cast<double>(startX) - endX) / 2;
+    const double hy = (static_cast<double>(startY) - endY) / 2;
+    const double x1 = cosPhi * hx + sinPhi * hy;
+    const double y1 = -sinPhi * hx + cosPhi * hy;
+
+    // F.6.6.2: scale up radii that are too small to reach the end point.
+    const double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+    if (lambda > 1)
     {
-        radiusX = radiusX * sqrt(validateRadii);
-        radiusY = radiusY * sqrt(validateRadii);
+        rx *= std::sqrt(lambda);
+        ry *= std::sqrt(lambda);
     }
 
-    SVG_PARSE_TRACE("ArcToCurve final radii: rx=" << radiusX << " ry=" << radiusY);
-
-    // start calculating
-    // F.6.5.2
-    float radiusX2(radiusX * radiusX);
-    float radiusY2(radiusY * radiusY);
-    float HX2(hx * hx);
-    float HY2(hy * hy);
-
-    float k = (radiusX2 * radiusY2 - radiusX2 * HY2 - radiusY2 * HX2) / (radiusX2 * HY2 + radiusY2 * HX2);
-    k = sqrt(std::abs(k)) * (large == sweep ? -1 : 1);
-
-    float centerX = k * (radiusX * hy / radiusY);
-    float centerY = k * (-radiusY * hx / radiusX);
-
-    // F.6.5.3 - center of ellipse
-    centerX += (startX + endX) / 2;
-    centerY += (startY + endY) / 2;
-
-    SVG_PARSE_TRACE("parsePathString ArcToCurve: center(" << centerX << "," << centerY << ")");
-    SVG_PARSE_TRACE("parsePathString ArcToCurve: radius("
-                              << sqrt((centerX - startX) * (centerX - startX) + (centerY - startY) * (centerY - startY))
-                              << "," << sqrt((centerX - endX) * (centerX - endX) + (centerY - endY) * (centerY - endY))
-                              << ")");
-
-    // calculate angles
-    // F.6.5.4 to F.6.5.6
-    float aS = (startY - centerY) / radiusY;
-    float aE = (endY - centerY) / radiusY;
-
-    // preventing out of range errors with asin due to floating point errors
-    aS = std::min(aS, 1.0f);
-    aS = std::max(aS, -1.0f);
-
-    aE = std::min(aE, 1.0f);
-    aE = std::max(aE, -1.0f);
-
-    SVG_ASSERT_MSG(aS >= -1 && aS <= 1, "aS: " << aS);
-    SVG_ASSERT_MSG(aE >= -1 && aE <= 1, "aE: " << aE);
-
-    // get the angle
-    float startAngle = asin(aS);
-    float endAngle = asin(aE);
-
-    if (startX < centerX)
-        startAngle = M_PI - startAngle;
-
-    if (endX < centerX)
-        endAngle = M_PI - endAngle;
-
-    if (startAngle < 0)
-        startAngle = M_PI * 2 + startAngle;
-
-    if (endAngle < 0)
-        endAngle = M_PI * 2 + endAngle;
-
-    SVG_PARSE_TRACE(
-        "parsePathString ArcToCurve: angles(" << (startAngle * 180 / M_PI) << "," << (endAngle * 180 / M_PI) << ")");
-
-    if (sweep && startAngle > endAngle)
+    // F.6.5.2: center in the coordinate system of the ellipse.
+    const double rx2y1 = rx * rx * y1 * y1;
+    const double ry2x1 = ry * ry * x1 * x1;
+    double k = std::sqrt(std::max(0.0, (rx * rx * ry * ry - rx2y1 - ry2x1) / (rx2y1 + ry2x1)));
+    if (large == sweep)
+        k = -k;
+    const double cx1 = k * rx * y1 / ry;
+    const double cy1 = -k * ry * x1 / rx;
+
+    // F.6.5.3
+    const double centerX = cosPhi * cx1 - sinPhi * cy1 + (static_cast<double>(startX) + endX) / 2;
+    const double centerY = sinPhi * cx1 + cosPhi * cy1 + (static_cast<double>(startY) + endY) / 2;
+
+    // F.6.5.5 and F.6.5.6: start and sweep angles on the unit circle.
+    const double ux = (x1 - cx1) / rx;
+    const double uy = (y1 - cy1) / ry;
+    const double vx = (-x1 - cx1) / rx;
+    const double vy = (-y1 - cy1) / ry;
+    const double startAngle = std::atan2(uy, ux);
+    double sweepAngle = std::atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+    if (sweep && sweepAngle < 0)
+        sweepAngle += 2 * kPi;
+    else if (!sweep && sweepAngle > 0)
+        sweepAngle -= 2 * kPi;
+
+    // Quarter arcs from float input sweep slightly more than 90°. Allow for
+    // that instead of adding a segment, the error bound has the margin.
+    const int segmentCount = std::min(kMaxArcSegments, std::max(1, static_cast<int>(std::ceil(std::abs(sweepAngle) / (kPi / 2) - 1e-3))));
+    const double segmentAngle = sweepAngle / segmentCount;
+    const double cosSegment = std::cos(segmentAngle);
+    const double sinSegment = std::sin(segmentAngle);
+    // Length of the tangents on the unit circle.
+    const double handle = 4.0 / 3.0 * std::tan(segmentAngle / 4);
+
+    // Maps the unit circle onto the ellipse.
+    const double a = rx * cosPhi;
+    const double b = rx * sinPhi;
+    const double c = -ry * sinPhi;
+    const double d = ry * cosPhi;
+
+    float points[kMaxArcSegments * 6];
+    double cosAngle = std::cos(startAngle);
+    double sinAngle = std::sin(startAngle);
+    for (int i = 0; i < segmentCount; ++i)
     {
-        startAngle = startAngle - M_PI * 2.0f;
+        const double cosNext = cosAngle * cosSegment - sinAngle * sinSegment;
+        const double sinNext = sinAngle * cosSegment + cosAngle * sinSegment;
+        const double control1X = cosAngle - handle * sinAngle;
+        const double control1Y = sinAngle + handle * cosAngle;
+        const double control2X = cosNext + handle * sinNext;
+        const double control2Y = sinNext - handle * cosNext;
+        float* p = points + i * 6;
+        p[0] = static_cast<float>(centerX + a * control1X + c * control1Y);
+        p[1] = static_cast<float>(centerY + b * control1X + d * control1Y);
+        p[2] = static_cast<float>(centerX + a * control2X + c * control2Y);
+        p[3] = static_cast<float>(centerY + b * control2X + d * control2Y);
+        p[4] = static_cast<float>(centerX + a * cosNext + c * sinNext);
+        p[5] = static_cast<float>(centerY + b * cosNext + d * sinNext);
+        cosAngle = cosNext;
+        sinAngle = sinNext;
     }
-    if (!sweep && endAngle > startAngle)
-    {
-        endAngle = endAngle - M_PI * 2.0f;
-    }
-
-    SVG_PARSE_TRACE(
-        "parsePathString ArcToCurve: anglesF(" << (startAngle * 180.0f / M_PI) << "," << (endAngle * 180.0f / M_PI) << ")");
-
-    ArcToCurve(path, startX, startY, radiusX, radiusY, angle, sweep, endX, endY, startAngle, endAngle, centerX, centerY,
-        endControlX, endControlY);
+    // End exactly on the requested point, without accumulated rounding.
+    float* last = points + (segmentCount - 1) * 6;
+    last[4] = endX;
+    last[5] = endY;
+
+    std::uint8_t verbs[kMaxArcSegments];
+    std::fill(verbs, verbs + segmentCount, static_cast<std::uint8_t>(PathVerb::kCurve));
+    path.Append(verbs, static_cast<size_t>(segmentCount), points, static_cast<size_t>(segmentCount) * 3);
+    endControlX = last[2];
+    endControlY = last[3];
 }
 
-}
+} // namespace SVGNative
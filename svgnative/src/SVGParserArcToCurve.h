@@ -0,0 +1,37 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_SVGParserArcToCurve_h
+#define SVGViewer_SVGParserArcToCurve_h
+
+#include "svgnative/SVGRenderer.h"
+
+namespace SVGNative
+{
+/**
+ * Maximal distance of the curves of ArcToCurve from the ellipse, relative to
+ * the larger radius. Arcs are split into segments of at most 90°.
+ */
+constexpr float kArcToCurveMaxError{2.8e-4f};
+
+/**
+ * Appends an elliptical arc in SVG endpoint parameterization as cubic
+ * Béziers to \p path. See https://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes
+ * @param angle Rotation of the x-axis of the ellipse in degrees.
+ * @param endControlX, endControlY Second control point of the last curve.
+ */
+void ArcToCurve(Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool large, bool sweep,
+    float endX, float endY, float& endControlX, float& endControlY);
+
+} // namespace SVGNative
+
+#endif // SVGViewer_SVGParserArcToCurve_h
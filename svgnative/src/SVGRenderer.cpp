@@ -16,10 +16,83 @@ governing permissions and limitations under the License.
 namespace SVGNative
 {
 
+template <typename T>
+static void AppendKeyBytes(std::string& key, const T& value)
+{
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void AppendGradientKey(std::string& key, const Gradient& gradient, float opacity)
+{
+    AppendKeyBytes(key, gradient.type);
+    AppendKeyBytes(key, gradient.method);
+    for (float value : {gradient.x1, gradient.y1, gradient.x2, gradient.y2, gradient.cx, gradient.cy, gradient.fx, gradient.fy, gradient.r, opacity})
+        AppendKeyBytes(key, value);
+    // The count separates the stops from the matrix ports append.
+    AppendKeyBytes(key, gradient.colorStops.size());
+    for (const auto& stop : gradient.colorStops)
+    {
+        AppendKeyBytes(key, stop.first);
+        AppendKeyBytes(key, stop.second);
+    }
+}
+
+void Path::Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount)
+{
+    const float* end = points + 2 * pointCount;
+    for (size_t i = 0; i < verbCount; ++i)
+    {
+        switch (static_cast<PathVerb>(verbs[i]))
+        {
+        case PathVerb::kMove:
+            if (end - points < 2)
+                return;
+            MoveTo(points[0], points[1]);
+            points += 2;
+            break;
+        case PathVerb::kLine:
+            if (end - points < 2)
+                return;
+            LineTo(points[0], points[1]);
+            points += 2;
+            break;
+        case PathVerb::kCurve:
+            if (end - points < 6)
+                return;
+            CurveTo(points[0], points[1], points[2], points[3], points[4], points[5]);
+            points += 6;
+            break;
+        case PathVerb::kQuadCurve:
+            if (end - points < 4)
+                return;
+            CurveToV(points[0], points[1], points[2], points[3]);
+            points += 4;
+            break;
+        case PathVerb::kClose:
+            ClosePath();
+            break;
+        }
+    }
+}
+
 Rect SVGRenderer::GetBounds(const Path&, const GraphicStyle&, const FillStyle&, const StrokeStyle&)
 {
     throw "Bound calculation functionality not implemented in this port";
     return Rect{0, 0, 0, 0};
 }
 
+bool SVGRenderer::BeginRecording(const Rect&)
+{
+    return false;
+}
+
+std::unique_ptr<Recording> SVGRenderer::EndRecording()
+{
+    return nullptr;
+}
+
+void SVGRenderer::DrawRecording(const Recording&, const Transform&)
+{
+}
+
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ governing permissions and limitations under the License.
 
 #include "SVGStringParser.h"
 #include "CSSColorKeywords.h"
+#include "SVGParserArcToCurve.h"
 #include "svgnative/SVGDocument.h"
 #include <algorithm>
 #include <array>
@@ -24,9 +25,6 @@ governing permissions and limitations under the License.
 
 namespace SVGNative
 {
-void ArcToCurve(Path& path, float startX, float startY, float radiusX, float radiusY, float angle, bool large, bool sweep, float endX,
-    float endY, float& endControlX, float& endControlY);
-
 namespace SVGStringParser
 {
 using CharIt = std::string::const_iterator;
@@ -828,8 +826,6 @@ void ParsePathString(const std::string& pathString, Path& p)
                 currentY += newY;
             }
 
-            SVG_ASSERT(angle == 0);
-
             ArcToCurve(p, startX, startY, rx, ry, angle, flagLarge, flagSweep, currentX, currentY, prevControlX, prevControlY);
 
             SVG_PARSE_TRACE("parsePathString ArcToCurve: controlPoint: " << prevControlX << "," << prevControlY);
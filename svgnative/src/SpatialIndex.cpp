@@ -0,0 +1,115 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "SpatialIndex.h"
+
+#include <algorithm>
+
+namespace SVGNative
+{
+namespace
+{
+constexpr std::uint32_t kMaxLeafSize = 4;
+
+float Center(float minValue, float maxValue)
+{
+    // Infinite bounds have no meaningful center. Keep them together.
+    const float center = (minValue + maxValue) / 2;
+    return center == center ? center : 0;
+}
+} // namespace
+
+SpatialIndex::SpatialIndex(const std::vector<Bounds>& bounds)
+    : mBounds{bounds}
+{
+    mItems.reserve(bounds.size());
+    for (std::uint32_t i = 0; i < bounds.size(); ++i)
+    {
+        if (!bounds[i].IsEmpty())
+            mItems.push_back(i);
+    }
+    if (mItems.empty())
+        return;
+    mNodes.reserve(2 * mItems.size() / kMaxLeafSize + 1);
+    mNodes.emplace_back();
+    Build(0, 0, static_cast<std::uint32_t>(mItems.size()));
+}
+
+void SpatialIndex::Build(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end)
+{
+    Bounds nodeBounds;
+    Bounds centers;
+    for (auto i = begin; i < end; ++i)
+    {
+        const auto& itemBounds = mBounds[mItems[i]];
+        nodeBounds.Add(itemBounds);
+        centers.Add(Center(itemBounds.minX, itemBounds.maxX), Center(itemBounds.minY, itemBounds.maxY));
+    }
+    mNodes[nodeIndex].bounds = nodeBounds;
+
+    if (end - begin <= kMaxLeafSize)
+    {
+        mNodes[nodeIndex].first = begin;
+        mNodes[nodeIndex].count = end - begin;
+        return;
+    }
+
+    const bool splitX = centers.maxX - centers.minX >= centers.maxY - centers.minY;
+    const auto middle = begin + (end - begin) / 2;
+    std::nth_element(mItems.begin() + begin, mItems.begin() + middle, mItems.begin() + end,
+        [this, splitX](std::uint32_t a, std::uint32_t b) {
+            const auto& boundsA = mBounds[a];
+            const auto& boundsB = mBounds[b];
+            return splitX ? Center(boundsA.minX, boundsA.maxX) < Center(boundsB.minX, boundsB.maxX)
+                          : Center(boundsA.minY, boundsA.maxY) < Center(boundsB.minY, boundsB.maxY);
+        });
+
+    // Siblings are stored next to each other.
+    const auto leftIndex = static_cast<std::uint32_t>(mNodes.size());
+    mNodes[nodeIndex].first = leftIndex;
+    mNodes.emplace_back();
+    mNodes.emplace_back();
+    Build(leftIndex, begin, middle);
+    Build(leftIndex + 1, middle, end);
+}
+
+void SpatialIndex::Query(const Bounds& area, std::vector<std::uint32_t>& result) const
+{
+    result.clear();
+    if (mNodes.empty() || !area.Intersects(mNodes[0].bounds))
+        return;
+
+    std::uint32_t stack[64];
+    std::size_t stackSize{};
+    stack[stackSize++] = 0;
+    while (stackSize)
+    {
+        const auto& node = mNodes[stack[--stackSize]];
+        if (node.count)
+        {
+            for (auto i = node.first; i < node.first + node.count; ++i)
+            {
+                if (area.Intersects(mBounds[mItems[i]]))
+                    result.push_back(mItems[i]);
+            }
+            continue;
+        }
+        for (auto child = node.first; child < node.first + 2; ++child)
+        {
+            if (area.Intersects(mNodes[child].bounds))
+                stack[stackSize++] = child;
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+} // namespace SVGNative
@@ -0,0 +1,63 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_SpatialIndex_h
+#define SVGViewer_SpatialIndex_h
+
+#include "Bounds.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace SVGNative
+{
+/**
+ * Static bounding volume hierarchy over a list of bounds.
+ *
+ * Built once after parsing over the children of a group. Nodes split at
+ * the median of the longest axis. Items with empty bounds are not indexed
+ * and never returned by queries.
+ */
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(const std::vector<Bounds>& bounds);
+
+    /**
+     * Collects the indices of all items whose bounds intersect area.
+     * @param result Receives the indices in ascending order, which is the
+     *      painting order of the indexed children.
+     */
+    void Query(const Bounds& area, std::vector<std::uint32_t>& result) const;
+
+    std::size_t Size() const { return mItems.size(); }
+
+private:
+    struct Node
+    {
+        Bounds bounds;
+        // Leaves reference count items starting at first in mItems. Inner
+        // nodes have count 0 and their children at first and first + 1.
+        std::uint32_t first{};
+        std::uint32_t count{};
+    };
+
+    void Build(std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end);
+
+    std::vector<Node> mNodes;
+    std::vector<std::uint32_t> mItems;
+    std::vector<Bounds> mBounds;
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_SpatialIndex_h
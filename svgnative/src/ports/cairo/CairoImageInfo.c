@@ -40,9 +40,43 @@ _cairo_jpeg_error_exit(j_common_ptr cinfo)
     longjmp(_cairo_jpeg_err->setjmp_buffer, 1);
 }
 
+int
+_cairo_jpeg_stream_get_size(const unsigned char* data,
+                            unsigned int length,
+                            int* width,
+                            int* height)
+{
+    struct jpeg_decompress_struct cinfo;
+    struct _cairo_jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = _cairo_jpeg_error_exit;
+
+    if (setjmp(jerr.setjmp_buffer))
+    {
+        jpeg_destroy_decompress(&cinfo);
+        return 0;
+    };
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, data, length);
+    jpeg_read_header(&cinfo, TRUE);
+    *width = cinfo.image_width;
+    *height = cinfo.image_height;
+    jpeg_destroy_decompress(&cinfo);
+    return 1;
+}
+
 cairo_surface_t *
 _cairo_image_surface_create_from_jpeg_stream(const unsigned char* data,
                                              unsigned int length)
+{
+    return _cairo_image_surface_create_from_jpeg_stream_scaled(data, length, 1);
+}
+
+cairo_surface_t *
+_cairo_image_surface_create_from_jpeg_stream_scaled(const unsigned char* data,
+                                                    unsigned int length,
+                                                    unsigned int scale_denom)
 {
     cairo_surface_t* _cairo_jpeg_surface = NULL;
 
@@ -66,6 +100,12 @@ _cairo_image_surface_create_from_jpeg_stream(const unsigned char* data,
     jpeg_mem_src(&cinfo, data, length);
     jpeg_read_header(&cinfo, TRUE);
 
+    /* let the IDCT produce the downscaled image directly, which is much
+     * cheaper than decoding the full image and scaling it afterwards
+     */
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = scale_denom;
+
     cairo_format_t cairo_color_format;
     switch (cinfo.out_color_space)
     {
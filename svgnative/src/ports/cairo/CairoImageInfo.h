@@ -22,6 +22,21 @@ cairo_surface_t *
 _cairo_image_surface_create_from_jpeg_stream(const unsigned char* data,
                                              unsigned int length);
 
+/* scale_denom is 1, 2, 4 or 8. The result is ceil(width / scale_denom) by
+ * ceil(height / scale_denom) pixels.
+ */
+cairo_surface_t *
+_cairo_image_surface_create_from_jpeg_stream_scaled(const unsigned char* data,
+                                                    unsigned int length,
+                                                    unsigned int scale_denom);
+
+/* returns 0 if the header cannot be read */
+int
+_cairo_jpeg_stream_get_size(const unsigned char* data,
+                            unsigned int length,
+                            int* width,
+                            int* height);
+
 typedef struct _png_blob_closure
 {
     const unsigned char*  blob;
@@ -0,0 +1,174 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ports/cairo/CairoRasterCache.h"
+#include "svgnative/ports/cairo/CairoSVGRenderer.h"
+#include "svgnative/SVGDocument.h"
+#include "Hash.h"
+#include "cairo.h"
+
+#include <functional>
+
+namespace SVGNative
+{
+
+namespace
+{
+std::shared_ptr<CairoRasterCache::Raster> Rasterize(
+    const std::string& svgSource, const std::string& id, int width, int height, const ColorMap& colorMap)
+{
+    // The XML parser may modify the buffer in place.
+    const std::string source{svgSource};
+    auto renderer = std::make_shared<CairoSVGRenderer>();
+    auto doc = SVGDocument::CreateSVGDocument(source.c_str(), renderer);
+    if (!doc)
+        return nullptr;
+
+    std::shared_ptr<CairoRasterCache::Raster> raster{new CairoRasterCache::Raster};
+    raster->width = width;
+    raster->height = height;
+    raster->stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+    raster->pixels.resize(static_cast<size_t>(raster->stride) * height);
+
+    // Render straight into the buffer of the raster.
+    cairo_surface_t* surface = cairo_image_surface_create_for_data(
+        raster->pixels.data(), CAIRO_FORMAT_ARGB32, width, height, raster->stride);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+    cairo_t* cr = cairo_create(surface);
+    renderer->SetCairo(cr);
+    if (id.empty())
+        doc->Render(colorMap, static_cast<float>(width), static_cast<float>(height));
+    else
+        doc->Render(id.c_str(), colorMap, static_cast<float>(width), static_cast<float>(height));
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    cairo_surface_destroy(surface);
+    return raster;
+}
+} // namespace
+
+bool CairoRasterCache::Key::operator==(const Key& other) const
+{
+    return fingerprint == other.fingerprint && width == other.width && height == other.height && id == other.id
+        && colorMap == other.colorMap;
+}
+
+size_t CairoRasterCache::KeyHash::operator()(const Key& key) const
+{
+    std::uint64_t hash = HashBytes(&key.fingerprint, sizeof(key.fingerprint));
+    hash = HashBytes(&key.width, sizeof(key.width), hash);
+    hash = HashBytes(&key.height, sizeof(key.height), hash);
+    hash = HashBytes(key.id.data(), key.id.size(), hash);
+    for (const auto& entry : key.colorMap)
+    {
+        hash = HashBytes(entry.first.data(), entry.first.size(), hash);
+        hash = HashBytes(entry.second.data(), sizeof(entry.second), hash);
+    }
+    return static_cast<size_t>(hash);
+}
+
+CairoRasterCache::CairoRasterCache(size_t byteBudget)
+    : mByteBudget{byteBudget}
+{
+}
+
+std::uint64_t CairoRasterCache::Fingerprint(const std::string& svgSource)
+{
+    return HashLargeBytes(svgSource.data(), svgSource.size());
+}
+
+std::shared_ptr<const CairoRasterCache::Raster> CairoRasterCache::Get(
+    const std::string& svgSource, const std::string& id, int width, int height, const ColorMap& colorMap)
+{
+    return Get(Fingerprint(svgSource), svgSource, id, width, height, colorMap);
+}
+
+std::shared_ptr<const CairoRasterCache::Raster> CairoRasterCache::Get(std::uint64_t fingerprint,
+    const std::string& svgSource, const std::string& id, int width, int height, const ColorMap& colorMap)
+{
+    if (width <= 0 || height <= 0)
+        return nullptr;
+
+    Key key{fingerprint, id, width, height, colorMap};
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+        auto indexIt = mIndex.find(key);
+        if (indexIt != mIndex.end())
+        {
+            ++mStats.hits;
+            mEntries.splice(mEntries.begin(), mEntries, indexIt->second);
+            return indexIt->second->second;
+        }
+        ++mStats.misses;
+    }
+
+    // Concurrent misses of the same key render twice. The first one to
+    // finish is cached, so all callers get equal pixels.
+    std::shared_ptr<const Raster> raster = Rasterize(svgSource, id, width, height, colorMap);
+    if (!raster)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto indexIt = mIndex.find(key);
+    if (indexIt != mIndex.end())
+        return indexIt->second->second;
+    // Rasters larger than the whole budget are not cached.
+    if (raster->pixels.size() > mByteBudget)
+        return raster;
+
+    mEntries.emplace_front(key, raster);
+    mIndex.emplace(std::move(key), mEntries.begin());
+    mStats.bytes += raster->pixels.size();
+    ++mStats.entries;
+    Evict();
+    return raster;
+}
+
+void CairoRasterCache::Evict()
+{
+    while (mStats.bytes > mByteBudget && !mEntries.empty())
+    {
+        mStats.bytes -= mEntries.back().second->pixels.size();
+        --mStats.entries;
+        ++mStats.evictions;
+        mIndex.erase(mEntries.back().first);
+        mEntries.pop_back();
+    }
+}
+
+void CairoRasterCache::SetByteBudget(size_t byteBudget)
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    mByteBudget = byteBudget;
+    Evict();
+}
+
+void CairoRasterCache::Clear()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    mIndex.clear();
+    mEntries.clear();
+    mStats.bytes = 0;
+    mStats.entries = 0;
+}
+
+CairoRasterCache::Stats CairoRasterCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mStats;
+}
+
+} // namespace SVGNative
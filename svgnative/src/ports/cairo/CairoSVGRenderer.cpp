@@ -11,63 +11,81 @@ governing permissions and limitations under the License.
 */
 
 #include "svgnative/ports/cairo/CairoSVGRenderer.h"
-#include "base64.h"
 #include "svgnative/Config.h"
+#include "svgnative/Rect.h"
 #include "cairo.h"
 #include <math.h>
+#include <algorithm>
 #include "CairoImageInfo.h"
+#include "Base64.h"
+#include "ImageLevel.h"
 
 namespace SVGNative
 {
-CairoSVGPath::CairoSVGPath()
-{
-#if CAIRO_HAS_IMAGE_SURFACE
-    cairo_surface_t* sf = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-#elif CAIRO_HAS_RECORDING_SURFACE
-    cairo_surface_t* sf = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
-#endif
-    mPathCtx = cairo_create(sf);
-}
-
-CairoSVGPath::~CairoSVGPath()
+inline double deg2rad(double deg)
 {
-    cairo_surface_t* sf = cairo_get_target(mPathCtx);
-
-    cairo_destroy(mPathCtx);
-    cairo_surface_finish(sf);
-    cairo_surface_destroy(sf);
+    return (deg * M_PI / 180.0);
 }
 
-void CairoSVGPath::Rect(float x, float y, float width, float height)
+void CairoSVGPath::AddHeader(cairo_path_data_type_t type, int length)
 {
-    cairo_rectangle(mPathCtx, x, y, width, height);
-    cairo_close_path(mPathCtx);
+    cairo_path_data_t data;
+    data.header.type = type;
+    data.header.length = length;
+    mData.push_back(data);
 }
 
-inline double deg2rad(double deg)
+void CairoSVGPath::AddPoint(double x, double y)
 {
-    return (deg * M_PI / 180.0);
+    cairo_path_data_t data;
+    data.point.x = x;
+    data.point.y = y;
+    mData.push_back(data);
 }
 
-inline void cairo_arc_rx_ry(cairo_t* cr, float cx, float cy, float rx, float ry, float rad1, float rad2)
+void CairoSVGPath::ArcTo(double cx, double cy, double rx, double ry, double angle1, double angle2)
 {
-    // cairo_scale() with too small rx (or ry) breaks Cairo context.
-    // they are tested and refused by the caller, SVGDocumentImpl::ParseShape().
-
-    if (rx == ry)
+    // Same as cairo_arc() on an axis aligned ellipse: connect to the arc start with a
+    // line if there is a current point, then approximate the arc with one Bezier curve
+    // per quarter circle at most.
+    const double startX = cx + rx * cos(angle1);
+    const double startY = cy + ry * sin(angle1);
+    if (mHasCurrentPoint)
+        AddHeader(CAIRO_PATH_LINE_TO, 2);
+    else
     {
-        // cairo_scale(), cairo_restore() are heavy calculation for some CPUs.
-        // for the cases we can draw without them, draw like this.
-        cairo_arc(cr, cx, cy, rx, rad1, rad2);
+        AddHeader(CAIRO_PATH_MOVE_TO, 2);
+        mSubpathX = static_cast<float>(startX);
+        mSubpathY = static_cast<float>(startY);
+        mHasCurrentPoint = true;
     }
-    else
+    AddPoint(startX, startY);
+
+    const int segments = std::max(1, static_cast<int>(ceil(fabs(angle2 - angle1) / (M_PI / 2) - 1e-6)));
+    const double step = (angle2 - angle1) / segments;
+    const double h = 4.0 / 3.0 * tan(step / 4);
+    double angle = angle1;
+    for (int i = 0; i < segments; ++i, angle += step)
     {
-        cairo_save(cr);
-        cairo_translate(cr, cx, cy);
-        cairo_scale(cr, rx, ry);
-        cairo_arc(cr, 0, 0, 1, rad1, rad2);
-        cairo_restore(cr);
+        const double cos1 = cos(angle), sin1 = sin(angle);
+        const double cos2 = cos(angle + step), sin2 = sin(angle + step);
+        AddHeader(CAIRO_PATH_CURVE_TO, 4);
+        AddPoint(cx + rx * (cos1 - h * sin1), cy + ry * (sin1 + h * cos1));
+        AddPoint(cx + rx * (cos2 + h * sin2), cy + ry * (sin2 - h * cos2));
+        AddPoint(cx + rx * cos2, cy + ry * sin2);
     }
+    mCurrentX = static_cast<float>(cx + rx * cos(angle2));
+    mCurrentY = static_cast<float>(cy + ry * sin(angle2));
+}
+
+void CairoSVGPath::Rect(float x, float y, float width, float height)
+{
+    // Same segments as cairo_rectangle().
+    MoveTo(x, y);
+    LineTo(x + width, y);
+    LineTo(x + width, y + height);
+    LineTo(x, y + height);
+    ClosePath();
 }
 
 void CairoSVGPath::RoundedRect(float x, float y, float width, float height, float rx, float ry)
@@ -75,12 +93,12 @@ void CairoSVGPath::RoundedRect(float x, float y, float width, float height, floa
     // Cairo does not provide single API to draw "rounded rect". See
     // https://www.cairographics.org/samples/rounded_rectangle/
 
-    cairo_new_sub_path(mPathCtx);
-    cairo_arc_rx_ry(mPathCtx, x - rx + width, y + ry,          rx, ry, deg2rad(-90), deg2rad(  0));
-    cairo_arc_rx_ry(mPathCtx, x - rx + width, y - ry + height, rx, ry, deg2rad(  0), deg2rad( 90));
-    cairo_arc_rx_ry(mPathCtx, x + rx,         y - ry + height, rx, ry, deg2rad( 90), deg2rad(180));
-    cairo_arc_rx_ry(mPathCtx, x + rx,         y + ry,          rx, ry, deg2rad(180), deg2rad(270));
-    cairo_close_path(mPathCtx);
+    mHasCurrentPoint = false;
+    ArcTo(x - rx + width, y + ry,          rx, ry, deg2rad(-90), deg2rad(  0));
+    ArcTo(x - rx + width, y - ry + height, rx, ry, deg2rad(  0), deg2rad( 90));
+    ArcTo(x + rx,         y - ry + height, rx, ry, deg2rad( 90), deg2rad(180));
+    ArcTo(x + rx,         y + ry,          rx, ry, deg2rad(180), deg2rad(270));
+    ClosePath();
 }
 
 void CairoSVGPath::Ellipse(float cx, float cy, float rx, float ry)
@@ -88,36 +106,38 @@ void CairoSVGPath::Ellipse(float cx, float cy, float rx, float ry)
     // Cairo does not provide single API to draw "ellipse". See
     // https://cairographics.org/cookbook/ellipses/
 
-    cairo_matrix_t  save_matrix;
-    cairo_get_matrix(mPathCtx, &save_matrix);
-
-    cairo_translate(mPathCtx, cx, cy);
-    cairo_scale(mPathCtx, rx, ry);
-    cairo_new_sub_path(mPathCtx);
-    cairo_arc(mPathCtx, 0, 0, 1, 0, 2 * M_PI);
-
-    cairo_set_matrix(mPathCtx, &save_matrix);
+    mHasCurrentPoint = false;
+    ArcTo(cx, cy, rx, ry, 0, 2 * M_PI);
+    ClosePath();
 }
 
 void CairoSVGPath::MoveTo(float x, float y)
 {
-    cairo_move_to(mPathCtx, x, y);
-    mCurrentX = x;
-    mCurrentY = y;
+    AddHeader(CAIRO_PATH_MOVE_TO, 2);
+    AddPoint(x, y);
+    mCurrentX = mSubpathX = x;
+    mCurrentY = mSubpathY = y;
+    mHasCurrentPoint = true;
 }
 
 void CairoSVGPath::LineTo(float x, float y)
 {
-    cairo_line_to(mPathCtx, x, y);
+    AddHeader(CAIRO_PATH_LINE_TO, 2);
+    AddPoint(x, y);
     mCurrentX = x;
     mCurrentY = y;
+    mHasCurrentPoint = true;
 }
 
 void CairoSVGPath::CurveTo(float x1, float y1, float x2, float y2, float x3, float y3)
 {
-    cairo_curve_to(mPathCtx, x1, y1, x2, y2, x3, y3);
+    AddHeader(CAIRO_PATH_CURVE_TO, 4);
+    AddPoint(x1, y1);
+    AddPoint(x2, y2);
+    AddPoint(x3, y3);
     mCurrentX = x3;
     mCurrentY = y3;
+    mHasCurrentPoint = true;
 }
 
 void CairoSVGPath::CurveToV(float x2, float y2, float x3, float y3)
@@ -127,14 +147,145 @@ void CairoSVGPath::CurveToV(float x2, float y2, float x3, float y3)
     float cx2 = x3 + 2.0f / 3.0f * (x2 - x3);
     float cy2 = y3 + 2.0f / 3.0f * (y2 - y3);
 
-    cairo_curve_to(mPathCtx, cx1, cy1, cx2, cy2, x3, y3);
-    mCurrentX = x3;
-    mCurrentY = y3;
+    CurveTo(cx1, cy1, cx2, cy2, x3, y3);
 }
 
 void CairoSVGPath::ClosePath()
 {
-    cairo_close_path(mPathCtx);
+    AddHeader(CAIRO_PATH_CLOSE_PATH, 1);
+    // Like cairo_close_path(), continue at the start of the closed subpath.
+    mCurrentX = mSubpathX;
+    mCurrentY = mSubpathY;
+}
+
+void CairoSVGPath::Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount)
+{
+    // mData has the layout of cairo_path_t and goes to cairo_append_path()
+    // unchanged. Size it once for all segments with enough points and
+    // write them in place.
+    const float* end = points + 2 * pointCount;
+    const float* p = points;
+    size_t dataCount{};
+    size_t validCount{};
+    for (; validCount < verbCount; ++validCount)
+    {
+        // Coordinates consumed and cairo_path_data_t entries written.
+        ptrdiff_t size{};
+        size_t length{};
+        switch (static_cast<PathVerb>(verbs[validCount]))
+        {
+        case PathVerb::kMove:
+        case PathVerb::kLine:
+            size = 2;
+            length = 2;
+            break;
+        case PathVerb::kCurve:
+            size = 6;
+            length = 4;
+            break;
+        case PathVerb::kQuadCurve:
+            size = 4;
+            length = 4;
+            break;
+        case PathVerb::kClose:
+            length = 1;
+            break;
+        }
+        if (end - p < size)
+            break;
+        p += size;
+        dataCount += length;
+    }
+    if (!dataCount)
+        return;
+
+    const size_t start = mData.size();
+    mData.resize(start + dataCount);
+    cairo_path_data_t* out = mData.data() + start;
+    auto addHeader = [&out](cairo_path_data_type_t type, int length) {
+        out->header.type = type;
+        out->header.length = length;
+        ++out;
+    };
+    auto addPoint = [&out](double x, double y) {
+        out->point.x = x;
+        out->point.y = y;
+        ++out;
+    };
+    p = points;
+    for (size_t i = 0; i < validCount; ++i)
+    {
+        switch (static_cast<PathVerb>(verbs[i]))
+        {
+        case PathVerb::kMove:
+            addHeader(CAIRO_PATH_MOVE_TO, 2);
+            addPoint(p[0], p[1]);
+            mCurrentX = mSubpathX = p[0];
+            mCurrentY = mSubpathY = p[1];
+            mHasCurrentPoint = true;
+            p += 2;
+            break;
+        case PathVerb::kLine:
+            addHeader(CAIRO_PATH_LINE_TO, 2);
+            addPoint(p[0], p[1]);
+            mCurrentX = p[0];
+            mCurrentY = p[1];
+            mHasCurrentPoint = true;
+            p += 2;
+            break;
+        case PathVerb::kCurve:
+            addHeader(CAIRO_PATH_CURVE_TO, 4);
+            addPoint(p[0], p[1]);
+            addPoint(p[2], p[3]);
+            addPoint(p[4], p[5]);
+            mCurrentX = p[4];
+            mCurrentY = p[5];
+            mHasCurrentPoint = true;
+            p += 6;
+            break;
+        case PathVerb::kQuadCurve:
+            // Same conversion to a cubic curve as CurveToV().
+            addHeader(CAIRO_PATH_CURVE_TO, 4);
+            addPoint(mCurrentX + 2.0f / 3.0f * (p[0] - mCurrentX), mCurrentY + 2.0f / 3.0f * (p[1] - mCurrentY));
+            addPoint(p[2] + 2.0f / 3.0f * (p[0] - p[2]), p[3] + 2.0f / 3.0f * (p[1] - p[3]));
+            addPoint(p[2], p[3]);
+            mCurrentX = p[2];
+            mCurrentY = p[3];
+            mHasCurrentPoint = true;
+            p += 4;
+            break;
+        case PathVerb::kClose:
+            addHeader(CAIRO_PATH_CLOSE_PATH, 1);
+            mCurrentX = mSubpathX;
+            mCurrentY = mSubpathY;
+            break;
+        }
+    }
+}
+
+void CairoSVGPath::AppendTo(cairo_t* cr) const
+{
+    if (mData.empty())
+        return;
+    // cairo_append_path() only reads the data.
+    cairo_path_t path{CAIRO_STATUS_SUCCESS, const_cast<cairo_path_data_t*>(mData.data()), static_cast<int>(mData.size())};
+    cairo_append_path(cr, &path);
+}
+
+void CairoSVGPath::AppendTransformedTo(cairo_t* cr, const cairo_matrix_t& matrix) const
+{
+    // A singular transform collapses the path to nothing. Cairo would put
+    // cr in an error state for it.
+    cairo_matrix_t inverse = matrix;
+    if (mData.empty() || cairo_matrix_invert(&inverse) != CAIRO_STATUS_SUCCESS)
+        return;
+    // Cairo converts appended points to device space right away, so the
+    // transform only needs to be in place while appending.
+    cairo_matrix_t ctm;
+    cairo_get_matrix(cr, &ctm);
+    cairo_transform(cr, &matrix);
+    AppendTo(cr);
+    cairo_set_matrix(cr, &ctm);
 }
 
 CairoSVGTransform::CairoSVGTransform(float a, float b, float c, float d, float tx, float ty)
@@ -169,95 +320,146 @@ void CairoSVGTransform::Concat(float a, float b, float c, float d, float tx, flo
 }
 
 CairoSVGImageData::CairoSVGImageData(const std::string& base64, ImageEncoding encoding)
+    : mEncoding{encoding}
 {
-    std::string imageString = base64_decode(base64);
-    const unsigned char* blob_data = (const unsigned char*)malloc(imageString.size());
+    // Decode straight into the buffer that becomes the MIME data of the
+    // surface.
+    unsigned char* blob_data = (unsigned char*)malloc(std::max<size_t>(DecodedBase64Size(base64.size()), 1));
     if (!blob_data)
         throw("no memory\n");
-    memcpy((void *)blob_data, imageString.data(), imageString.size());
+    mEncoded.reset(blob_data, free);
+    if (!DecodeBase64(base64.data(), base64.size(), blob_data, mEncodedSize))
+        throw("image is broken, or not PNG or JPEG\n");
 
     if (encoding == ImageEncoding::kJPEG)
     {
-        mImageData = _cairo_image_surface_create_from_jpeg_stream(blob_data, imageString.size());
-        if (mImageData)
-        {
-            cairo_surface_set_mime_data(mImageData, "image/jpeg", blob_data, imageString.size(), free, (void*)blob_data);
+        // Only read the size. The levels that get drawn are decoded later,
+        // downscaled by the decoder.
+        if (_cairo_jpeg_stream_get_size(blob_data, mEncodedSize, &mWidth, &mHeight) && mWidth > 0 && mHeight > 0)
             return;
-        }
     }
     else if (encoding == ImageEncoding::kPNG)
     {
-        /* this closure is used during the construction of the surface, but no need in later */
-        _png_blob_closure_t png_closure{ blob_data, 0, imageString.size() };
-        mImageData = cairo_image_surface_create_from_png_stream(_png_blob_read_func, &png_closure);
-        if (mImageData)
+        // PNG has no downscaled decoding. Every level depends on level 0.
+        if (cairo_surface_t* surface = Level(0))
         {
-            cairo_surface_set_mime_data(mImageData, "image/png", blob_data, imageString.size(), free, (void*)blob_data);
+            mWidth = cairo_image_surface_get_width(surface);
+            mHeight = cairo_image_surface_get_height(surface);
             return;
         }
     }
-    free((void *)blob_data);
     throw("image is broken, or not PNG or JPEG\n");
 }
 
 CairoSVGImageData::~CairoSVGImageData()
 {
-    cairo_surface_destroy(mImageData);
+    for (auto surface : mLevels)
+    {
+        if (surface)
+            cairo_surface_destroy(surface);
+    }
 }
 
 float CairoSVGImageData::Width() const
 {
-    if (!mImageData)
-        return 0;
-    return static_cast<float>(cairo_image_surface_get_width(mImageData));
+    return static_cast<float>(mWidth);
 }
 
 float CairoSVGImageData::Height() const
 {
-    if (!mImageData)
-        return 0;
-    return static_cast<float>(cairo_image_surface_get_height(mImageData));
+    return static_cast<float>(mHeight);
 }
 
-CairoSVGRenderer::CairoSVGRenderer()
+cairo_surface_t* CairoSVGImageData::Level(int level) const
 {
+    level = std::min(std::max(level, 0), kMaxImageLevel);
+    std::lock_guard<std::mutex> lock{mLevelsMutex};
+    if (mLevels.size() <= static_cast<size_t>(level))
+        mLevels.resize(level + 1);
+    if (!mLevels[level])
+        mLevels[level] = CreateLevel(level);
+    return mLevels[level];
 }
 
-CairoSVGRenderer::~CairoSVGRenderer()
+static void DestroyEncoded(void* data)
 {
+    delete static_cast<std::shared_ptr<unsigned char>*>(data);
 }
 
-inline cairo_path_t* getPathObjFromCairoSvgPath( const Path* path )
+cairo_surface_t* CairoSVGImageData::CreateLevel(int level) const
 {
-    cairo_t* cr = static_cast<const CairoSVGPath*>(path)->mPathCtx;
-    return cairo_copy_path(cr);
+    cairo_surface_t* surface{};
+    // libjpeg scales by 1/2, 1/4 and 1/8 while decoding.
+    if (level <= 3 && mEncoding == ImageEncoding::kJPEG)
+        surface = _cairo_image_surface_create_from_jpeg_stream_scaled(mEncoded.get(), mEncodedSize, 1u << level);
+    else if (level == 0)
+    {
+        /* this closure is used during the construction of the surface, but no need in later */
+        _png_blob_closure_t png_closure{ mEncoded.get(), 0, mEncodedSize };
+        surface = cairo_image_surface_create_from_png_stream(_png_blob_read_func, &png_closure);
+    }
+    else
+    {
+        // Halve the previous level. Decoding a level once and filtering it
+        // down is cheaper than filtering down level 0 every time.
+        cairo_surface_t* source = mLevels[level - 1] ? mLevels[level - 1] : (mLevels[level - 1] = CreateLevel(level - 1));
+        if (!source)
+            return nullptr;
+        const int width = ImageLevelSize(mWidth, level);
+        const int height = ImageLevelSize(mHeight, level);
+        surface = cairo_image_surface_create(cairo_image_surface_get_format(source), width, height);
+        cairo_t* cr = cairo_create(surface);
+        cairo_scale(cr, static_cast<double>(width) / cairo_image_surface_get_width(source),
+            static_cast<double>(height) / cairo_image_surface_get_height(source));
+        cairo_set_source_surface(cr, source, 0, 0);
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+        cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_PAD);
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    }
+    if (surface && cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+    if (surface && level == 0)
+    {
+        // Vector surfaces like PDF embed the encoded image instead of the
+        // pixels.
+        cairo_surface_set_mime_data(surface, mEncoding == ImageEncoding::kJPEG ? "image/jpeg" : "image/png",
+            mEncoded.get(), mEncodedSize, DestroyEncoded, new std::shared_ptr<unsigned char>(mEncoded));
+    }
+    return surface;
 }
 
-inline cairo_path_t* getTransformedClippingPath( const ClippingPath* clippingPath )
+CairoSVGRenderer::CairoSVGRenderer()
+{
+}
+
+CairoSVGRenderer::~CairoSVGRenderer()
 {
-    cairo_path_t* path = getPathObjFromCairoSvgPath(clippingPath->path.get());
-    if (!clippingPath->transform)
-        return path;
+    SetGradientCacheCapacity(0);
+}
 
-    cairo_matrix_t matrix = static_cast<const CairoSVGTransform*>(clippingPath->transform.get())->mMatrix;
-    cairo_path_t* pathTransformed = (cairo_path_t*)malloc(sizeof(cairo_path_t));
-    pathTransformed->num_data = path->num_data;
-    pathTransformed->status = path->status;
-    pathTransformed->data = (cairo_path_data_t*)malloc(path->num_data * sizeof(cairo_path_data_t));
-    for (int i = 0; i < path->num_data; i += path->data[i].header.length)
+void CairoSVGRenderer::SetGradientCacheCapacity(size_t capacity)
+{
+    mPatternCapacity = capacity;
+    while (mPatterns.size() > mPatternCapacity)
     {
-        pathTransformed->data[i].header = path->data[i].header;
-        for (int j = 1; j < path->data[i].header.length; j ++)
-        {
-            double x = path->data[i+j].point.x;
-            double y = path->data[i+j].point.y;
-            cairo_matrix_transform_point(&matrix, &x, &y);
-            pathTransformed->data[i+j].point.x = x;
-            pathTransformed->data[i+j].point.y = y;
-        }
+        cairo_pattern_destroy(mPatterns.back().second);
+        mPatternIndex.erase(mPatterns.back().first);
+        mPatterns.pop_back();
     }
-    cairo_path_destroy(path);
-    return pathTransformed;
+}
+
+inline void appendTransformedClippingPath(cairo_t* cr, const ClippingPath* clippingPath)
+{
+    const auto& path = *static_cast<const CairoSVGPath*>(clippingPath->path.get());
+    if (clippingPath->transform)
+        path.AppendTransformedTo(cr, static_cast<const CairoSVGTransform*>(clippingPath->transform.get())->mMatrix);
+    else
+        path.AppendTo(cr);
 }
 
 inline void setCairoFillAndClipRule(cairo_t* cr, WindingRule rule)
@@ -284,13 +486,20 @@ void CairoSVGRenderer::Save(const GraphicStyle& graphicStyle)
     if (graphicStyle.transform)
         cairo_transform(mCairo, &(static_cast<CairoSVGTransform*>(graphicStyle.transform.get())->mMatrix));
 
-    if (graphicStyle.clippingPath && graphicStyle.clippingPath->path)
+    if (graphicStyle.clippingPath && graphicStyle.clippingPath->isRect)
     {
-        cairo_path_t* path = getTransformedClippingPath( graphicStyle.clippingPath.get() );
-        cairo_append_path(mCairo, path);
+        // Cairo clips to pixel-aligned rectangles without a mask.
+        const auto& clipRect = graphicStyle.clippingPath->clipRect;
+        cairo_new_path(mCairo);
+        cairo_rectangle(mCairo, clipRect.x, clipRect.y, clipRect.width, clipRect.height);
+        cairo_clip(mCairo);
+    }
+    else if (graphicStyle.clippingPath && graphicStyle.clippingPath->path)
+    {
+        cairo_new_path(mCairo);
+        appendTransformedClippingPath(mCairo, graphicStyle.clippingPath.get());
         setCairoFillAndClipRule(mCairo, graphicStyle.clippingPath->clipRule);
         cairo_clip(mCairo);
-        cairo_path_destroy(path);
     }
 }
 
@@ -300,14 +509,9 @@ void CairoSVGRenderer::Restore()
     cairo_restore(mCairo);
 }
 
-inline void createCairoPattern(const Paint& paint, float opacity, cairo_pattern_t** pat)
+inline cairo_pattern_t* createCairoPattern(const Gradient& gradient, float opacity)
 {
-    *pat = NULL;
-
-    if (paint.type() != typeid(Gradient))
-        return;
-
-    const auto& gradient = SVGNative::get<Gradient>(paint);
+    cairo_pattern_t* pat{};
 
     SVG_ASSERT(gradient.type <= GradientType::kRadialGradient);
 
@@ -316,13 +520,13 @@ inline void createCairoPattern(const Paint& paint, float opacity, cairo_pattern_
     switch (gradient.type)
     {
     case GradientType::kLinearGradient:
-        *pat = cairo_pattern_create_linear(gradient.x1, gradient.y1,
-                                           gradient.x2, gradient.y2);
+        pat = cairo_pattern_create_linear(gradient.x1, gradient.y1,
+                                          gradient.x2, gradient.y2);
         break;
 
     case GradientType::kRadialGradient:
-        *pat = cairo_pattern_create_radial(gradient.fx, gradient.fy, 0,
-                                           gradient.cx, gradient.cy, gradient.r);
+        pat = cairo_pattern_create_radial(gradient.fx, gradient.fy, 0,
+                                          gradient.cx, gradient.cy, gradient.r);
         break;
     default:
         throw("unsupported gradient type\n");
@@ -330,7 +534,7 @@ inline void createCairoPattern(const Paint& paint, float opacity, cairo_pattern_
 
     // set transform matrix
     if (gradient.transform)
-        cairo_pattern_set_matrix(*pat, &(static_cast<CairoSVGTransform*>(gradient.transform.get())->mMatrix));
+        cairo_pattern_set_matrix(pat, &(static_cast<CairoSVGTransform*>(gradient.transform.get())->mMatrix));
 
     // set "stop"s of gradient
     for (const auto& stop : gradient.colorStops)
@@ -339,7 +543,7 @@ inline void createCairoPattern(const Paint& paint, float opacity, cairo_pattern_
         const auto& stopOffset = stop.first;
         const auto& stopColor = stop.second;
 
-        cairo_pattern_add_color_stop_rgba(*pat, stopOffset,
+        cairo_pattern_add_color_stop_rgba(pat, stopOffset,
                                           stopColor[0],
                                           stopColor[1],
                                           stopColor[2],
@@ -350,65 +554,93 @@ inline void createCairoPattern(const Paint& paint, float opacity, cairo_pattern_
     switch (gradient.method)
     {
     case SpreadMethod::kReflect:
-        cairo_pattern_set_extend(*pat, CAIRO_EXTEND_REFLECT);
+        cairo_pattern_set_extend(pat, CAIRO_EXTEND_REFLECT);
         break;
     case SpreadMethod::kRepeat:
-        cairo_pattern_set_extend(*pat, CAIRO_EXTEND_REPEAT);
+        cairo_pattern_set_extend(pat, CAIRO_EXTEND_REPEAT);
         break;
     case SpreadMethod::kPad:
-        cairo_pattern_set_extend(*pat, CAIRO_EXTEND_PAD);
+        cairo_pattern_set_extend(pat, CAIRO_EXTEND_PAD);
         break;
     default:
-        cairo_pattern_set_extend(*pat, CAIRO_EXTEND_NONE);
+        cairo_pattern_set_extend(pat, CAIRO_EXTEND_NONE);
         break;
     }
-    return;
+    return pat;
+}
+
+cairo_pattern_t* CairoSVGRenderer::GradientPattern(const Gradient& gradient, float opacity)
+{
+    if (!mPatternCapacity)
+        return createCairoPattern(gradient, opacity);
+
+    mPatternKey.clear();
+    AppendGradientKey(mPatternKey, gradient, opacity);
+    if (gradient.transform)
+    {
+        const auto& matrix = static_cast<CairoSVGTransform*>(gradient.transform.get())->mMatrix;
+        mPatternKey.append(reinterpret_cast<const char*>(&matrix), sizeof(matrix));
+    }
+
+    auto indexIt = mPatternIndex.find(mPatternKey);
+    if (indexIt != mPatternIndex.end())
+    {
+        mPatterns.splice(mPatterns.begin(), mPatterns, indexIt->second);
+        return cairo_pattern_reference(indexIt->second->second);
+    }
+
+    cairo_pattern_t* pat = createCairoPattern(gradient, opacity);
+    mPatterns.emplace_front(mPatternKey, cairo_pattern_reference(pat));
+    mPatternIndex.emplace(mPatternKey, mPatterns.begin());
+    SetGradientCacheCapacity(mPatternCapacity);
+    return pat;
+}
+
+void CairoSVGRenderer::SetSource(const Paint& paint, float opacity)
+{
+    if (SVGNative::holds_alternative<Gradient>(paint))
+    {
+        cairo_pattern_t* pat = GradientPattern(SVGNative::get<Gradient>(paint), opacity);
+        cairo_set_source(mCairo, pat);
+        cairo_pattern_destroy(pat);
+    }
+    else
+    {
+        const auto& color = SVGNative::get<Color>(paint);
+        cairo_set_source_rgba(mCairo, color[0], color[1], color[2], color[3] * opacity);
+    }
 }
 
 inline void appendCairoSvgPath(cairo_t* mCairo, const Path& path)
 {
-    cairo_path_t* cairoPath = getPathObjFromCairoSvgPath(&path);
-    cairo_append_path(mCairo, cairoPath);
-    cairo_path_destroy(cairoPath);
+    static_cast<const CairoSVGPath&>(path).AppendTo(mCairo);
 }
 
 void CairoSVGRenderer::DrawPath(
     const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle)
 {
     SVG_ASSERT(mCairo);
-    Save(graphicStyle);
+    // Opacity goes into the source. Without transform and clipping path
+    // there is no state to push.
+    if (graphicStyle.needsSave)
+        Save(graphicStyle);
 
     if (fillStyle.hasFill)
     {
-        if (SVGNative::holds_alternative<Gradient>(fillStyle.paint))
-        {
-            cairo_pattern_t* pat;
-            createCairoPattern(fillStyle.paint, fillStyle.fillOpacity * graphicStyle.opacity, &pat);
-            cairo_set_source(mCairo, pat);
-        }
-        else
-        {
-            const auto& color = SVGNative::get<Color>(fillStyle.paint);
-            cairo_set_source_rgba(mCairo,
-                                  color[0],
-                                  color[1],
-                                  color[2],
-                                  color[3] * fillStyle.fillOpacity * graphicStyle.opacity);
-        }
+        SetSource(fillStyle.paint, fillStyle.fillOpacity * graphicStyle.opacity);
 
         cairo_new_path(mCairo);
         appendCairoSvgPath(mCairo, path);
         setCairoFillAndClipRule(mCairo, fillStyle.fillRule);
-        cairo_fill(mCairo);
+        // Keep the path for the stroke.
+        if (strokeStyle.hasStroke)
+            cairo_fill_preserve(mCairo);
+        else
+            cairo_fill(mCairo);
     }
     if (strokeStyle.hasStroke)
     {
-        const auto& color = SVGNative::get<Color>(strokeStyle.paint);
-        cairo_set_source_rgba(mCairo,
-                              color[0],
-                              color[1],
-                              color[2],
-                              color[3] * strokeStyle.strokeOpacity * graphicStyle.opacity);
+        SetSource(strokeStyle.paint, strokeStyle.strokeOpacity * graphicStyle.opacity);
 
         cairo_set_line_width(mCairo, strokeStyle.lineWidth);
         cairo_set_miter_limit(mCairo, strokeStyle.miterLimit);
@@ -440,17 +672,25 @@ void CairoSVGRenderer::DrawPath(
 
         if (!strokeStyle.dashArray.empty())
         {
-            std::vector<double> dashes;
-            for (auto dash : strokeStyle.dashArray)
-                 dashes.push_back(dash);
-            cairo_set_dash(mCairo, dashes.data(), strokeStyle.dashArray.size(), strokeStyle.dashOffset);
+            mDashes.assign(strokeStyle.dashArray.begin(), strokeStyle.dashArray.end());
+            cairo_set_dash(mCairo, mDashes.data(), mDashes.size(), strokeStyle.dashOffset);
+        }
+        else
+        {
+            // An earlier draw without a save may have left its dashes in
+            // the state, and cairo_save() copies them.
+            cairo_set_dash(mCairo, nullptr, 0, 0);
         }
 
-        cairo_new_path(mCairo);
-        appendCairoSvgPath(mCairo, path);
+        if (!fillStyle.hasFill)
+        {
+            cairo_new_path(mCairo);
+            appendCairoSvgPath(mCairo, path);
+        }
         cairo_stroke(mCairo);
     }
-    Restore();
+    if (graphicStyle.needsSave)
+        Restore();
 }
 
 void CairoSVGRenderer::DrawImage(
@@ -462,16 +702,85 @@ void CairoSVGRenderer::DrawImage(
     cairo_rectangle(mCairo, clipArea.x, clipArea.y, clipArea.width, clipArea.height);
     cairo_clip(mCairo);
 
-    cairo_surface_t *mImageData = (static_cast<const CairoSVGImageData&>(image)).mImageData;
+    // Raster targets get the smallest level that still has the device
+    // size of the image. Vector and recording surfaces keep level 0 with
+    // the encoded image.
+    int level{};
+    cairo_surface_t* target = cairo_get_group_target(mCairo);
+    if (cairo_surface_get_type(target) == CAIRO_SURFACE_TYPE_IMAGE)
+    {
+        cairo_matrix_t matrix;
+        cairo_get_matrix(mCairo, &matrix);
+        double deviceScaleX{1}, deviceScaleY{1};
+        cairo_surface_get_device_scale(target, &deviceScaleX, &deviceScaleY);
+        level = ImageLevelForDeviceSize(static_cast<int>(image.Width()), static_cast<int>(image.Height()),
+            static_cast<float>(fillArea.width * hypot(matrix.xx, matrix.yx) * deviceScaleX),
+            static_cast<float>(fillArea.height * hypot(matrix.xy, matrix.yy) * deviceScaleY));
+    }
 
-    cairo_translate(mCairo, fillArea.x, fillArea.y);
-    cairo_scale(mCairo, fillArea.width / image.Width(), fillArea.height / image.Height());
-    cairo_set_source_surface(mCairo, mImageData, 0, 0);
-    cairo_paint_with_alpha(mCairo, graphicStyle.opacity);
+    cairo_surface_t* surface = static_cast<const CairoSVGImageData&>(image).Level(level);
+    if (surface)
+    {
+        cairo_translate(mCairo, fillArea.x, fillArea.y);
+        cairo_scale(mCairo, fillArea.width / cairo_image_surface_get_width(surface),
+            fillArea.height / cairo_image_surface_get_height(surface));
+        cairo_set_source_surface(mCairo, surface, 0, 0);
+        cairo_paint_with_alpha(mCairo, graphicStyle.opacity);
+    }
 
     Restore();
 }
 
+CairoSVGRecording::CairoSVGRecording(cairo_surface_t* surface)
+    : mSurface{surface}
+{
+}
+
+CairoSVGRecording::~CairoSVGRecording()
+{
+    cairo_surface_destroy(mSurface);
+}
+
+bool CairoSVGRenderer::BeginRecording(const Rect& /*bounds*/)
+{
+    SVG_ASSERT(mCairo);
+    // Unbounded, the transform of the replay decides what is visible.
+    cairo_surface_t* surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    {
+        cairo_surface_destroy(surface);
+        return false;
+    }
+    mRecordingTargets.push_back(mCairo);
+    mCairo = cairo_create(surface);
+    cairo_surface_destroy(surface);
+    return true;
+}
+
+std::unique_ptr<Recording> CairoSVGRenderer::EndRecording()
+{
+    SVG_ASSERT(!mRecordingTargets.empty());
+    if (mRecordingTargets.empty())
+        return nullptr;
+
+    cairo_surface_t* surface = cairo_surface_reference(cairo_get_target(mCairo));
+    cairo_destroy(mCairo);
+    mCairo = mRecordingTargets.back();
+    mRecordingTargets.pop_back();
+    return std::unique_ptr<Recording>(new CairoSVGRecording(surface));
+}
+
+void CairoSVGRenderer::DrawRecording(const Recording& recording, const Transform& transform)
+{
+    SVG_ASSERT(mCairo);
+    // Recording surfaces replay as vector data at the scale of the pattern.
+    cairo_save(mCairo);
+    cairo_transform(mCairo, &static_cast<const CairoSVGTransform&>(transform).mMatrix);
+    cairo_set_source_surface(mCairo, static_cast<const CairoSVGRecording&>(recording).mSurface, 0, 0);
+    cairo_paint(mCairo);
+    cairo_restore(mCairo);
+}
+
 void CairoSVGRenderer::SetCairo(cairo_t* cr)
 {
     SVG_ASSERT(cr);
@@ -0,0 +1,196 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ports/cairo/CairoTiledRasterizer.h"
+#include "svgnative/ports/cairo/CairoSVGRenderer.h"
+#include "svgnative/SVGDocument.h"
+#include "svgnative/Rect.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SVGNative
+{
+
+namespace
+{
+struct Tile
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// One deque per worker. A worker pops tiles from the back of its own
+// deque and steals from the front of the others when it runs dry.
+class TileQueues
+{
+public:
+    TileQueues(const std::vector<Tile>& tiles, size_t workerCount)
+        : mQueues(workerCount)
+    {
+        // Hand out contiguous runs of tiles so neighbouring tiles, which
+        // mostly touch the same elements, stay on the same worker.
+        const size_t runLength = (tiles.size() + workerCount - 1) / workerCount;
+        for (size_t i = 0; i < tiles.size(); ++i)
+            mQueues[i / runLength].tiles.push_back(tiles[i]);
+    }
+
+    bool Pop(size_t worker, Tile& tile)
+    {
+        {
+            auto& own = mQueues[worker];
+            std::lock_guard<std::mutex> lock{own.mutex};
+            if (!own.tiles.empty())
+            {
+                tile = own.tiles.back();
+                own.tiles.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < mQueues.size(); ++i)
+        {
+            auto& victim = mQueues[(worker + i) % mQueues.size()];
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (!victim.tiles.empty())
+            {
+                tile = victim.tiles.front();
+                victim.tiles.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Tile> tiles;
+    };
+
+    std::vector<Queue> mQueues;
+};
+} // namespace
+
+CairoTiledRasterizer::CairoTiledRasterizer(std::string svgSource, unsigned int threadCount)
+    : mSource{std::move(svgSource)}
+    , mThreadCount{threadCount}
+{
+    if (!mThreadCount)
+        mThreadCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool CairoTiledRasterizer::Render(const ColorMap& colorMap, int width, int height, const TileCallback& callback)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+
+    std::vector<Tile> tiles;
+    for (int y = 0; y < height; y += mTileSize)
+    {
+        for (int x = 0; x < width; x += mTileSize)
+            tiles.push_back({x, y, std::min(mTileSize, width - x), std::min(mTileSize, height - y)});
+    }
+
+    const size_t workerCount = std::min<size_t>(mThreadCount, tiles.size());
+    TileQueues queues{tiles, workerCount};
+    std::mutex callbackMutex;
+    std::atomic<bool> failed{false};
+
+    auto work = [&](size_t worker) {
+        // The XML parser may modify the buffer in place. Every worker
+        // parses its own copy.
+        const std::string source{mSource};
+        auto renderer = std::make_shared<CairoSVGRenderer>();
+        auto doc = std::unique_ptr<SVGDocument>(SVGDocument::CreateSVGDocument(source.c_str(), renderer));
+        if (!doc)
+        {
+            failed = true;
+            return;
+        }
+
+        Tile tile{};
+        while (!failed && queues.Pop(worker, tile))
+        {
+            cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, tile.width, tile.height);
+            if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+            {
+                cairo_surface_destroy(surface);
+                failed = true;
+                return;
+            }
+
+            // The image surface bounds act as the tile clip. Subtrees outside
+            // of the tile are skipped by the document.
+            cairo_t* cr = cairo_create(surface);
+            cairo_translate(cr, -tile.x, -tile.y);
+            renderer->SetCairo(cr);
+            const Rect viewport{static_cast<float>(tile.x), static_cast<float>(tile.y),
+                static_cast<float>(tile.width), static_cast<float>(tile.height)};
+            doc->Render(viewport, colorMap, static_cast<float>(width), static_cast<float>(height));
+            cairo_destroy(cr);
+            cairo_surface_flush(surface);
+
+            {
+                std::lock_guard<std::mutex> lock{callbackMutex};
+                callback(tile.x, tile.y, surface);
+            }
+            cairo_surface_destroy(surface);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workerCount; ++i)
+        threads.emplace_back(work, i);
+    work(0);
+    for (auto& thread : threads)
+        thread.join();
+
+    return !failed;
+}
+
+cairo_surface_t* CairoTiledRasterizer::RenderToSurface(const ColorMap& colorMap, int width, int height)
+{
+    cairo_surface_t* target = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(target) != CAIRO_STATUS_SUCCESS)
+    {
+        cairo_surface_destroy(target);
+        return nullptr;
+    }
+
+    cairo_t* cr = cairo_create(target);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    auto assemble = [cr](int x, int y, cairo_surface_t* tile) {
+        cairo_set_source_surface(cr, tile, x, y);
+        cairo_rectangle(cr, x, y, cairo_image_surface_get_width(tile), cairo_image_surface_get_height(tile));
+        cairo_fill(cr);
+    };
+    const bool success = Render(colorMap, width, height, assemble);
+    cairo_destroy(cr);
+
+    if (!success)
+    {
+        cairo_surface_destroy(target);
+        return nullptr;
+    }
+    cairo_surface_flush(target);
+    return target;
+}
+
+} // namespace SVGNative
@@ -14,7 +14,7 @@ governing permissions and limitations under the License.
 
 #include "svgnative/Rect.h"
 #include "svgnative/ports/cg/CGSVGRenderer.h"
-#include "base64.h"
+#include "Base64.h"
 #include "svgnative/Config.h"
 
 namespace SVGNative
@@ -84,12 +84,23 @@ void CGSVGTransform::Concat(float a, float b, float c, float d, float tx, float
 
 CGSVGImageData::CGSVGImageData(const std::string& base64, ImageEncoding encoding)
 {
-    std::string imageString = base64_decode(base64);
-    auto dataProvider = CGDataProviderCreateWithCFData(CFDataCreate(NULL, (const UInt8*)imageString.data(), imageString.size()));
+    // Decode straight into the buffer of the CFData.
+    CFMutableDataRef data = CFDataCreateMutable(NULL, 0);
+    CFDataSetLength(data, static_cast<CFIndex>(DecodedBase64Size(base64.size())));
+    size_t size{};
+    if (!DecodeBase64(base64.data(), base64.size(), CFDataGetMutableBytePtr(data), size))
+    {
+        CFRelease(data);
+        return;
+    }
+    CFDataSetLength(data, static_cast<CFIndex>(size));
+    auto dataProvider = CGDataProviderCreateWithCFData(data);
     if (encoding == ImageEncoding::kPNG)
         mImage = CGImageCreateWithPNGDataProvider(dataProvider, NULL, true, kCGRenderingIntentDefault);
     else if (encoding == ImageEncoding::kJPEG)
         mImage = CGImageCreateWithJPEGDataProvider(dataProvider, NULL, true, kCGRenderingIntentDefault);
+    CGDataProviderRelease(dataProvider);
+    CFRelease(data);
 }
 
 CGSVGImageData::~CGSVGImageData()
@@ -121,7 +132,12 @@ void CGSVGRenderer::Save(const GraphicStyle& graphicStyle)
     CGContextSaveGState(mContext);
     if (graphicStyle.transform)
         CGContextConcatCTM(mContext, static_cast<CGSVGTransform*>(graphicStyle.transform.get())->mTransform);
-    if (graphicStyle.clippingPath)
+    if (graphicStyle.clippingPath && graphicStyle.clippingPath->isRect)
+    {
+        const auto& clipRect = graphicStyle.clippingPath->clipRect;
+        CGContextClipToRect(mContext, CGRectMake(clipRect.x, clipRect.y, clipRect.width, clipRect.height));
+    }
+    else if (graphicStyle.clippingPath)
     {
         CGContextBeginPath(mContext);
         auto path = static_cast<const CGSVGPath*>(graphicStyle.clippingPath->path.get())->mPath;
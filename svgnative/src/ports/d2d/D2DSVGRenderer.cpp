@@ -17,9 +17,10 @@ governing permissions and limitations under the License.
 #include "svgnative/Config.h"
 #include "svgnative/Rect.h"
 #include "svgnative/ports/d2d/D2DSVGRenderer.h"
-#include "base64.h"
+#include "Base64.h"
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace
 {
@@ -264,8 +265,11 @@ D2DSVGRenderer::D2DSVGRenderer()
 
 std::unique_ptr<ImageData> D2DSVGRenderer::CreateImageData(const std::string& base64, ImageEncoding encoding)
 {
-    std::string imageString = base64_decode(base64);
-    CComPtr<IStream> stream{ SHCreateMemStream((const BYTE*)imageString.c_str(), (UINT)imageString.size()) };
+    std::vector<std::uint8_t> imageData(DecodedBase64Size(base64.size()));
+    size_t size{};
+    if (!DecodeBase64(base64.data(), base64.size(), imageData.data(), size))
+        throw std::runtime_error("Invalid base64");
+    CComPtr<IStream> stream{ SHCreateMemStream(imageData.data(), (UINT)size) };
     ThrowIfNull(stream);
 
     CComPtr<IWICBitmapDecoder> imgDecoder;
@@ -16,7 +16,7 @@ governing permissions and limitations under the License.
 #include "svgnative/Config.h"
 #include "svgnative/Rect.h"
 #include "svgnative/ports/gdiplus/GDIPlusSVGRenderer.h"
-#include "base64.h"
+#include "Base64.h"
 
 namespace SVGNative
 {
@@ -150,18 +150,21 @@ const Gdiplus::Matrix& GDIPlusSVGTransform::GetMatrix() const
 
 GDIPlusSVGImageData::GDIPlusSVGImageData(const std::string& base64, ImageEncoding encoding)
 {
-    std::string imageString = base64_decode(base64);
-    HGLOBAL hImageData = ::GlobalAlloc(GMEM_MOVEABLE, imageString.size());
+    // Decode straight into the global memory of the stream.
+    HGLOBAL hImageData = ::GlobalAlloc(GMEM_MOVEABLE, DecodedBase64Size(base64.size()));
     if (hImageData)
     {
         void* imageData = ::GlobalLock(hImageData);
         if (imageData)
         {
-            std::memcpy(imageData, imageString.c_str(), imageString.size());
-
+            size_t size{};
             IStream* pImageStream{};
-            if (::CreateStreamOnHGlobal(hImageData, FALSE, &pImageStream) == S_OK)
+            if (DecodeBase64(base64.data(), base64.size(), static_cast<std::uint8_t*>(imageData), size)
+                && ::CreateStreamOnHGlobal(hImageData, FALSE, &pImageStream) == S_OK)
             {
+                ULARGE_INTEGER streamSize;
+                streamSize.QuadPart = size;
+                pImageStream->SetSize(streamSize);
                 mImage = std::unique_ptr<Gdiplus::Image>(Gdiplus::Image::FromStream(pImageStream, false));
                 pImageStream->Release();
             }
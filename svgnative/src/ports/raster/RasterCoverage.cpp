@@ -0,0 +1,231 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "RasterCoverage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SVGNative
+{
+
+RasterIntRect RasterIntRect::Intersect(const RasterIntRect& other) const
+{
+    return {std::max(x0, other.x0), std::max(y0, other.y0), std::min(x1, other.x1), std::min(y1, other.y1)};
+}
+
+void RasterCoverage::AddPolyline(const RasterPolyline& polyline)
+{
+    for (const auto& contour : polyline.mContours)
+    {
+        const RasterPoint* points = polyline.mPoints.data() + contour.begin;
+        const size_t n = contour.end - contour.begin;
+        if (n < 2)
+            continue;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto& a = points[i];
+            const auto& b = points[(i + 1) % n];
+            AddEdge(a.x, a.y, b.x, b.y);
+        }
+    }
+}
+
+void RasterCoverage::AddEdge(float x0, float y0, float x1, float y1)
+{
+    // Horizontal edges do not change the winding number.
+    if (y0 == y1 || !std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1))
+        return;
+    mEdges.push_back({x0, y0});
+    mEdges.push_back({x1, y1});
+}
+
+bool RasterCoverage::Rasterize(const RasterIntRect& clip)
+{
+    if (mEdges.empty() || clip.IsEmpty())
+    {
+        mEdges.clear();
+        return false;
+    }
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = minX;
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = maxX;
+    for (const auto& p : mEdges)
+    {
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+    // Coverage spreads to the right of every edge. Edges left of the clip
+    // still count, so only the right side shrinks to the edges.
+    mBounds.x0 = clip.x0;
+    mBounds.x1 = static_cast<int>(std::ceil(std::min(maxX, static_cast<float>(clip.x1))));
+    mBounds.y0 = static_cast<int>(std::floor(std::max(minY, static_cast<float>(clip.y0))));
+    mBounds.y1 = static_cast<int>(std::ceil(std::min(maxY, static_cast<float>(clip.y1))));
+    if (minX > clip.x0)
+        mBounds.x0 = std::min(static_cast<int>(std::floor(minX)), clip.x1);
+    if (mBounds.IsEmpty())
+    {
+        mEdges.clear();
+        return false;
+    }
+
+    // Two extra cells per row take the spill of edges at the right border.
+    mStride = mBounds.x1 - mBounds.x0 + 2;
+    mAccumulation.assign(static_cast<size_t>(mStride) * (mBounds.y1 - mBounds.y0), 0.0f);
+    mCoverage.resize(static_cast<size_t>(mStride));
+
+    const float offsetX = static_cast<float>(mBounds.x0);
+    const float offsetY = static_cast<float>(mBounds.y0);
+    for (size_t i = 0; i < mEdges.size(); i += 2)
+    {
+        const auto& a = mEdges[i];
+        const auto& b = mEdges[i + 1];
+        AccumulateClipped(a.x - offsetX, a.y - offsetY, b.x - offsetX, b.y - offsetY);
+    }
+    mEdges.clear();
+    return true;
+}
+
+void RasterCoverage::AccumulateClipped(float x0, float y0, float x1, float y1)
+{
+    // Parts left of the area collapse onto its left border, where they
+    // still add their winding to the whole row. Parts right of the area
+    // collapse onto the spill cells.
+    const float width = static_cast<float>(mBounds.x1 - mBounds.x0);
+    float ts[4] = {0, 0, 0, 1};
+    int count = 1;
+    for (float border : {0.0f, width})
+    {
+        if ((x0 < border) != (x1 < border))
+            ts[count++] = (border - x0) / (x1 - x0);
+    }
+    if (count == 3 && ts[1] > ts[2])
+        std::swap(ts[1], ts[2]);
+    ts[count] = 1;
+
+    float startX = std::min(std::max(x0, 0.0f), width);
+    float startY = y0;
+    for (int i = 1; i <= count; ++i)
+    {
+        const float t = ts[i];
+        const float x = i == count ? x1 : x0 + (x1 - x0) * t;
+        const float y = i == count ? y1 : y0 + (y1 - y0) * t;
+        const float endX = std::min(std::max(x, 0.0f), width);
+        Accumulate(startX, startY, endX, y);
+        startX = endX;
+        startY = y;
+    }
+}
+
+void RasterCoverage::Accumulate(float x0, float y0, float x1, float y1)
+{
+    if (y0 == y1)
+        return;
+    float direction = 1;
+    if (y0 > y1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        direction = -1;
+    }
+    const int height = mBounds.y1 - mBounds.y0;
+    const float width = static_cast<float>(mBounds.x1 - mBounds.x0);
+    if (y1 <= 0 || y0 >= height)
+        return;
+
+    const float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0;
+    if (y0 < 0)
+    {
+        x -= y0 * dxdy;
+        y0 = 0;
+    }
+    const int rowEnd = std::min(height, static_cast<int>(std::ceil(y1)));
+    for (int y = static_cast<int>(y0); y < rowEnd; ++y)
+    {
+        float* row = mAccumulation.data() + static_cast<size_t>(y) * mStride;
+        const float dy = std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0);
+        const float xNext = x + dxdy * dy;
+        const float d = dy * direction;
+        // Rounding may move the edge out of [0, width] by a tiny bit.
+        const float left = std::max(std::min(x, xNext), 0.0f);
+        const float right = std::min(std::max(x, xNext), width);
+        const float leftFloor = std::floor(left);
+        const int leftCell = static_cast<int>(leftFloor);
+        const float rightCeil = std::ceil(right);
+        const int rightCell = static_cast<int>(rightCeil);
+        if (rightCell <= leftCell + 1)
+        {
+            // The edge stays within one cell. The part of the cell right of
+            // the edge's mid point is covered.
+            const float mid = 0.5f * (left + right) - leftFloor;
+            row[leftCell] += d - d * mid;
+            row[leftCell + 1] += d * mid;
+        }
+        else
+        {
+            const float inverseWidth = 1 / (right - left);
+            const float leftFraction = left - leftFloor;
+            const float firstArea = 0.5f * inverseWidth * (1 - leftFraction) * (1 - leftFraction);
+            const float rightFraction = right - rightCeil + 1;
+            const float lastArea = 0.5f * inverseWidth * rightFraction * rightFraction;
+            row[leftCell] += d * firstArea;
+            if (rightCell == leftCell + 2)
+                row[leftCell + 1] += d * (1 - firstArea - lastArea);
+            else
+            {
+                const float secondArea = inverseWidth * (1.5f - leftFraction);
+                row[leftCell + 1] += d * (secondArea - firstArea);
+                for (int cell = leftCell + 2; cell < rightCell - 1; ++cell)
+                    row[cell] += d * inverseWidth;
+                const float beforeLast = secondArea + (rightCell - leftCell - 3) * inverseWidth;
+                row[rightCell - 1] += d * (1 - beforeLast - lastArea);
+            }
+            row[rightCell] += d * lastArea;
+        }
+        x = xNext;
+    }
+}
+
+std::uint8_t* RasterCoverage::Row(int y, WindingRule rule)
+{
+    const float* row = mAccumulation.data() + static_cast<size_t>(y - mBounds.y0) * mStride;
+    const int width = mBounds.x1 - mBounds.x0;
+    float winding{};
+    if (rule == WindingRule::kEvenOdd)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            winding += row[x];
+            float alpha = std::fmod(std::fabs(winding), 2.0f);
+            if (alpha > 1)
+                alpha = 2 - alpha;
+            mCoverage[x] = static_cast<std::uint8_t>(alpha * 255 + 0.5f);
+        }
+    }
+    else
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            winding += row[x];
+            mCoverage[x] = static_cast<std::uint8_t>(std::min(std::fabs(winding), 1.0f) * 255 + 0.5f);
+        }
+    }
+    return mCoverage.data();
+}
+
+} // namespace SVGNative
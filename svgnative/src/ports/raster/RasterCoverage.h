@@ -0,0 +1,83 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_RasterCoverage_h
+#define SVGViewer_RasterCoverage_h
+
+#include "RasterGeometry.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace SVGNative
+{
+
+/**
+ * Pixel rectangle [x0, x1) x [y0, y1).
+ */
+struct RasterIntRect
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    bool IsEmpty() const { return x0 >= x1 || y0 >= y1; }
+    RasterIntRect Intersect(const RasterIntRect& other) const;
+};
+
+/**
+ * Anti-aliased scanline rasterizer. Every edge adds its exact signed area
+ * to the cells it crosses. A running sum over a row yields the winding
+ * number weighted by pixel coverage, which the fill rule maps to alpha.
+ */
+class RasterCoverage
+{
+public:
+    /**
+     * Adds the edges of all contours in device space. Contours get closed
+     * implicitly.
+     */
+    void AddPolyline(const RasterPolyline& polyline);
+
+    /**
+     * Accumulates all added edges inside clip and removes them.
+     * @return false if no edge touches clip. Row() must not be called then.
+     */
+    bool Rasterize(const RasterIntRect& clip);
+
+    /**
+     * Area covered by the last Rasterize() call.
+     */
+    const RasterIntRect& Bounds() const { return mBounds; }
+
+    /**
+     * Coverage of row y of Bounds() from Bounds().x0 to Bounds().x1.
+     * The span may be modified. It is valid until the next call.
+     */
+    std::uint8_t* Row(int y, WindingRule rule);
+
+private:
+    void AddEdge(float x0, float y0, float x1, float y1);
+    void AccumulateClipped(float x0, float y0, float x1, float y1);
+    void Accumulate(float x0, float y0, float x1, float y1);
+
+    std::vector<RasterPoint> mEdges;
+    RasterIntRect mBounds{};
+    int mStride{};
+    std::vector<float> mAccumulation;
+    std::vector<std::uint8_t> mCoverage;
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_RasterCoverage_h
@@ -0,0 +1,389 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "RasterGeometry.h"
+#include "svgnative/ports/raster/RasterSVGRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SVGNative
+{
+
+namespace
+{
+constexpr float kPi{3.14159265358979f};
+// Subdivision limit for a single curve. Bounds the work for huge curves
+// under extreme zoom.
+constexpr int kMaxCurveSegments{512};
+
+float Length(float x, float y)
+{
+    return std::sqrt(x * x + y * y);
+}
+
+// Adds a closed polygon with positive orientation. Drops polygons without
+// area.
+void AddPolygon(RasterPolyline& outline, const RasterPoint* points, size_t count)
+{
+    float area{};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& p = points[i];
+        const auto& q = points[(i + 1) % count];
+        area += p.x * q.y - q.x * p.y;
+    }
+    if (area == 0 || !std::isfinite(area))
+        return;
+    if (area > 0)
+    {
+        outline.MoveTo(points[0].x, points[0].y);
+        for (size_t i = 1; i < count; ++i)
+            outline.LineTo(points[i].x, points[i].y);
+    }
+    else
+    {
+        outline.MoveTo(points[count - 1].x, points[count - 1].y);
+        for (size_t i = count - 1; i-- > 0;)
+            outline.LineTo(points[i].x, points[i].y);
+    }
+    outline.Close();
+}
+
+void AddCircle(RasterPolyline& outline, RasterPoint center, float radius, float tolerance)
+{
+    int segments = 8;
+    if (tolerance < radius)
+        segments = std::max(segments, static_cast<int>(std::ceil(kPi / std::acos(1 - tolerance / radius))));
+    segments = std::min(segments, kMaxCurveSegments);
+    outline.MoveTo(center.x + radius, center.y);
+    for (int i = 1; i < segments; ++i)
+    {
+        const float angle = 2 * kPi * i / segments;
+        outline.LineTo(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle));
+    }
+    outline.Close();
+}
+
+void AddSegment(RasterPolyline& outline, RasterPoint a, RasterPoint b, float halfWidth)
+{
+    const float length = Length(b.x - a.x, b.y - a.y);
+    const float nx = -(b.y - a.y) / length * halfWidth;
+    const float ny = (b.x - a.x) / length * halfWidth;
+    const RasterPoint quad[] = {{a.x + nx, a.y + ny}, {b.x + nx, b.y + ny}, {b.x - nx, b.y - ny}, {a.x - nx, a.y - ny}};
+    AddPolygon(outline, quad, 4);
+}
+
+void AddJoin(RasterPolyline& outline, RasterPoint p, RasterPoint d0, RasterPoint d1, const RasterStrokeParams& params)
+{
+    const float cross = d0.x * d1.y - d0.y * d1.x;
+    const float dot = d0.x * d1.x + d0.y * d1.y;
+    if (std::fabs(cross) < 1e-6f && dot > 0)
+        return;
+    if (params.join == LineJoin::kRound)
+    {
+        AddCircle(outline, p, params.halfWidth, params.tolerance);
+        return;
+    }
+
+    // The join fills the gap on the outer side of the turn.
+    const float side = cross > 0 ? -params.halfWidth : params.halfWidth;
+    const RasterPoint n0{-d0.y * side, d0.x * side};
+    const RasterPoint n1{-d1.y * side, d1.x * side};
+    const RasterPoint a{p.x + n0.x, p.y + n0.y};
+    const RasterPoint b{p.x + n1.x, p.y + n1.y};
+    if (params.join == LineJoin::kMiter)
+    {
+        // Miter length over stroke width is 1 / cos(turn angle / 2).
+        const float cosHalfTurn = std::sqrt(std::max(0.0f, (1 + dot) / 2));
+        if (cosHalfTurn > 0 && 1 / cosHalfTurn <= params.miterLimit)
+        {
+            const float bisectorLength = Length(n0.x + n1.x, n0.y + n1.y);
+            const float scale = params.halfWidth / cosHalfTurn / bisectorLength;
+            const RasterPoint miter[] = {p, a, {p.x + (n0.x + n1.x) * scale, p.y + (n0.y + n1.y) * scale}, b};
+            AddPolygon(outline, miter, 4);
+            return;
+        }
+    }
+    const RasterPoint bevel[] = {p, a, b};
+    AddPolygon(outline, bevel, 3);
+}
+
+RasterPoint Direction(RasterPoint from, RasterPoint to)
+{
+    const float length = Length(to.x - from.x, to.y - from.y);
+    return {(to.x - from.x) / length, (to.y - from.y) / length};
+}
+
+void StrokeContour(const RasterPoint* input, size_t count, bool closed, const RasterStrokeParams& params,
+    std::vector<RasterPoint>& points, RasterPolyline& outline)
+{
+    points.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (points.empty() || std::fabs(input[i].x - points.back().x) > 1e-6f || std::fabs(input[i].y - points.back().y) > 1e-6f)
+            points.push_back(input[i]);
+    }
+    if (closed && points.size() > 2 && std::fabs(points.front().x - points.back().x) <= 1e-6f
+        && std::fabs(points.front().y - points.back().y) <= 1e-6f)
+        points.pop_back();
+    if (points.empty())
+        return;
+
+    const float halfWidth = params.halfWidth;
+    if (points.size() == 1)
+    {
+        // Zero length subpaths only show their caps.
+        if (closed)
+            return;
+        const auto p = points[0];
+        if (params.cap == LineCap::kRound)
+            AddCircle(outline, p, halfWidth, params.tolerance);
+        else if (params.cap == LineCap::kSquare)
+        {
+            const RasterPoint square[] = {{p.x - halfWidth, p.y - halfWidth}, {p.x + halfWidth, p.y - halfWidth},
+                {p.x + halfWidth, p.y + halfWidth}, {p.x - halfWidth, p.y + halfWidth}};
+            AddPolygon(outline, square, 4);
+        }
+        return;
+    }
+
+    const size_t n = points.size();
+    const size_t segments = closed ? n : n - 1;
+    for (size_t s = 0; s < segments; ++s)
+    {
+        auto a = points[s];
+        auto b = points[(s + 1) % n];
+        if (!closed && params.cap == LineCap::kSquare)
+        {
+            const auto d = Direction(a, b);
+            if (s == 0)
+                a = {a.x - d.x * halfWidth, a.y - d.y * halfWidth};
+            if (s == segments - 1)
+                b = {b.x + d.x * halfWidth, b.y + d.y * halfWidth};
+        }
+        AddSegment(outline, a, b, halfWidth);
+    }
+
+    const size_t firstJoin = closed ? 0 : 1;
+    const size_t lastJoin = closed ? n : n - 1;
+    for (size_t v = firstJoin; v < lastJoin; ++v)
+    {
+        const auto& previous = points[(v + n - 1) % n];
+        const auto& current = points[v];
+        const auto& next = points[(v + 1) % n];
+        AddJoin(outline, current, Direction(previous, current), Direction(current, next), params);
+    }
+
+    if (!closed && params.cap == LineCap::kRound)
+    {
+        AddCircle(outline, points.front(), halfWidth, params.tolerance);
+        AddCircle(outline, points.back(), halfWidth, params.tolerance);
+    }
+}
+
+// Splits polyline into the "on" intervals of the dash pattern. Every
+// subpath restarts the pattern.
+bool DashPolyline(const RasterPolyline& polyline, const std::vector<float>& dashes, float dashOffset, RasterPolyline& dashed)
+{
+    float total{};
+    for (float dash : dashes)
+    {
+        if (dash < 0 || !std::isfinite(dash))
+            return false;
+        total += dash;
+    }
+    if (total <= 0)
+        return false;
+    // An odd number of values gets repeated to yield an even number.
+    const size_t count = dashes.size() % 2 ? 2 * dashes.size() : dashes.size();
+    if (dashes.size() % 2)
+        total *= 2;
+
+    dashed.Clear();
+    for (const auto& contour : polyline.mContours)
+    {
+        float phase = std::fmod(dashOffset, total);
+        if (phase < 0)
+            phase += total;
+        size_t index = 0;
+        bool on = true;
+        while (phase >= dashes[index % dashes.size()])
+        {
+            phase -= dashes[index % dashes.size()];
+            index = (index + 1) % count;
+            on = !on;
+        }
+        float remaining = dashes[index % dashes.size()] - phase;
+
+        const RasterPoint* points = polyline.mPoints.data() + contour.begin;
+        const size_t n = contour.end - contour.begin;
+        if (on)
+            dashed.MoveTo(points[0].x, points[0].y);
+        const size_t segments = contour.closed ? n : n - 1;
+        for (size_t s = 0; s < segments; ++s)
+        {
+            const auto& a = points[s];
+            const auto& b = points[(s + 1) % n];
+            const float length = Length(b.x - a.x, b.y - a.y);
+            float position{};
+            while (length - position > remaining)
+            {
+                position += remaining;
+                const float t = position / length;
+                const float x = a.x + (b.x - a.x) * t;
+                const float y = a.y + (b.y - a.y) * t;
+                if (on)
+                    dashed.LineTo(x, y);
+                else
+                    dashed.MoveTo(x, y);
+                on = !on;
+                index = (index + 1) % count;
+                remaining = dashes[index % dashes.size()];
+            }
+            remaining -= length - position;
+            if (on)
+                dashed.LineTo(b.x, b.y);
+        }
+    }
+    return true;
+}
+
+void FlattenCubic(RasterPolyline& polyline, RasterPoint p0, RasterPoint p1, RasterPoint p2, RasterPoint p3, float tolerance)
+{
+    // The distance between a cubic and its chords with n uniform steps is at
+    // most 3/4 * max|second difference| / n^2.
+    const float dd = std::max(Length(p0.x - 2 * p1.x + p2.x, p0.y - 2 * p1.y + p2.y), Length(p1.x - 2 * p2.x + p3.x, p1.y - 2 * p2.y + p3.y));
+    int segments = static_cast<int>(std::ceil(std::sqrt(0.75f * dd / tolerance)));
+    if (!(segments >= 1))
+        segments = 1;
+    segments = std::min(segments, kMaxCurveSegments);
+    for (int i = 1; i < segments; ++i)
+    {
+        const float t = static_cast<float>(i) / segments;
+        const float mt = 1 - t;
+        const float w0 = mt * mt * mt;
+        const float w1 = 3 * mt * mt * t;
+        const float w2 = 3 * mt * t * t;
+        const float w3 = t * t * t;
+        polyline.LineTo(w0 * p0.x + w1 * p1.x + w2 * p2.x + w3 * p3.x, w0 * p0.y + w1 * p1.y + w2 * p2.y + w3 * p3.y);
+    }
+    polyline.LineTo(p3.x, p3.y);
+}
+} // namespace
+
+void RasterPolyline::Clear()
+{
+    mPoints.clear();
+    mContours.clear();
+}
+
+void RasterPolyline::MoveTo(float x, float y)
+{
+    mContours.push_back({mPoints.size(), mPoints.size() + 1, false});
+    mPoints.push_back({x, y});
+}
+
+void RasterPolyline::LineTo(float x, float y)
+{
+    if (mContours.empty() || mContours.back().closed)
+    {
+        MoveTo(x, y);
+        return;
+    }
+    mPoints.push_back({x, y});
+    ++mContours.back().end;
+}
+
+void RasterPolyline::Close()
+{
+    if (!mContours.empty())
+        mContours.back().closed = true;
+}
+
+void RasterPolyline::Transform(const Matrix& matrix)
+{
+    for (auto& point : mPoints)
+        matrix.MapPoint(point.x, point.y);
+}
+
+void FlattenPath(const RasterSVGPath& path, const Matrix& matrix, float tolerance, RasterPolyline& polyline)
+{
+    polyline.Clear();
+    const float* points = path.mPoints.data();
+    RasterPoint current{}, start{};
+    bool open{};
+    auto next = [&points, &matrix]() {
+        RasterPoint p{points[0], points[1]};
+        points += 2;
+        matrix.MapPoint(p.x, p.y);
+        return p;
+    };
+    for (auto verb : path.mVerbs)
+    {
+        switch (verb)
+        {
+        case RasterVerb::kMoveTo:
+            current = start = next();
+            polyline.MoveTo(current.x, current.y);
+            open = true;
+            break;
+        case RasterVerb::kLineTo:
+            if (!open)
+            {
+                polyline.MoveTo(current.x, current.y);
+                open = true;
+            }
+            current = next();
+            polyline.LineTo(current.x, current.y);
+            break;
+        case RasterVerb::kCurveTo:
+        {
+            if (!open)
+            {
+                polyline.MoveTo(current.x, current.y);
+                open = true;
+            }
+            const auto p1 = next();
+            const auto p2 = next();
+            const auto p3 = next();
+            FlattenCubic(polyline, current, p1, p2, p3, tolerance);
+            current = p3;
+            break;
+        }
+        case RasterVerb::kClose:
+            if (open)
+                polyline.Close();
+            open = false;
+            current = start;
+            break;
+        }
+    }
+}
+
+void StrokePolyline(const RasterPolyline& polyline, const RasterStrokeParams& params, RasterPolyline& outline)
+{
+    outline.Clear();
+    if (!(params.halfWidth > 0))
+        return;
+
+    RasterPolyline dashed;
+    const RasterPolyline* source = &polyline;
+    if (params.dashes && !params.dashes->empty() && DashPolyline(polyline, *params.dashes, params.dashOffset, dashed))
+        source = &dashed;
+
+    std::vector<RasterPoint> points;
+    for (const auto& contour : source->mContours)
+        StrokeContour(source->mPoints.data() + contour.begin, contour.end - contour.begin, contour.closed, params, points, outline);
+}
+
+} // namespace SVGNative
@@ -0,0 +1,81 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_RasterGeometry_h
+#define SVGViewer_RasterGeometry_h
+
+#include "svgnative/SVGRenderer.h"
+#include "Matrix.h"
+
+#include <vector>
+
+namespace SVGNative
+{
+class RasterSVGPath;
+
+struct RasterPoint
+{
+    float x;
+    float y;
+};
+
+/**
+ * Flattened path. Every contour is a run of points in mPoints.
+ */
+class RasterPolyline
+{
+public:
+    struct Contour
+    {
+        size_t begin;
+        size_t end;
+        bool closed;
+    };
+
+    void Clear();
+    void MoveTo(float x, float y);
+    void LineTo(float x, float y);
+    void Close();
+    void Transform(const Matrix& matrix);
+
+    std::vector<RasterPoint> mPoints;
+    std::vector<Contour> mContours;
+};
+
+struct RasterStrokeParams
+{
+    float halfWidth;
+    LineCap cap;
+    LineJoin join;
+    float miterLimit;
+    const std::vector<float>* dashes;
+    float dashOffset;
+    // Maximal distance between the exact outline and the polygons.
+    float tolerance;
+};
+
+/**
+ * Flattens path transformed by matrix into polyline. Curves get split until
+ * no point deviates more than tolerance from the curve.
+ */
+void FlattenPath(const RasterSVGPath& path, const Matrix& matrix, float tolerance, RasterPolyline& polyline);
+
+/**
+ * Creates the stroke outline of polyline as closed polygons with positive
+ * orientation. The union of the polygons under the non-zero rule is the
+ * stroke. Overlapping polygons keep the stroker free of intersection tests.
+ */
+void StrokePolyline(const RasterPolyline& polyline, const RasterStrokeParams& params, RasterPolyline& outline);
+
+} // namespace SVGNative
+
+#endif // SVGViewer_RasterGeometry_h
@@ -0,0 +1,827 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ports/raster/RasterSVGRenderer.h"
+#include "svgnative/Config.h"
+#include "svgnative/Rect.h"
+#include "Base64.h"
+#include "Bounds.h"
+#include "Matrix.h"
+#include "RasterCoverage.h"
+#include "RasterGeometry.h"
+#include "RasterSpans.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SVGNative
+{
+
+namespace
+{
+constexpr float kPi{3.14159265358979f};
+// Maximal deviation of flattened curves from the exact curves, in pixels.
+constexpr float kTolerance{0.2f};
+// Rectangle edges closer than this to a pixel boundary count as aligned.
+// Their coverage rounds to 0 or 255.
+constexpr float kPixelAlignment{1.0f / 512};
+
+Matrix ToMatrix(const Transform& transform)
+{
+    const auto& t = static_cast<const RasterSVGTransform&>(transform);
+    return Matrix{t.a, t.b, t.c, t.d, t.e, t.f};
+}
+
+// Largest length a unit vector can get under matrix.
+float MaxScale(const Matrix& m)
+{
+    return std::sqrt(std::max(m.a * m.a + m.b * m.b, m.c * m.c + m.d * m.d));
+}
+
+std::uint8_t ToByte(float value)
+{
+    return static_cast<std::uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255 + 0.5f);
+}
+
+void PremultipliedColor(const Color& color, float opacity, std::uint8_t out[4])
+{
+    const float alpha = std::min(std::max(color[3] * opacity, 0.0f), 1.0f);
+    out[0] = ToByte(color[0] * alpha);
+    out[1] = ToByte(color[1] * alpha);
+    out[2] = ToByte(color[2] * alpha);
+    out[3] = ToByte(alpha);
+}
+
+/**
+ * Gradient colors for one draw. Colors get interpolated unpremultiplied
+ * into a table of 256 premultiplied entries.
+ */
+class GradientShader
+{
+public:
+    bool Init(const Gradient& gradient, const Matrix& matrix, float opacity)
+    {
+        if (gradient.colorStops.empty())
+            return false;
+
+        Matrix gradientMatrix{matrix};
+        if (gradient.transform)
+            gradientMatrix.Concat(ToMatrix(*gradient.transform));
+        if (!gradientMatrix.Invert(mInverse))
+            return false;
+
+        const auto& stops = gradient.colorStops;
+        for (int i = 0; i < 256; ++i)
+        {
+            const float t = i / 255.0f;
+            size_t next = 0;
+            while (next < stops.size() && stops[next].first < t)
+                ++next;
+            Color color;
+            if (next == 0)
+                color = stops.front().second;
+            else if (next == stops.size())
+                color = stops.back().second;
+            else
+            {
+                const auto& a = stops[next - 1];
+                const auto& b = stops[next];
+                const float span = b.first - a.first;
+                const float weight = span > 0 ? (t - a.first) / span : 1;
+                for (int c = 0; c < 4; ++c)
+                    color[c] = a.second[c] + (b.second[c] - a.second[c]) * weight;
+            }
+            PremultipliedColor(color, opacity, mColors + 4 * i);
+        }
+
+        mType = gradient.type;
+        mMethod = gradient.method;
+        mDegenerate = false;
+        if (mType == GradientType::kLinearGradient)
+        {
+            mX = gradient.x1;
+            mY = gradient.y1;
+            mDX = gradient.x2 - gradient.x1;
+            mDY = gradient.y2 - gradient.y1;
+            const float lengthSquared = mDX * mDX + mDY * mDY;
+            mDegenerate = !(lengthSquared > 0);
+            if (!mDegenerate)
+            {
+                mDX /= lengthSquared;
+                mDY /= lengthSquared;
+            }
+        }
+        else
+        {
+            mR = gradient.r;
+            mDegenerate = !(mR > 0);
+            // Like SVG 1.1, move a focal point outside of the circle onto
+            // the circle.
+            float fx = gradient.fx - gradient.cx;
+            float fy = gradient.fy - gradient.cy;
+            const float distance = std::sqrt(fx * fx + fy * fy);
+            if (distance > mR * 0.99f)
+            {
+                fx *= mR * 0.99f / distance;
+                fy *= mR * 0.99f / distance;
+            }
+            mX = gradient.cx + fx;
+            mY = gradient.cy + fy;
+            mDX = -fx;
+            mDY = -fy;
+            mA = mDX * mDX + mDY * mDY - mR * mR;
+        }
+        return true;
+    }
+
+    void Shade(int x, int y, int count, std::uint8_t* out) const
+    {
+        if (mDegenerate)
+        {
+            // SVG paints degenerate gradients with the last stop.
+            for (int i = 0; i < count; ++i)
+                std::memcpy(out + 4 * i, mColors + 4 * 255, 4);
+            return;
+        }
+        float px = x + 0.5f;
+        float py = y + 0.5f;
+        mInverse.MapPoint(px, py);
+        for (int i = 0; i < count; ++i, px += mInverse.a, py += mInverse.b)
+        {
+            const float dx = px - mX;
+            const float dy = py - mY;
+            float t;
+            if (mType == GradientType::kLinearGradient)
+                t = dx * mDX + dy * mDY;
+            else
+            {
+                // Circles grow from radius 0 at the focal point to r at the
+                // center. Take the circle through the point with t >= 0.
+                const float b = dx * mDX + dy * mDY;
+                const float c = dx * dx + dy * dy;
+                t = (b - std::sqrt(std::max(0.0f, b * b - mA * c))) / mA;
+            }
+            std::memcpy(out + 4 * i, mColors + 4 * Index(t), 4);
+        }
+    }
+
+private:
+    int Index(float t) const
+    {
+        if (!std::isfinite(t))
+            t = 0;
+        switch (mMethod)
+        {
+        case SpreadMethod::kRepeat:
+            t -= std::floor(t);
+            break;
+        case SpreadMethod::kReflect:
+            t = std::fmod(std::fabs(t), 2.0f);
+            if (t > 1)
+                t = 2 - t;
+            break;
+        case SpreadMethod::kPad:
+        default:
+            break;
+        }
+        return static_cast<int>(std::min(std::max(t, 0.0f), 1.0f) * 255 + 0.5f);
+    }
+
+    Matrix mInverse;
+    GradientType mType{};
+    SpreadMethod mMethod{};
+    bool mDegenerate{};
+    float mX{};
+    float mY{};
+    float mDX{};
+    float mDY{};
+    float mR{};
+    float mA{};
+    std::uint8_t mColors[4 * 256];
+};
+
+/**
+ * Bilinear sampling of an image, edges clamped.
+ */
+class ImageShader
+{
+public:
+    bool Init(const RasterSVGImageData& image, const Matrix& imageMatrix, float opacity)
+    {
+        mImage = &image;
+        mOpacity = static_cast<std::uint32_t>(ToByte(opacity));
+        return imageMatrix.Invert(mInverse);
+    }
+
+    void Shade(int x, int y, int count, std::uint8_t* out) const
+    {
+        const int width = mImage->mWidth;
+        const int height = mImage->mHeight;
+        const std::uint8_t* pixels = mImage->mPixels.data();
+        float u = x + 0.5f;
+        float v = y + 0.5f;
+        mInverse.MapPoint(u, v);
+        for (int i = 0; i < count; ++i, u += mInverse.a, v += mInverse.b)
+        {
+            const float su = std::min(std::max(u - 0.5f, 0.0f), width - 1.0f);
+            const float sv = std::min(std::max(v - 0.5f, 0.0f), height - 1.0f);
+            const int x0 = static_cast<int>(su);
+            const int y0 = static_cast<int>(sv);
+            const int x1 = std::min(x0 + 1, width - 1);
+            const int y1 = std::min(y0 + 1, height - 1);
+            const std::uint32_t fx = static_cast<std::uint32_t>((su - x0) * 256);
+            const std::uint32_t fy = static_cast<std::uint32_t>((sv - y0) * 256);
+            const std::uint8_t* p00 = pixels + 4 * (static_cast<size_t>(y0) * width + x0);
+            const std::uint8_t* p01 = pixels + 4 * (static_cast<size_t>(y0) * width + x1);
+            const std::uint8_t* p10 = pixels + 4 * (static_cast<size_t>(y1) * width + x0);
+            const std::uint8_t* p11 = pixels + 4 * (static_cast<size_t>(y1) * width + x1);
+            for (int c = 0; c < 4; ++c)
+            {
+                const std::uint32_t top = p00[c] * (256 - fx) + p01[c] * fx;
+                const std::uint32_t bottom = p10[c] * (256 - fx) + p11[c] * fx;
+                const std::uint32_t value = (top * (256 - fy) + bottom * fy) >> 16;
+                out[4 * i + c] = static_cast<std::uint8_t>((value * mOpacity + 127) / 255);
+            }
+        }
+    }
+
+private:
+    const RasterSVGImageData* mImage{};
+    Matrix mInverse;
+    std::uint32_t mOpacity{255};
+};
+} // namespace
+
+void RasterSVGPath::AddPoint(float x, float y)
+{
+    mPoints.push_back(x);
+    mPoints.push_back(y);
+    mHasExtents = false;
+}
+
+void RasterSVGPath::ArcTo(float cx, float cy, float rx, float ry, float angle1, float angle2, bool connect)
+{
+    // Same approximation as the Cairo port: one cubic per quarter circle.
+    const float startX = cx + rx * std::cos(angle1);
+    const float startY = cy + ry * std::sin(angle1);
+    if (connect)
+        LineTo(startX, startY);
+    else
+        MoveTo(startX, startY);
+
+    const int segments = std::max(1, static_cast<int>(std::ceil(std::fabs(angle2 - angle1) / (kPi / 2) - 1e-6f)));
+    const float step = (angle2 - angle1) / segments;
+    const float h = 4.0f / 3.0f * std::tan(step / 4);
+    float angle = angle1;
+    for (int i = 0; i < segments; ++i, angle += step)
+    {
+        const float cos1 = std::cos(angle), sin1 = std::sin(angle);
+        const float cos2 = std::cos(angle + step), sin2 = std::sin(angle + step);
+        CurveTo(cx + rx * (cos1 - h * sin1), cy + ry * (sin1 + h * cos1), cx + rx * (cos2 + h * sin2), cy + ry * (sin2 - h * cos2),
+            cx + rx * cos2, cy + ry * sin2);
+    }
+}
+
+void RasterSVGPath::Rect(float x, float y, float width, float height)
+{
+    MoveTo(x, y);
+    LineTo(x + width, y);
+    LineTo(x + width, y + height);
+    LineTo(x, y + height);
+    ClosePath();
+}
+
+void RasterSVGPath::RoundedRect(float x, float y, float width, float height, float rx, float ry)
+{
+    ArcTo(x - rx + width, y + ry, rx, ry, -kPi / 2, 0, false);
+    ArcTo(x - rx + width, y - ry + height, rx, ry, 0, kPi / 2, true);
+    ArcTo(x + rx, y - ry + height, rx, ry, kPi / 2, kPi, true);
+    ArcTo(x + rx, y + ry, rx, ry, kPi, 3 * kPi / 2, true);
+    ClosePath();
+}
+
+void RasterSVGPath::Ellipse(float cx, float cy, float rx, float ry)
+{
+    ArcTo(cx, cy, rx, ry, 0, 2 * kPi, false);
+    ClosePath();
+}
+
+void RasterSVGPath::MoveTo(float x, float y)
+{
+    mVerbs.push_back(RasterVerb::kMoveTo);
+    AddPoint(x, y);
+    mCurrentX = mSubpathX = x;
+    mCurrentY = mSubpathY = y;
+}
+
+void RasterSVGPath::LineTo(float x, float y)
+{
+    mVerbs.push_back(RasterVerb::kLineTo);
+    AddPoint(x, y);
+    mCurrentX = x;
+    mCurrentY = y;
+}
+
+void RasterSVGPath::CurveTo(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    mVerbs.push_back(RasterVerb::kCurveTo);
+    AddPoint(x1, y1);
+    AddPoint(x2, y2);
+    AddPoint(x3, y3);
+    mCurrentX = x3;
+    mCurrentY = y3;
+}
+
+void RasterSVGPath::CurveToV(float x2, float y2, float x3, float y3)
+{
+    // Quadratic curve, raised to a cubic.
+    CurveTo(mCurrentX + 2.0f / 3.0f * (x2 - mCurrentX), mCurrentY + 2.0f / 3.0f * (y2 - mCurrentY), x3 + 2.0f / 3.0f * (x2 - x3),
+        y3 + 2.0f / 3.0f * (y2 - y3), x3, y3);
+}
+
+void RasterSVGPath::ClosePath()
+{
+    mVerbs.push_back(RasterVerb::kClose);
+    mCurrentX = mSubpathX;
+    mCurrentY = mSubpathY;
+}
+
+void RasterSVGPath::Extents(float& x1, float& y1, float& x2, float& y2) const
+{
+    if (!mHasExtents)
+    {
+        Bounds bounds;
+        for (size_t i = 0; i + 1 < mPoints.size(); i += 2)
+            bounds.Add(mPoints[i], mPoints[i + 1]);
+        mExtents[0] = bounds.minX;
+        mExtents[1] = bounds.minY;
+        mExtents[2] = bounds.maxX;
+        mExtents[3] = bounds.maxY;
+        mHasExtents = true;
+    }
+    x1 = mExtents[0];
+    y1 = mExtents[1];
+    x2 = mExtents[2];
+    y2 = mExtents[3];
+}
+
+RasterSVGTransform::RasterSVGTransform(float aA, float aB, float aC, float aD, float aE, float aF)
+    : a{aA}
+    , b{aB}
+    , c{aC}
+    , d{aD}
+    , e{aE}
+    , f{aF}
+{
+}
+
+void RasterSVGTransform::Set(float aA, float aB, float aC, float aD, float aE, float aF)
+{
+    a = aA;
+    b = aB;
+    c = aC;
+    d = aD;
+    e = aE;
+    f = aF;
+}
+
+// All operations apply before the existing transform, like the core Matrix.
+#define RASTER_TRANSFORM_APPLY(operation)   \
+    Matrix matrix{a, b, c, d, e, f};        \
+    matrix.operation;                       \
+    Set(matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f)
+
+void RasterSVGTransform::Rotate(float r)
+{
+    RASTER_TRANSFORM_APPLY(Rotate(r));
+}
+
+void RasterSVGTransform::Translate(float tx, float ty)
+{
+    RASTER_TRANSFORM_APPLY(Translate(tx, ty));
+}
+
+void RasterSVGTransform::Scale(float sx, float sy)
+{
+    RASTER_TRANSFORM_APPLY(Scale(sx, sy));
+}
+
+void RasterSVGTransform::Concat(float aA, float aB, float aC, float aD, float aE, float aF)
+{
+    RASTER_TRANSFORM_APPLY(Concat(aA, aB, aC, aD, aE, aF));
+}
+
+#undef RASTER_TRANSFORM_APPLY
+
+/**
+ * Drawing state and scratch buffers. Every state draws into the target or
+ * into the layer of a group with opacity.
+ */
+class RasterSVGRenderer::Context
+{
+public:
+    // Alpha of the clipping paths within rect.
+    struct ClipMask
+    {
+        RasterIntRect rect{};
+        std::vector<std::uint8_t> alpha;
+
+        std::uint8_t* Row(int x, int y)
+        {
+            return alpha.data() + static_cast<size_t>(y - rect.y0) * (rect.x1 - rect.x0) + (x - rect.x0);
+        }
+    };
+
+    struct State
+    {
+        Matrix matrix;
+        // Device pixels outside of clip are never touched. Inside, the
+        // alpha mask of all clipping paths applies, if any. A mask covers
+        // the clip of the state that created it, and nested states only
+        // narrow the clip.
+        RasterIntRect clip{};
+        ClipMask* clipMask{};
+        std::unique_ptr<ClipMask> ownedClipMask;
+        std::uint8_t* pixels{};
+        int stride{};
+        // Layer of this state, composited with layerOpacity on restore.
+        std::unique_ptr<std::vector<std::uint8_t>> layer;
+        float layerOpacity{1};
+    };
+
+    void SetTarget(std::uint8_t* pixels, int width, int height, int stride)
+    {
+        mWidth = width;
+        mHeight = height;
+        mStates.clear();
+        mStates.emplace_back();
+        auto& state = mStates.back();
+        state.clip = {0, 0, width, height};
+        state.pixels = pixels;
+        state.stride = stride;
+    }
+
+    bool HasTarget() const { return !mStates.empty() && mStates.front().pixels; }
+
+    const State& Top() const { return mStates.back(); }
+
+    void Push(const GraphicStyle* graphicStyle, float layerOpacity)
+    {
+        const auto& parent = mStates.back();
+        State state;
+        state.matrix = parent.matrix;
+        state.clip = parent.clip;
+        state.clipMask = parent.clipMask;
+        state.pixels = parent.pixels;
+        state.stride = parent.stride;
+
+        if (graphicStyle && graphicStyle->transform)
+            state.matrix.Concat(ToMatrix(*graphicStyle->transform));
+        if (graphicStyle && graphicStyle->clippingPath && graphicStyle->clippingPath->path)
+            Clip(state, *graphicStyle->clippingPath);
+
+        if (layerOpacity < 1 && !state.clip.IsEmpty())
+        {
+            state.layer = AcquireLayer(state.clip);
+            state.layerOpacity = layerOpacity;
+            state.pixels = state.layer->data();
+            state.stride = 4 * mWidth;
+        }
+        mStates.push_back(std::move(state));
+    }
+
+    void Pop()
+    {
+        SVG_ASSERT(mStates.size() > 1);
+        if (mStates.size() < 2)
+            return;
+        auto& state = mStates.back();
+        if (state.layer)
+        {
+            const auto& parent = mStates[mStates.size() - 2];
+            const auto& clip = state.clip;
+            const int count = clip.x1 - clip.x0;
+            mScratchCoverage.assign(static_cast<size_t>(count), ToByte(state.layerOpacity));
+            for (int y = clip.y0; y < clip.y1; ++y)
+            {
+                CompositeSpan(parent.pixels + static_cast<size_t>(y) * parent.stride + 4 * clip.x0,
+                    state.pixels + static_cast<size_t>(y) * state.stride + 4 * clip.x0, mScratchCoverage.data(), count);
+            }
+            mLayerPool.push_back(std::move(state.layer));
+        }
+        if (state.ownedClipMask)
+            mClipMaskPool.push_back(std::move(state.ownedClipMask));
+        mStates.pop_back();
+    }
+
+    // Device space bounds of geometry in user space are disjoint from the clip.
+    bool IsOutsideClip(const Bounds& bounds) const
+    {
+        const auto& state = mStates.back();
+        if (state.clip.IsEmpty())
+            return true;
+        const Bounds device = state.matrix.MapBounds(bounds);
+        return device.IsEmpty() || device.maxX < state.clip.x0 || device.minX > state.clip.x1 || device.maxY < state.clip.y0
+            || device.minY > state.clip.y1;
+    }
+
+    // Fills the polylines added to mCoverage.
+    void FillCoverage(WindingRule rule, const Paint& paint, float opacity)
+    {
+        const auto& state = mStates.back();
+        if (!mCoverage.Rasterize(state.clip))
+            return;
+        if (SVGNative::holds_alternative<Color>(paint))
+        {
+            std::uint8_t color[4];
+            PremultipliedColor(SVGNative::get<Color>(paint), opacity, color);
+            if (!color[3])
+                return;
+            Composite(rule, [&color](std::uint8_t* dst, int, int, int count, const std::uint8_t* coverage) {
+                CompositeSolidSpan(dst, color, coverage, count);
+            });
+            return;
+        }
+
+        mGradient.reset(new GradientShader);
+        if (!mGradient->Init(SVGNative::get<Gradient>(paint), state.matrix, opacity))
+        {
+            // Keep the rasterizer state consistent.
+            Composite(rule, [](std::uint8_t*, int, int, int, const std::uint8_t*) {});
+            return;
+        }
+        const GradientShader& shader = *mGradient;
+        Composite(rule, [this, &shader](std::uint8_t* dst, int x, int y, int count, const std::uint8_t* coverage) {
+            shader.Shade(x, y, count, mScratchPixels.data());
+            CompositeSpan(dst, mScratchPixels.data(), coverage, count);
+        });
+    }
+
+    void FillImage(const ImageShader& shader)
+    {
+        if (!mCoverage.Rasterize(mStates.back().clip))
+            return;
+        Composite(WindingRule::kNonZero, [this, &shader](std::uint8_t* dst, int x, int y, int count, const std::uint8_t* coverage) {
+            shader.Shade(x, y, count, mScratchPixels.data());
+            CompositeSpan(dst, mScratchPixels.data(), coverage, count);
+        });
+    }
+
+    RasterCoverage mCoverage;
+    RasterPolyline mPolyline;
+    RasterPolyline mOutline;
+
+private:
+    // Calls span(dst, x, y, count, coverage) for every row of the last
+    // Rasterize() call, with the clip mask applied.
+    template <typename SpanFunction>
+    void Composite(WindingRule rule, SpanFunction span)
+    {
+        const auto& state = mStates.back();
+        const auto& bounds = mCoverage.Bounds();
+        const int count = bounds.x1 - bounds.x0;
+        if (mScratchPixels.size() < 4 * static_cast<size_t>(count))
+            mScratchPixels.resize(4 * static_cast<size_t>(count));
+        for (int y = bounds.y0; y < bounds.y1; ++y)
+        {
+            std::uint8_t* coverage = mCoverage.Row(y, rule);
+            if (state.clipMask)
+                MultiplySpan(coverage, state.clipMask->Row(bounds.x0, y), count);
+            span(state.pixels + static_cast<size_t>(y) * state.stride + 4 * bounds.x0, bounds.x0, y, count, coverage);
+        }
+    }
+
+    void Clip(State& state, const ClippingPath& clippingPath)
+    {
+        if (clippingPath.isRect && ClipToPixelRect(state, clippingPath.clipRect))
+            return;
+        Matrix matrix{state.matrix};
+        if (clippingPath.transform)
+            matrix.Concat(ToMatrix(*clippingPath.transform));
+        FlattenPath(static_cast<const RasterSVGPath&>(*clippingPath.path), matrix, kTolerance, mPolyline);
+        mCoverage.AddPolyline(mPolyline);
+
+        if (!mCoverage.Rasterize(state.clip))
+        {
+            state.clip = {0, 0, 0, 0};
+            return;
+        }
+        // The mask only covers the new clip. Every row of it gets written.
+        const auto& bounds = mCoverage.Bounds();
+        auto mask = AcquireClipMask(bounds);
+        const int count = bounds.x1 - bounds.x0;
+        for (int y = bounds.y0; y < bounds.y1; ++y)
+        {
+            std::uint8_t* coverage = mCoverage.Row(y, clippingPath.clipRule);
+            if (state.clipMask)
+                MultiplySpan(coverage, state.clipMask->Row(bounds.x0, y), count);
+            std::memcpy(mask->Row(bounds.x0, y), coverage, static_cast<size_t>(count));
+        }
+        state.clip = state.clip.Intersect(bounds);
+        state.clipMask = mask.get();
+        state.ownedClipMask = std::move(mask);
+    }
+
+    // Rectangles on pixel boundaries only narrow the clip area. Their
+    // coverage would be 0 or 255 everywhere, so no mask gets created.
+    bool ClipToPixelRect(State& state, const ClipRect& clipRect)
+    {
+        const auto& matrix = state.matrix;
+        if (!((matrix.b == 0 && matrix.c == 0) || (matrix.a == 0 && matrix.d == 0)))
+            return false;
+        auto bounds = matrix.MapBounds(Bounds{clipRect.x, clipRect.y, clipRect.x + clipRect.width, clipRect.y + clipRect.height});
+        if (bounds.IsEmpty())
+            return false;
+        // Edges outside of the target are aligned in any case.
+        const float width = static_cast<float>(mWidth);
+        const float height = static_cast<float>(mHeight);
+        bounds.minX = std::min(std::max(bounds.minX, 0.0f), width);
+        bounds.minY = std::min(std::max(bounds.minY, 0.0f), height);
+        bounds.maxX = std::min(std::max(bounds.maxX, 0.0f), width);
+        bounds.maxY = std::min(std::max(bounds.maxY, 0.0f), height);
+        const RasterIntRect rect{static_cast<int>(std::round(bounds.minX)), static_cast<int>(std::round(bounds.minY)),
+            static_cast<int>(std::round(bounds.maxX)), static_cast<int>(std::round(bounds.maxY))};
+        if (std::abs(bounds.minX - rect.x0) > kPixelAlignment || std::abs(bounds.minY - rect.y0) > kPixelAlignment
+            || std::abs(bounds.maxX - rect.x1) > kPixelAlignment || std::abs(bounds.maxY - rect.y1) > kPixelAlignment)
+            return false;
+        state.clip = state.clip.Intersect(rect);
+        return true;
+    }
+
+    std::unique_ptr<ClipMask> AcquireClipMask(const RasterIntRect& rect)
+    {
+        std::unique_ptr<ClipMask> mask;
+        if (!mClipMaskPool.empty())
+        {
+            mask = std::move(mClipMaskPool.back());
+            mClipMaskPool.pop_back();
+        }
+        else
+            mask.reset(new ClipMask);
+        mask->rect = rect;
+        mask->alpha.resize(static_cast<size_t>(rect.x1 - rect.x0) * (rect.y1 - rect.y0));
+        return mask;
+    }
+
+    std::unique_ptr<std::vector<std::uint8_t>> AcquireLayer(const RasterIntRect& clip)
+    {
+        std::unique_ptr<std::vector<std::uint8_t>> layer;
+        if (!mLayerPool.empty())
+        {
+            layer = std::move(mLayerPool.back());
+            mLayerPool.pop_back();
+        }
+        else
+            layer.reset(new std::vector<std::uint8_t>);
+        layer->resize(4 * static_cast<size_t>(mWidth) * mHeight);
+        // Only the clip area gets drawn and composited.
+        for (int y = clip.y0; y < clip.y1; ++y)
+            std::memset(layer->data() + 4 * (static_cast<size_t>(y) * mWidth + clip.x0), 0, 4 * static_cast<size_t>(clip.x1 - clip.x0));
+        return layer;
+    }
+
+    int mWidth{};
+    int mHeight{};
+    std::vector<State> mStates;
+    std::vector<std::unique_ptr<std::vector<std::uint8_t>>> mLayerPool;
+    std::vector<std::unique_ptr<ClipMask>> mClipMaskPool;
+    std::unique_ptr<GradientShader> mGradient;
+    std::vector<std::uint8_t> mScratchPixels;
+    std::vector<std::uint8_t> mScratchCoverage;
+};
+
+RasterSVGRenderer::RasterSVGRenderer()
+    : mContext{new Context}
+{
+}
+
+RasterSVGRenderer::~RasterSVGRenderer() = default;
+
+std::unique_ptr<ImageData> RasterSVGRenderer::CreateImageData(const std::string& base64, ImageEncoding encoding)
+{
+    std::string data;
+    std::unique_ptr<RasterSVGImageData> image{new RasterSVGImageData};
+    if (!mImageDecoder || !DecodeBase64(base64, data) || !mImageDecoder(data, encoding, *image))
+        return nullptr;
+    if (image->mWidth <= 0 || image->mHeight <= 0 || image->mPixels.size() < 4 * static_cast<size_t>(image->mWidth) * image->mHeight)
+        return nullptr;
+    return std::unique_ptr<ImageData>(image.release());
+}
+
+void RasterSVGRenderer::SetTarget(std::uint8_t* pixels, int width, int height, int stride)
+{
+    SVG_ASSERT(pixels && width >= 0 && height >= 0 && stride >= 4 * width);
+    mContext->SetTarget(pixels, width, height, stride);
+}
+
+void RasterSVGRenderer::Save(const GraphicStyle& graphicStyle)
+{
+    SVG_ASSERT(mContext->HasTarget());
+    mContext->Push(&graphicStyle, graphicStyle.opacity);
+}
+
+void RasterSVGRenderer::Restore()
+{
+    mContext->Pop();
+}
+
+void RasterSVGRenderer::DrawPath(
+    const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle)
+{
+    SVG_ASSERT(mContext->HasTarget());
+    if (!mContext->HasTarget() || (!fillStyle.hasFill && !strokeStyle.hasStroke))
+        return;
+    const auto& rasterPath = static_cast<const RasterSVGPath&>(path);
+
+    // Opacity goes into the paints unless fill and stroke overlap. Then
+    // the element needs a layer.
+    const bool needsLayer = fillStyle.hasFill && strokeStyle.hasStroke && graphicStyle.opacity < 1;
+    const bool pushed = graphicStyle.needsSave || needsLayer;
+    if (pushed)
+        mContext->Push(graphicStyle.needsSave ? &graphicStyle : nullptr, needsLayer ? graphicStyle.opacity : 1);
+    const float opacity = needsLayer ? 1 : graphicStyle.opacity;
+
+    Bounds bounds;
+    rasterPath.Extents(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+    if (strokeStyle.hasStroke)
+    {
+        // Conservative outset for miters and square caps.
+        bounds.Outset(strokeStyle.lineWidth / 2 * std::max(strokeStyle.miterLimit, 1.5f));
+    }
+
+    if (!mContext->IsOutsideClip(bounds))
+    {
+        const auto& state = mContext->Top();
+        if (fillStyle.hasFill)
+        {
+            FlattenPath(rasterPath, state.matrix, kTolerance, mContext->mPolyline);
+            mContext->mCoverage.AddPolyline(mContext->mPolyline);
+            mContext->FillCoverage(fillStyle.fillRule, fillStyle.paint, fillStyle.fillOpacity * opacity);
+        }
+        const float scale = MaxScale(state.matrix);
+        if (strokeStyle.hasStroke && scale > 0 && std::isfinite(scale))
+        {
+            // Strokes get built in user space, so non-uniform transforms
+            // distort them like the specification asks for.
+            const float tolerance = kTolerance / scale;
+            FlattenPath(rasterPath, Matrix{}, tolerance, mContext->mPolyline);
+            const RasterStrokeParams params{strokeStyle.lineWidth / 2, strokeStyle.lineCap, strokeStyle.lineJoin,
+                strokeStyle.miterLimit, &strokeStyle.dashArray, strokeStyle.dashOffset, tolerance};
+            StrokePolyline(mContext->mPolyline, params, mContext->mOutline);
+            mContext->mOutline.Transform(state.matrix);
+            mContext->mCoverage.AddPolyline(mContext->mOutline);
+            mContext->FillCoverage(WindingRule::kNonZero, strokeStyle.paint, strokeStyle.strokeOpacity * opacity);
+        }
+    }
+
+    if (pushed)
+        mContext->Pop();
+}
+
+void RasterSVGRenderer::DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea)
+{
+    SVG_ASSERT(mContext->HasTarget());
+    if (!mContext->HasTarget())
+        return;
+    const auto& rasterImage = static_cast<const RasterSVGImageData&>(image);
+    const Rect area = clipArea & fillArea;
+    if (area.IsEmpty() || !rasterImage.mWidth || !rasterImage.mHeight)
+        return;
+
+    mContext->Push(&graphicStyle, 1);
+    const Bounds bounds = Bounds::FromRect(area);
+    if (!mContext->IsOutsideClip(bounds))
+    {
+        const auto& state = mContext->Top();
+        Matrix imageMatrix{state.matrix};
+        imageMatrix.Translate(fillArea.x, fillArea.y);
+        imageMatrix.Scale(fillArea.width / rasterImage.mWidth, fillArea.height / rasterImage.mHeight);
+        ImageShader shader;
+        if (shader.Init(rasterImage, imageMatrix, graphicStyle.opacity))
+        {
+            auto& polyline = mContext->mPolyline;
+            polyline.Clear();
+            polyline.MoveTo(area.x, area.y);
+            polyline.LineTo(area.x + area.width, area.y);
+            polyline.LineTo(area.x + area.width, area.y + area.height);
+            polyline.LineTo(area.x, area.y + area.height);
+            polyline.Close();
+            polyline.Transform(state.matrix);
+            mContext->mCoverage.AddPolyline(polyline);
+            mContext->FillImage(shader);
+        }
+    }
+    mContext->Pop();
+}
+
+} // namespace SVGNative
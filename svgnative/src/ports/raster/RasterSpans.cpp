@@ -0,0 +1,153 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "RasterSpans.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SVGNATIVE_RASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace SVGNative
+{
+
+namespace
+{
+// Exact a * b / 255 for a, b in [0, 255], rounded.
+inline std::uint32_t Multiply255(std::uint32_t a, std::uint32_t b)
+{
+    const std::uint32_t t = a * b + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline void CompositePixel(std::uint8_t* dst, const std::uint8_t* src, std::uint32_t coverage)
+{
+    const std::uint32_t alpha = Multiply255(src[3], coverage);
+    const std::uint32_t inverse = 255 - alpha;
+    for (int i = 0; i < 4; ++i)
+        dst[i] = static_cast<std::uint8_t>(Multiply255(src[i], coverage) + Multiply255(dst[i], inverse));
+}
+
+#ifdef SVGNATIVE_RASTER_SSE2
+// a * b / 255 on eight 16 bit lanes, same rounding as Multiply255().
+inline __m128i Multiply255(__m128i a, __m128i b)
+{
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// Repeats each of four coverage bytes four times, one per channel.
+inline __m128i ExpandCoverage(std::uint32_t coverage)
+{
+    __m128i c = _mm_cvtsi32_si128(static_cast<int>(coverage));
+    c = _mm_unpacklo_epi8(c, c);
+    return _mm_unpacklo_epi16(c, c);
+}
+
+// Source over on two pixels in 16 bit lanes.
+inline __m128i CompositeTwoPixels(__m128i src, __m128i dst, __m128i coverage)
+{
+    src = Multiply255(src, coverage);
+    __m128i alpha = _mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_add_epi16(src, Multiply255(dst, _mm_sub_epi16(_mm_set1_epi16(255), alpha)));
+}
+
+inline __m128i CompositeFourPixels(__m128i src, __m128i dst, __m128i coverage)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = CompositeTwoPixels(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi8(coverage, zero));
+    const __m128i high = CompositeTwoPixels(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi8(coverage, zero));
+    return _mm_packus_epi16(low, high);
+}
+#endif
+} // namespace
+
+void CompositeSolidSpan(std::uint8_t* dst, const std::uint8_t color[4], const std::uint8_t* coverage, int count)
+{
+    std::uint32_t colorWord;
+    std::memcpy(&colorWord, color, 4);
+    const bool opaque = color[3] == 255;
+    int x = 0;
+#ifdef SVGNATIVE_RASTER_SSE2
+    const __m128i colorVector = _mm_set1_epi32(static_cast<int>(colorWord));
+    for (; x + 4 <= count; x += 4)
+    {
+        std::uint32_t coverageWord;
+        std::memcpy(&coverageWord, coverage + x, 4);
+        if (!coverageWord)
+            continue;
+        std::uint8_t* pixels = dst + 4 * x;
+        if (opaque && coverageWord == 0xffffffffu)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), colorVector);
+            continue;
+        }
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), CompositeFourPixels(colorVector, d, ExpandCoverage(coverageWord)));
+    }
+#endif
+    for (; x < count; ++x)
+    {
+        if (!coverage[x])
+            continue;
+        if (opaque && coverage[x] == 255)
+            std::memcpy(dst + 4 * x, &colorWord, 4);
+        else
+            CompositePixel(dst + 4 * x, color, coverage[x]);
+    }
+}
+
+void CompositeSpan(std::uint8_t* dst, const std::uint8_t* src, const std::uint8_t* coverage, int count)
+{
+    int x = 0;
+#ifdef SVGNATIVE_RASTER_SSE2
+    for (; x + 4 <= count; x += 4)
+    {
+        std::uint32_t coverageWord;
+        std::memcpy(&coverageWord, coverage + x, 4);
+        if (!coverageWord)
+            continue;
+        std::uint8_t* pixels = dst + 4 * x;
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * x));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), CompositeFourPixels(s, d, ExpandCoverage(coverageWord)));
+    }
+#endif
+    for (; x < count; ++x)
+    {
+        if (coverage[x])
+            CompositePixel(dst + 4 * x, src + 4 * x, coverage[x]);
+    }
+}
+
+void MultiplySpan(std::uint8_t* coverage, const std::uint8_t* mask, int count)
+{
+    int x = 0;
+#ifdef SVGNATIVE_RASTER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coverage + x));
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + x));
+        const __m128i low = Multiply255(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(m, zero));
+        const __m128i high = Multiply255(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(m, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(coverage + x), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; x < count; ++x)
+        coverage[x] = static_cast<std::uint8_t>(Multiply255(coverage[x], mask[x]));
+}
+
+} // namespace SVGNative
@@ -0,0 +1,42 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_RasterSpans_h
+#define SVGViewer_RasterSpans_h
+
+#include <cstdint>
+
+namespace SVGNative
+{
+
+// Span compositing on premultiplied RGBA pixels, 8 bits per channel. All
+// functions composite source over destination. SSE2 processes four pixels
+// at once where available.
+
+/**
+ * Composites one color, weighted by coverage, over count pixels of dst.
+ */
+void CompositeSolidSpan(std::uint8_t* dst, const std::uint8_t color[4], const std::uint8_t* coverage, int count);
+
+/**
+ * Composites count pixels of src, weighted by coverage, over dst.
+ */
+void CompositeSpan(std::uint8_t* dst, const std::uint8_t* src, const std::uint8_t* coverage, int count);
+
+/**
+ * Multiplies coverage by mask.
+ */
+void MultiplySpan(std::uint8_t* coverage, const std::uint8_t* mask, int count);
+
+} // namespace SVGNative
+
+#endif // SVGViewer_RasterSpans_h
@@ -11,8 +11,10 @@ governing permissions and limitations under the License.
 */
 
 #include "svgnative/ports/skia/SkiaSVGRenderer.h"
-#include "base64.h"
+#include "Base64.h"
+#include "ImageLevel.h"
 #include "svgnative/Config.h"
+#include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkCodec.h"
 #include "SkData.h"
@@ -28,6 +30,7 @@ governing permissions and limitations under the License.
 #include "SkTypes.h"
 #include "SkSamplingOptions.h"
 #include <math.h>
+#include <algorithm>
 
 namespace SVGNative
 {
@@ -74,6 +77,66 @@ void SkiaSVGPath::CurveToV(float x2, float y2, float x3, float y3)
 
 void SkiaSVGPath::ClosePath() { mPath.close(); }
 
+void SkiaSVGPath::Append(const std::uint8_t* verbs, size_t verbCount, const float* points, size_t pointCount)
+{
+    // Grow the point storage once instead of per segment.
+    mPath.incReserve(static_cast<int>(pointCount));
+    const float* end = points + 2 * pointCount;
+    for (size_t i = 0; i < verbCount; ++i)
+    {
+        switch (static_cast<PathVerb>(verbs[i]))
+        {
+        case PathVerb::kMove:
+            if (end - points < 2)
+                return;
+            mPath.moveTo(points[0], points[1]);
+            points += 2;
+            break;
+        case PathVerb::kLine:
+            if (end - points < 2)
+                return;
+            mPath.lineTo(points[0], points[1]);
+            points += 2;
+            break;
+        case PathVerb::kCurve:
+            if (end - points < 6)
+                return;
+            mPath.cubicTo(points[0], points[1], points[2], points[3], points[4], points[5]);
+            points += 6;
+            break;
+        case PathVerb::kQuadCurve:
+            if (end - points < 4)
+                return;
+            mPath.quadTo(points[0], points[1], points[2], points[3]);
+            points += 4;
+            break;
+        case PathVerb::kClose:
+            mPath.close();
+            continue;
+        default:
+            continue;
+        }
+        mCurrentX = points[-2];
+        mCurrentY = points[-1];
+    }
+}
+
+static SkPathFillType FillType(WindingRule fillRule)
+{
+    return fillRule == WindingRule::kNonZero ? SkPathFillType::kWinding : SkPathFillType::kEvenOdd;
+}
+
+void SkiaSVGPath::SetFillRule(WindingRule fillRule) { mPath.setFillType(FillType(fillRule)); }
+
+const SkPath& SkiaSVGPath::WithFillRule(WindingRule fillRule, SkPath& copy) const
+{
+    if (mPath.getFillType() == FillType(fillRule))
+        return mPath;
+    copy = mPath;
+    copy.setFillType(FillType(fillRule));
+    return copy;
+}
+
 SkiaSVGTransform::SkiaSVGTransform(float a, float b, float c, float d, float tx, float ty) { Set(a, b, c, d, tx, ty); }
 
 void SkiaSVGTransform::Set(float a, float b, float c, float d, float tx, float ty) { mMatrix.setAll(a, c, tx, b, d, ty, 0, 0, 1); }
@@ -91,71 +154,47 @@ void SkiaSVGTransform::Concat(float a, float b, float c, float d, float tx, floa
     mMatrix.preConcat(other);
 }
 
-inline sk_sp<SkImage> getOrientedImage(sk_sp<SkImage> srcImg, SkEncodedOrigin origin)
+// Draws only the pixels of the decoded level, not of the full image.
+static sk_sp<SkImage> OrientImage(sk_sp<SkImage> image, SkEncodedOrigin origin)
 {
-    int width = 0, height = 0;
-    int offsetX = 0, offsetY = 0;
-    int rot = 0;
-    int centerX = 0, centerY = 0;
-
-    switch (origin)
-    {
-    case SkEncodedOrigin::kBottomRight_SkEncodedOrigin:
-        width = srcImg->width();
-        height = srcImg->height();
-        rot = 180;
-        centerX = width / 2;
-        centerY = height / 2;
-        break;
-
-    case SkEncodedOrigin::kLeftBottom_SkEncodedOrigin:
-        width = srcImg->height();
-        height = srcImg->width();
-        offsetX = width;
-        rot = 90;
-        break;
-
-    case SkEncodedOrigin::kRightTop_SkEncodedOrigin:
-        width = srcImg->height();
-        height = srcImg->width();
-        offsetY = height;
-        rot = 270;
-        break;
-
-    default:
-        return nullptr;
-    }
-
+    if (!image || origin == kTopLeft_SkEncodedOrigin)
+        return image;
+    const int width = SkEncodedOriginSwapsWidthHeight(origin) ? image->height() : image->width();
+    const int height = SkEncodedOriginSwapsWidthHeight(origin) ? image->width() : image->height();
     auto skRasterSurface = SkSurface::MakeRasterN32Premul(width, height);
+    if (!skRasterSurface)
+        return nullptr;
     auto skRasterCanvas = skRasterSurface->getCanvas();
-    if (offsetX != 0 || offsetY != 0)
-        skRasterCanvas->translate(offsetX, offsetY);
-    if (rot != 0)
-    {
-        if (centerX != 0 || centerY != 0)
-            skRasterCanvas->rotate(rot, centerX, centerY);
-        else
-            skRasterCanvas->rotate(rot);
-    }
-    skRasterCanvas->drawImage(srcImg, 0, 0);
+    skRasterCanvas->concat(SkEncodedOriginToMatrix(origin, image->width(), image->height()));
+    skRasterCanvas->drawImage(image, 0, 0);
     return skRasterSurface->makeImageSnapshot();
 }
 
+static sk_sp<SkImage> MakeImage(SkBitmap& bitmap)
+{
+    bitmap.setImmutable();
+    return SkImage::MakeFromBitmap(bitmap);
+}
+
 SkiaSVGImageData::SkiaSVGImageData(const std::string& base64, ImageEncoding /*encoding*/)
 {
-    std::string imageString = base64_decode(base64);
-    auto skData = SkData::MakeWithCopy(imageString.data(), imageString.size());
+    // Decode straight into the buffer of the SkData.
+    auto skData = SkData::MakeUninitialized(DecodedBase64Size(base64.size()));
+    size_t size{};
+    if (!DecodeBase64(base64.data(), base64.size(), static_cast<std::uint8_t*>(skData->writable_data()), size))
+        return;
+    if (size != skData->size())
+        skData = SkData::MakeSubset(skData.get(), 0, size);
     std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(skData, nullptr);
     if (!codec)
         return;
-    SkEncodedOrigin origin = codec->getOrigin();
-    if (origin == SkEncodedOrigin::kTopLeft_SkEncodedOrigin)
-        mImageData = SkImage::MakeFromEncoded(skData);
-    else
-    {
-        auto rawImg = SkImage::MakeFromEncoded(skData);
-        mImageData = getOrientedImage(rawImg, origin);
-    }
+    // Only read the header. The levels that get drawn are decoded later.
+    mEncoded = std::move(skData);
+    mOrigin = codec->getOrigin();
+    mEncodedWidth = codec->dimensions().width();
+    mEncodedHeight = codec->dimensions().height();
+    mWidth = SkEncodedOriginSwapsWidthHeight(mOrigin) ? mEncodedHeight : mEncodedWidth;
+    mHeight = SkEncodedOriginSwapsWidthHeight(mOrigin) ? mEncodedWidth : mEncodedHeight;
 }
 
 SkiaSVGImageData::~SkiaSVGImageData()
@@ -164,30 +203,102 @@ SkiaSVGImageData::~SkiaSVGImageData()
 
 float SkiaSVGImageData::Width() const
 {
-    if (!mImageData)
-        return 0;
-    return static_cast<float>(mImageData->width());
+    return static_cast<float>(mWidth);
 }
 
 float SkiaSVGImageData::Height() const
 {
-    if (!mImageData)
-        return 0;
-    return static_cast<float>(mImageData->height());
+    return static_cast<float>(mHeight);
+}
+
+sk_sp<SkImage> SkiaSVGImageData::Level(int level) const
+{
+    if (!mEncoded)
+        return nullptr;
+    level = std::min(std::max(level, 0), kMaxImageLevel);
+    std::lock_guard<std::mutex> lock{mLevelsMutex};
+    if (mLevels.size() <= static_cast<size_t>(level))
+        mLevels.resize(level + 1);
+    if (!mLevels[level])
+        mLevels[level] = CreateLevel(level);
+    return mLevels[level];
+}
+
+sk_sp<SkImage> SkiaSVGImageData::CreateLevel(int level) const
+{
+    // Skia decodes upright encoded images lazily and caches the pixels.
+    if (level == 0 && mOrigin == kTopLeft_SkEncodedOrigin)
+        return SkImage::MakeFromEncoded(mEncoded);
+
+    // Let the codec downscale while decoding (JPEG by 1/2, 1/4 and 1/8,
+    // WebP by any factor) if it hits the level size exactly.
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(mEncoded, nullptr);
+    if (!codec)
+        return nullptr;
+    const SkISize levelSize{ImageLevelSize(mEncodedWidth, level), ImageLevelSize(mEncodedHeight, level)};
+    if (codec->getScaledDimensions(1.0f / static_cast<float>(1 << level)) == levelSize)
+    {
+        SkBitmap bitmap;
+        if (!bitmap.tryAllocPixels(codec->getInfo().makeWH(levelSize.width(), levelSize.height())
+            .makeColorType(kN32_SkColorType).makeAlphaType(kPremul_SkAlphaType)))
+            return nullptr;
+        const SkCodec::Result result = codec->getPixels(bitmap.pixmap());
+        if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput)
+            return nullptr;
+        return OrientImage(MakeImage(bitmap), mOrigin);
+    }
+
+    // Halve the previous level, which is oriented already. Linear
+    // filtering averages 2x2 pixels then.
+    sk_sp<SkImage> source = mLevels[level - 1] ? mLevels[level - 1] : (mLevels[level - 1] = CreateLevel(level - 1));
+    if (!source)
+        return nullptr;
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(ImageLevelSize(mWidth, level), ImageLevelSize(mHeight, level))))
+        return nullptr;
+    if (!source->scalePixels(bitmap.pixmap(), SkSamplingOptions(SkFilterMode::kLinear)))
+        return nullptr;
+    return MakeImage(bitmap);
+}
+
+SkiaSVGRenderer::SkiaSVGRenderer()
+{
+    mFillPaint.setAntiAlias(true);
+    mFillPaint.setStyle(SkPaint::kFill_Style);
+    mStrokePaint.setAntiAlias(true);
+    mStrokePaint.setStyle(SkPaint::kStroke_Style);
 }
 
-SkiaSVGRenderer::SkiaSVGRenderer() {}
+void SkiaSVGRenderer::SetGradientCacheCapacity(size_t capacity)
+{
+    mShaderCapacity = capacity;
+    while (mShaders.size() > mShaderCapacity)
+    {
+        mShaderIndex.erase(mShaders.back().first);
+        mShaders.pop_back();
+    }
+}
 
 void SkiaSVGRenderer::Save(const GraphicStyle& graphicStyle)
+{
+    Save(graphicStyle, graphicStyle.opacity != 1.0);
+}
+
+void SkiaSVGRenderer::Save(const GraphicStyle& graphicStyle, bool opacityLayer)
 {
     SVG_ASSERT(mCanvas);
-    if (graphicStyle.opacity != 1.0)
+    if (opacityLayer)
         mCanvas->saveLayerAlpha(nullptr, static_cast<U8CPU>(graphicStyle.opacity * 255));
     else
         mCanvas->save();
     if (graphicStyle.transform)
         mCanvas->concat(static_cast<SkiaSVGTransform*>(graphicStyle.transform.get())->mMatrix);
-    if (graphicStyle.clippingPath && graphicStyle.clippingPath->path)
+    if (graphicStyle.clippingPath && graphicStyle.clippingPath->isRect)
+    {
+        const auto& clipRect = graphicStyle.clippingPath->clipRect;
+        mCanvas->clipRect(SkRect::MakeXYWH(clipRect.x, clipRect.y, clipRect.width, clipRect.height));
+    }
+    else if (graphicStyle.clippingPath && graphicStyle.clippingPath->path)
     {
         SkPath clippingPath(static_cast<const SkiaSVGPath*>(graphicStyle.clippingPath->path.get())->mPath);
         if (graphicStyle.clippingPath->transform)
@@ -195,7 +306,7 @@ void SkiaSVGRenderer::Save(const GraphicStyle& graphicStyle)
             const auto& matrix = static_cast<const SkiaSVGTransform*>(graphicStyle.clippingPath->transform.get())->mMatrix;
             clippingPath.transform(matrix);
         }
-        clippingPath.setFillType(graphicStyle.clippingPath->clipRule == WindingRule::kNonZero ? SkPathFillType::kWinding : SkPathFillType::kEvenOdd);
+        clippingPath.setFillType(FillType(graphicStyle.clippingPath->clipRule));
         mCanvas->clipPath(clippingPath);
     }
 }
@@ -206,78 +317,116 @@ void SkiaSVGRenderer::Restore()
     mCanvas->restore();
 }
 
-inline void CreateSkPaint(const Paint& paint, float opacity, SkPaint& skPaint)
+inline SkColor CreateSkColor(const Color& color, float opacity)
 {
-    if (SVGNative::holds_alternative<Color>(paint))
-    {
-        const auto& color = SVGNative::get<Color>(paint);
-        skPaint.setColor(SkColorSetARGB(static_cast<uint8_t>(opacity * color[3] * 255), static_cast<uint8_t>(color[0] * 255),
-            static_cast<uint8_t>(color[1] * 255), static_cast<uint8_t>(color[2] * 255)));
-    }
-    if (SVGNative::holds_alternative<Gradient>(paint))
+    return SkColorSetARGB(static_cast<uint8_t>(opacity * color[3] * 255), static_cast<uint8_t>(color[0] * 255),
+        static_cast<uint8_t>(color[1] * 255), static_cast<uint8_t>(color[2] * 255));
+}
+
+sk_sp<SkShader> SkiaSVGRenderer::GradientShader(const Gradient& gradient, float opacity)
+{
+    SkMatrix* matrix{};
+    if (gradient.transform)
+        matrix = &(static_cast<SkiaSVGTransform*>(gradient.transform.get())->mMatrix);
+
+    if (mShaderCapacity)
     {
-        const auto& gradient = SVGNative::get<Gradient>(paint);
-        std::vector<SkColor> colors;
-        std::vector<SkScalar> pos;
-        for (const auto& stop : gradient.colorStops)
-        {
-            pos.push_back(stop.first);
-            const auto& stopColor = stop.second;
-            colors.push_back(SkColorSetARGB(static_cast<uint8_t>(opacity * stopColor[3] * 255), static_cast<uint8_t>(stopColor[0] * 255),
-                static_cast<uint8_t>(stopColor[1] * 255), static_cast<uint8_t>(stopColor[2] * 255)));
-        }
-        SkTileMode mode;
-        switch (gradient.method)
-        {
-        case SpreadMethod::kReflect:
-            mode = SkTileMode::kMirror;
-            break;
-        case SpreadMethod::kRepeat:
-            mode = SkTileMode::kRepeat;
-            break;
-        case SpreadMethod::kPad:
-        default:
-            mode = SkTileMode::kClamp;
-            break;
-        }
-        SkMatrix* matrix{};
-        if (gradient.transform)
-            matrix = &(static_cast<SkiaSVGTransform*>(gradient.transform.get())->mMatrix);
-        if (gradient.type == GradientType::kLinearGradient)
+        mShaderKey.clear();
+        AppendGradientKey(mShaderKey, gradient, opacity);
+        if (matrix)
         {
-            SkPoint points[2] = {SkPoint::Make(gradient.x1, gradient.y1), SkPoint::Make(gradient.x2, gradient.y2)};
-            skPaint.setShader(
-                SkGradientShader::MakeLinear(points, colors.data(), pos.data(), static_cast<int>(colors.size()), mode, 0, matrix));
+            SkScalar values[9];
+            matrix->get9(values);
+            mShaderKey.append(reinterpret_cast<const char*>(values), sizeof(values));
         }
-        else if (gradient.type == GradientType::kRadialGradient)
+
+        auto indexIt = mShaderIndex.find(mShaderKey);
+        if (indexIt != mShaderIndex.end())
         {
-            skPaint.setShader(
-                SkGradientShader::MakeTwoPointConical(SkPoint::Make(gradient.fx, gradient.fy), 0, SkPoint::Make(gradient.cx, gradient.cy),
-                    gradient.r, colors.data(), pos.data(), static_cast<int>(colors.size()), mode, 0, matrix));
+            mShaders.splice(mShaders.begin(), mShaders, indexIt->second);
+            return indexIt->second->second;
         }
     }
+
+    mColors.clear();
+    mPositions.clear();
+    for (const auto& stop : gradient.colorStops)
+    {
+        mPositions.push_back(stop.first);
+        mColors.push_back(CreateSkColor(stop.second, opacity));
+    }
+    SkTileMode mode;
+    switch (gradient.method)
+    {
+    case SpreadMethod::kReflect:
+        mode = SkTileMode::kMirror;
+        break;
+    case SpreadMethod::kRepeat:
+        mode = SkTileMode::kRepeat;
+        break;
+    case SpreadMethod::kPad:
+    default:
+        mode = SkTileMode::kClamp;
+        break;
+    }
+    sk_sp<SkShader> shader;
+    if (gradient.type == GradientType::kLinearGradient)
+    {
+        SkPoint points[2] = {SkPoint::Make(gradient.x1, gradient.y1), SkPoint::Make(gradient.x2, gradient.y2)};
+        shader = SkGradientShader::MakeLinear(points, mColors.data(), mPositions.data(), static_cast<int>(mColors.size()), mode, 0, matrix);
+    }
+    else if (gradient.type == GradientType::kRadialGradient)
+    {
+        shader = SkGradientShader::MakeTwoPointConical(SkPoint::Make(gradient.fx, gradient.fy), 0, SkPoint::Make(gradient.cx, gradient.cy),
+            gradient.r, mColors.data(), mPositions.data(), static_cast<int>(mColors.size()), mode, 0, matrix);
+    }
+
+    if (mShaderCapacity)
+    {
+        mShaders.emplace_front(mShaderKey, shader);
+        mShaderIndex.emplace(mShaderKey, mShaders.begin());
+        SetGradientCacheCapacity(mShaderCapacity);
+    }
+    return shader;
+}
+
+void SkiaSVGRenderer::SetPaint(const Paint& paint, float opacity, SkPaint& skPaint)
+{
+    if (SVGNative::holds_alternative<Gradient>(paint))
+    {
+        // The stop colors carry the opacity. The paint alpha would scale the
+        // shader again and may be left over from a color draw.
+        skPaint.setAlphaf(1.0f);
+        skPaint.setShader(GradientShader(SVGNative::get<Gradient>(paint), opacity));
+    }
+    else
+    {
+        skPaint.setShader(nullptr);
+        skPaint.setColor(CreateSkColor(SVGNative::get<Color>(paint), opacity));
+    }
 }
 
 void SkiaSVGRenderer::DrawPath(
     const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle)
 {
     SVG_ASSERT(mCanvas);
-    Save(graphicStyle);
+    // A single paint can take the opacity. Fill and stroke overlap and
+    // need a layer.
+    const bool opacityLayer = graphicStyle.opacity != 1.0 && fillStyle.hasFill && strokeStyle.hasStroke;
+    const float paintOpacity = opacityLayer ? 1.0f : graphicStyle.opacity;
+    const bool needsSave = graphicStyle.needsSave || opacityLayer;
+    if (needsSave)
+        Save(graphicStyle, opacityLayer);
+    SkPath copy;
+    const SkPath& skPath = static_cast<const SkiaSVGPath&>(path).WithFillRule(fillStyle.fillRule, copy);
     if (fillStyle.hasFill)
     {
-        SkPaint fill;
-        fill.setAntiAlias(true);
-        fill.setStyle(SkPaint::kFill_Style);
-        CreateSkPaint(fillStyle.paint, fillStyle.fillOpacity, fill);
-        SkPath mPath = (static_cast<const SkiaSVGPath&>(path).mPath);
-        mPath.setFillType(fillStyle.fillRule == WindingRule::kNonZero ? SkPathFillType::kWinding : SkPathFillType::kEvenOdd);
-        mCanvas->drawPath(mPath, fill);
+        SetPaint(fillStyle.paint, fillStyle.fillOpacity * paintOpacity, mFillPaint);
+        mCanvas->drawPath(skPath, mFillPaint);
     }
     if (strokeStyle.hasStroke)
     {
-        SkPaint stroke;
-        stroke.setAntiAlias(true);
-        stroke.setStyle(SkPaint::kStroke_Style);
+        SkPaint& stroke = mStrokePaint;
         stroke.setStrokeWidth(strokeStyle.lineWidth);
         stroke.setStrokeMiter(strokeStyle.miterLimit);
         switch (strokeStyle.lineCap)
@@ -310,21 +459,36 @@ void SkiaSVGRenderer::DrawPath(
                                                         strokeStyle.dashArray.size(),
                                                         (SkScalar)strokeStyle.dashOffset));
         }
-        CreateSkPaint(strokeStyle.paint, strokeStyle.strokeOpacity, stroke);
-        mCanvas->drawPath(static_cast<const SkiaSVGPath&>(path).mPath, stroke);
+        else
+            stroke.setPathEffect(nullptr);
+        SetPaint(strokeStyle.paint, strokeStyle.strokeOpacity * paintOpacity, stroke);
+        mCanvas->drawPath(skPath, stroke);
     }
-    Restore();
+    if (needsSave)
+        Restore();
 }
 
 void SkiaSVGRenderer::DrawImage(
     const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea)
 {
     SVG_ASSERT(mCanvas);
-    Save(graphicStyle);
+    Save(graphicStyle, false);
     mCanvas->clipRect({clipArea.x, clipArea.y, clipArea.x + clipArea.width, clipArea.y + clipArea.height}, SkClipOp::kIntersect);
-    SkSamplingOptions samplingOptions;
-    mCanvas->drawImageRect(static_cast<const SkiaSVGImageData&>(image).mImageData,
-        {fillArea.x, fillArea.y, fillArea.x + fillArea.width, fillArea.y + fillArea.height}, samplingOptions, nullptr);
+    // Raster and GPU canvases get the smallest level that still has the
+    // device size of the image. Recording, PDF and other vector canvases
+    // have no pixels and keep level 0.
+    int level{};
+    if (mCanvas->imageInfo().colorType() != kUnknown_SkColorType)
+    {
+        const SkMatrix& matrix = mCanvas->getTotalMatrix();
+        level = ImageLevelForDeviceSize(static_cast<int>(image.Width()), static_cast<int>(image.Height()),
+            fillArea.width * hypotf(matrix.getScaleX(), matrix.getSkewY()),
+            fillArea.height * hypotf(matrix.getSkewX(), matrix.getScaleY()));
+    }
+    SkSamplingOptions samplingOptions{SkFilterMode::kLinear};
+    mImagePaint.setAlphaf(graphicStyle.opacity);
+    mCanvas->drawImageRect(static_cast<const SkiaSVGImageData&>(image).Level(level),
+        {fillArea.x, fillArea.y, fillArea.x + fillArea.width, fillArea.y + fillArea.height}, samplingOptions, &mImagePaint);
     Restore();
 }
 
@@ -335,10 +499,10 @@ Rect SkiaSVGRenderer::GetBounds(const Path& path, const GraphicStyle& graphicSty
     // we save the state while applying transforms and clippings if needed
     Save(graphicStyle);
     // get the internal SkPath
-    SkPath mPath = (static_cast<const SkiaSVGPath&>(path).mPath);
-    mPath.setFillType(fillStyle.fillRule == WindingRule::kNonZero ? SkPathFillType::kWinding : SkPathFillType::kEvenOdd);
+    SkPath copy;
+    const SkPath& skPath = static_cast<const SkiaSVGPath&>(path).WithFillRule(fillStyle.fillRule, copy);
     // compute the tight fill bounds for the path
-    bounds = mPath.computeTightBounds();
+    bounds = skPath.computeTightBounds();
     if (strokeStyle.hasStroke)
     {
         // create the stroke paint and then find the stroke bounds
@@ -351,8 +515,6 @@ Rect SkiaSVGRenderer::GetBounds(const Path& path, const GraphicStyle& graphicSty
                         strokeStyle.dashArray.size(),
                         (SkScalar)strokeStyle.dashOffset));
         }
-        CreateSkPaint(strokeStyle.paint, strokeStyle.strokeOpacity, stroke);
-        SkPath mPath = (static_cast<const SkiaSVGPath&>(path).mPath);
         if (stroke.canComputeFastBounds())
         {
             bounds = stroke.computeFastBounds(bounds, &bounds);
@@ -381,6 +543,41 @@ Rect SkiaSVGRenderer::GetBounds(const Path& path, const GraphicStyle& graphicSty
         return Rect{0, 0, 0, 0};
 }
 
+SkiaSVGRecording::SkiaSVGRecording(sk_sp<SkPicture> picture)
+    : mPicture{std::move(picture)}
+{
+}
+
+bool SkiaSVGRenderer::BeginRecording(const Rect& bounds)
+{
+    SVG_ASSERT(mCanvas);
+    mRecordingTargets.push_back(mCanvas);
+    mRecorders.emplace_back(new SkPictureRecorder);
+    mCanvas = mRecorders.back()->beginRecording(SkRect::MakeXYWH(bounds.x, bounds.y, bounds.width, bounds.height));
+    return true;
+}
+
+std::unique_ptr<Recording> SkiaSVGRenderer::EndRecording()
+{
+    SVG_ASSERT(!mRecordingTargets.empty());
+    if (mRecordingTargets.empty())
+        return nullptr;
+
+    mCanvas = mRecordingTargets.back();
+    mRecordingTargets.pop_back();
+    auto picture = mRecorders.back()->finishRecordingAsPicture();
+    mRecorders.pop_back();
+    if (!picture)
+        return nullptr;
+    return std::unique_ptr<Recording>(new SkiaSVGRecording(std::move(picture)));
+}
+
+void SkiaSVGRenderer::DrawRecording(const Recording& recording, const Transform& transform)
+{
+    SVG_ASSERT(mCanvas);
+    mCanvas->drawPicture(static_cast<const SkiaSVGRecording&>(recording).mPicture,
+        &static_cast<const SkiaSVGTransform&>(transform).mMatrix, nullptr);
+}
 
 void SkiaSVGRenderer::SetSkCanvas(SkCanvas* canvas)
 {
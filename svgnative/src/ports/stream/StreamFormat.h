@@ -0,0 +1,216 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_StreamFormat_h
+#define SVGViewer_StreamFormat_h
+
+#include "svgnative/ports/stream/StreamSVGRenderer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace SVGNative
+{
+
+// Stream layout: the header "SNVS" followed by a version byte, then
+// commands. Each command is one StreamOp byte and its operands. Integers
+// are unsigned LEB128 varints, floats little endian IEEE 754. Paths and
+// images get numbered in the order of their definition.
+//
+//  kSave         graphic
+//  kRestore
+//  kDrawPath     graphic, path index, fill, stroke
+//  kDrawImage    graphic, image index, clip area, fill area (4 floats each)
+//  kDefinePath   verb count, verbs, value count, values
+//  kDefineImage  encoding byte, width, height, base64 length, base64
+//
+//  graphic       flags (StreamGraphicFlags), [opacity], [transform],
+//                [clip flags (StreamClipFlags), [path index], [transform],
+//                [clip rect (4 floats)]]
+//  transform     6 floats
+//  fill          flags (StreamFillFlags), [opacity], [paint]
+//  stroke        hasStroke byte, [opacity, width, cap byte, join byte,
+//                miter limit, dash count, dashes, dash offset, paint]
+//  paint         0 and 4 floats for a color, 1 and a gradient:
+//                type byte, method byte, hasTransform byte, stop count,
+//                stops (offset and 4 floats), x1, y1, x2, y2 or
+//                cx, cy, fx, fy, r, [transform]
+
+constexpr char kStreamMagic[4] = {'S', 'N', 'V', 'S'};
+constexpr std::uint8_t kStreamVersion = 2;
+
+enum class StreamOp : std::uint8_t
+{
+    kSave = 1,
+    kRestore,
+    kDrawPath,
+    kDrawImage,
+    kDefinePath,
+    kDefineImage
+};
+
+enum StreamGraphicFlags : std::uint8_t
+{
+    kStreamGraphicNeedsSave = 1 << 0,
+    kStreamGraphicOpacity = 1 << 1,
+    kStreamGraphicTransform = 1 << 2,
+    kStreamGraphicClip = 1 << 3
+};
+
+enum StreamClipFlags : std::uint8_t
+{
+    kStreamClipContent = 1 << 0,
+    kStreamClipEvenOdd = 1 << 1,
+    kStreamClipPath = 1 << 2,
+    kStreamClipTransform = 1 << 3,
+    kStreamClipRect = 1 << 4
+};
+
+enum StreamFillFlags : std::uint8_t
+{
+    kStreamFillEnabled = 1 << 0,
+    kStreamFillEvenOdd = 1 << 1,
+    kStreamFillOpacity = 1 << 2
+};
+
+/**
+ * Number of float values following each StreamVerb.
+ */
+inline int StreamVerbValueCount(StreamVerb verb)
+{
+    static const int kCounts[] = {4, 6, 4, 2, 2, 6, 4, 0};
+    return kCounts[static_cast<int>(verb)];
+}
+
+class StreamWriter
+{
+public:
+    explicit StreamWriter(std::vector<std::uint8_t>& buffer)
+        : mBuffer(buffer)
+    {
+    }
+
+    void Byte(std::uint8_t value) { mBuffer.push_back(value); }
+
+    void Varint(std::uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            mBuffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        mBuffer.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void Float(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, 4);
+        for (int i = 0; i < 4; ++i, bits >>= 8)
+            mBuffer.push_back(static_cast<std::uint8_t>(bits));
+    }
+
+    void Floats(const float* values, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            Float(values[i]);
+    }
+
+    void Bytes(const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+    }
+
+private:
+    std::vector<std::uint8_t>& mBuffer;
+};
+
+/**
+ * Reads operands without ever going past the end. After the first read
+ * beyond the end, Ok() returns false and all reads return 0.
+ */
+class StreamReader
+{
+public:
+    StreamReader(const std::uint8_t* data, size_t size)
+        : mData{data}
+        , mEnd{data + size}
+    {
+    }
+
+    bool Ok() const { return mOk; }
+    bool AtEnd() const { return mData == mEnd; }
+    size_t Remaining() const { return static_cast<size_t>(mEnd - mData); }
+
+    std::uint8_t Byte()
+    {
+        if (!Require(1))
+            return 0;
+        return *mData++;
+    }
+
+    std::uint32_t Varint()
+    {
+        std::uint32_t value{};
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            const std::uint8_t byte = Byte();
+            if (!mOk)
+                return 0;
+            value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        mOk = false;
+        return 0;
+    }
+
+    float Float()
+    {
+        if (!Require(4))
+            return 0;
+        std::uint32_t bits = static_cast<std::uint32_t>(mData[0]) | static_cast<std::uint32_t>(mData[1]) << 8
+            | static_cast<std::uint32_t>(mData[2]) << 16 | static_cast<std::uint32_t>(mData[3]) << 24;
+        mData += 4;
+        float value;
+        std::memcpy(&value, &bits, 4);
+        return value;
+    }
+
+    const std::uint8_t* Bytes(size_t size)
+    {
+        if (!Require(size))
+            return nullptr;
+        const std::uint8_t* bytes = mData;
+        mData += size;
+        return bytes;
+    }
+
+private:
+    bool Require(size_t size)
+    {
+        if (mOk && Remaining() >= size)
+            return true;
+        mOk = false;
+        return false;
+    }
+
+    const std::uint8_t* mData;
+    const std::uint8_t* mEnd;
+    bool mOk{true};
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_StreamFormat_h
@@ -0,0 +1,351 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ports/stream/StreamSVGRenderer.h"
+#include "svgnative/Rect.h"
+#include "StreamFormat.h"
+
+namespace SVGNative
+{
+
+namespace
+{
+/**
+ * Decodes the commands of one stream and forwards them to a renderer.
+ * Paths and images defined by the stream get created with the renderer.
+ */
+class StreamPlayer
+{
+public:
+    StreamPlayer(const std::uint8_t* data, size_t size, SVGRenderer& renderer)
+        : mReader{data, size}
+        , mRenderer(renderer)
+    {
+    }
+
+    ~StreamPlayer()
+    {
+        for (; mSaveCount; --mSaveCount)
+            mRenderer.Restore();
+    }
+
+    bool Play()
+    {
+        const std::uint8_t* header = mReader.Bytes(sizeof(kStreamMagic) + 1);
+        if (!header || std::memcmp(header, kStreamMagic, sizeof(kStreamMagic)) || header[sizeof(kStreamMagic)] != kStreamVersion)
+            return false;
+
+        while (!mReader.AtEnd())
+        {
+            if (!PlayCommand(static_cast<StreamOp>(mReader.Byte())))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    bool PlayCommand(StreamOp op)
+    {
+        switch (op)
+        {
+        case StreamOp::kSave:
+        {
+            GraphicStyle graphicStyle;
+            if (!ReadGraphic(graphicStyle))
+                return false;
+            mRenderer.Save(graphicStyle);
+            ++mSaveCount;
+            return true;
+        }
+        case StreamOp::kRestore:
+            if (!mSaveCount)
+                return false;
+            mRenderer.Restore();
+            --mSaveCount;
+            return true;
+        case StreamOp::kDrawPath:
+        {
+            GraphicStyle graphicStyle;
+            FillStyle fillStyle;
+            StrokeStyle strokeStyle;
+            if (!ReadGraphic(graphicStyle))
+                return false;
+            const Path* path = ReadPathIndex();
+            if (!path || !ReadFill(fillStyle) || !ReadStroke(strokeStyle))
+                return false;
+            mRenderer.DrawPath(*path, graphicStyle, fillStyle, strokeStyle);
+            return true;
+        }
+        case StreamOp::kDrawImage:
+        {
+            GraphicStyle graphicStyle;
+            if (!ReadGraphic(graphicStyle))
+                return false;
+            const std::uint32_t index = mReader.Varint();
+            float areas[8];
+            ReadFloats(areas, 8);
+            if (!mReader.Ok() || index >= mImages.size())
+                return false;
+            // Images the renderer could not decode get skipped, like
+            // during parsing.
+            if (mImages[index])
+            {
+                mRenderer.DrawImage(*mImages[index], graphicStyle, {areas[0], areas[1], areas[2], areas[3]},
+                    {areas[4], areas[5], areas[6], areas[7]});
+            }
+            return true;
+        }
+        case StreamOp::kDefinePath:
+            return DefinePath();
+        case StreamOp::kDefineImage:
+            return DefineImage();
+        default:
+            return false;
+        }
+    }
+
+    bool DefinePath()
+    {
+        const std::uint32_t verbCount = mReader.Varint();
+        const std::uint8_t* verbs = mReader.Bytes(verbCount);
+        const std::uint32_t valueCount = mReader.Varint();
+        if (!mReader.Ok() || valueCount > mReader.Remaining() / 4)
+            return false;
+
+        std::vector<float> values(valueCount);
+        ReadFloats(values.data(), valueCount);
+        std::shared_ptr<Path> path = mRenderer.CreatePath();
+        const float* v = values.data();
+        const float* end = v + valueCount;
+        for (std::uint32_t i = 0; i < verbCount; ++i)
+        {
+            const auto verb = static_cast<StreamVerb>(verbs[i]);
+            if (verb > StreamVerb::kClosePath || end - v < StreamVerbValueCount(verb))
+                return false;
+            switch (verb)
+            {
+            case StreamVerb::kRect:
+                path->Rect(v[0], v[1], v[2], v[3]);
+                break;
+            case StreamVerb::kRoundedRect:
+                path->RoundedRect(v[0], v[1], v[2], v[3], v[4], v[5]);
+                break;
+            case StreamVerb::kEllipse:
+                path->Ellipse(v[0], v[1], v[2], v[3]);
+                break;
+            case StreamVerb::kMoveTo:
+                path->MoveTo(v[0], v[1]);
+                break;
+            case StreamVerb::kLineTo:
+                path->LineTo(v[0], v[1]);
+                break;
+            case StreamVerb::kCurveTo:
+                path->CurveTo(v[0], v[1], v[2], v[3], v[4], v[5]);
+                break;
+            case StreamVerb::kCurveToV:
+                path->CurveToV(v[0], v[1], v[2], v[3]);
+                break;
+            case StreamVerb::kClosePath:
+                path->ClosePath();
+                break;
+            }
+            v += StreamVerbValueCount(verb);
+        }
+        if (v != end)
+            return false;
+        mPaths.push_back(std::move(path));
+        return true;
+    }
+
+    bool DefineImage()
+    {
+        const std::uint8_t encoding = mReader.Byte();
+        // The size is informational, the renderer decodes its own.
+        mReader.Float();
+        mReader.Float();
+        const std::uint32_t size = mReader.Varint();
+        const std::uint8_t* base64 = mReader.Bytes(size);
+        if (!mReader.Ok() || encoding > static_cast<std::uint8_t>(ImageEncoding::kJPEG))
+            return false;
+        // Some ports throw on broken images. The image is skipped then, like
+        // images the port returns no data for.
+        std::unique_ptr<ImageData> image;
+        try
+        {
+            image = mRenderer.CreateImageData(
+                std::string{reinterpret_cast<const char*>(base64), size}, static_cast<ImageEncoding>(encoding));
+        }
+        catch (...)
+        {
+        }
+        mImages.push_back(std::move(image));
+        return true;
+    }
+
+    const Path* ReadPathIndex()
+    {
+        const std::uint32_t index = mReader.Varint();
+        if (!mReader.Ok() || index >= mPaths.size())
+            return nullptr;
+        return mPaths[index].get();
+    }
+
+    void ReadFloats(float* values, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            values[i] = mReader.Float();
+    }
+
+    std::shared_ptr<Transform> ReadTransform()
+    {
+        float v[6];
+        ReadFloats(v, 6);
+        return mRenderer.CreateTransform(v[0], v[1], v[2], v[3], v[4], v[5]);
+    }
+
+    bool ReadGraphic(GraphicStyle& graphicStyle)
+    {
+        const std::uint8_t flags = mReader.Byte();
+        graphicStyle.needsSave = (flags & kStreamGraphicNeedsSave) != 0;
+        if (flags & kStreamGraphicOpacity)
+            graphicStyle.opacity = mReader.Float();
+        if (flags & kStreamGraphicTransform)
+            graphicStyle.transform = ReadTransform();
+        if (flags & kStreamGraphicClip)
+        {
+            const std::uint8_t clipFlags = mReader.Byte();
+            std::shared_ptr<Path> path;
+            if (clipFlags & kStreamClipPath)
+            {
+                const std::uint32_t index = mReader.Varint();
+                if (!mReader.Ok() || index >= mPaths.size())
+                    return false;
+                path = mPaths[index];
+            }
+            std::shared_ptr<Transform> transform;
+            if (clipFlags & kStreamClipTransform)
+                transform = ReadTransform();
+            graphicStyle.clippingPath = std::make_shared<ClippingPath>((clipFlags & kStreamClipContent) != 0,
+                (clipFlags & kStreamClipEvenOdd) ? WindingRule::kEvenOdd : WindingRule::kNonZero, path, transform);
+            if (clipFlags & kStreamClipRect)
+            {
+                auto& clipRect = graphicStyle.clippingPath->clipRect;
+                graphicStyle.clippingPath->isRect = true;
+                clipRect.x = mReader.Float();
+                clipRect.y = mReader.Float();
+                clipRect.width = mReader.Float();
+                clipRect.height = mReader.Float();
+            }
+        }
+        return mReader.Ok();
+    }
+
+    bool ReadFill(FillStyle& fillStyle)
+    {
+        const std::uint8_t flags = mReader.Byte();
+        fillStyle.hasFill = (flags & kStreamFillEnabled) != 0;
+        fillStyle.fillRule = (flags & kStreamFillEvenOdd) ? WindingRule::kEvenOdd : WindingRule::kNonZero;
+        if (flags & kStreamFillOpacity)
+            fillStyle.fillOpacity = mReader.Float();
+        if (fillStyle.hasFill && !ReadPaint(fillStyle.paint))
+            return false;
+        return mReader.Ok();
+    }
+
+    bool ReadStroke(StrokeStyle& strokeStyle)
+    {
+        strokeStyle.hasStroke = mReader.Byte() != 0;
+        if (!strokeStyle.hasStroke)
+            return mReader.Ok();
+        strokeStyle.strokeOpacity = mReader.Float();
+        strokeStyle.lineWidth = mReader.Float();
+        const std::uint8_t lineCap = mReader.Byte();
+        const std::uint8_t lineJoin = mReader.Byte();
+        if (lineCap > static_cast<std::uint8_t>(LineCap::kSquare) || lineJoin > static_cast<std::uint8_t>(LineJoin::kBevel))
+            return false;
+        strokeStyle.lineCap = static_cast<LineCap>(lineCap);
+        strokeStyle.lineJoin = static_cast<LineJoin>(lineJoin);
+        strokeStyle.miterLimit = mReader.Float();
+        const std::uint32_t dashCount = mReader.Varint();
+        if (!mReader.Ok() || dashCount > mReader.Remaining() / 4)
+            return false;
+        strokeStyle.dashArray.resize(dashCount);
+        ReadFloats(strokeStyle.dashArray.data(), dashCount);
+        strokeStyle.dashOffset = mReader.Float();
+        return ReadPaint(strokeStyle.paint);
+    }
+
+    bool ReadPaint(Paint& paint)
+    {
+        const std::uint8_t kind = mReader.Byte();
+        if (kind == 0)
+        {
+            Color color;
+            ReadFloats(color.data(), 4);
+            paint = color;
+            return mReader.Ok();
+        }
+        if (kind != 1)
+            return false;
+
+        Gradient gradient;
+        const std::uint8_t type = mReader.Byte();
+        const std::uint8_t method = mReader.Byte();
+        const bool hasTransform = mReader.Byte() != 0;
+        const std::uint32_t stopCount = mReader.Varint();
+        if (!mReader.Ok() || type > static_cast<std::uint8_t>(GradientType::kRadialGradient)
+            || method > static_cast<std::uint8_t>(SpreadMethod::kRepeat) || stopCount > mReader.Remaining() / 20)
+            return false;
+        gradient.type = static_cast<GradientType>(type);
+        gradient.method = static_cast<SpreadMethod>(method);
+        gradient.colorStops.resize(stopCount);
+        for (auto& colorStop : gradient.colorStops)
+        {
+            colorStop.first = mReader.Float();
+            ReadFloats(colorStop.second.data(), 4);
+        }
+        if (gradient.type == GradientType::kLinearGradient)
+        {
+            gradient.x1 = mReader.Float();
+            gradient.y1 = mReader.Float();
+            gradient.x2 = mReader.Float();
+            gradient.y2 = mReader.Float();
+        }
+        else
+        {
+            gradient.cx = mReader.Float();
+            gradient.cy = mReader.Float();
+            gradient.fx = mReader.Float();
+            gradient.fy = mReader.Float();
+            gradient.r = mReader.Float();
+        }
+        if (hasTransform)
+            gradient.transform = ReadTransform();
+        paint = std::move(gradient);
+        return mReader.Ok();
+    }
+
+    StreamReader mReader;
+    SVGRenderer& mRenderer;
+    std::vector<std::shared_ptr<Path>> mPaths;
+    std::vector<std::unique_ptr<ImageData>> mImages;
+    size_t mSaveCount{};
+};
+} // namespace
+
+bool PlayStream(const std::uint8_t* data, std::size_t size, SVGRenderer& renderer)
+{
+    StreamPlayer player{data, size, renderer};
+    return player.Play();
+}
+
+} // namespace SVGNative
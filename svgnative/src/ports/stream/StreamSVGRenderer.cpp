@@ -0,0 +1,386 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "svgnative/ports/stream/StreamSVGRenderer.h"
+#include "svgnative/Rect.h"
+#include "Base64.h"
+#include "Matrix.h"
+#include "StreamFormat.h"
+
+#include <atomic>
+
+namespace SVGNative
+{
+
+namespace
+{
+std::uint64_t NextSerial()
+{
+    static std::atomic<std::uint64_t> serial{0};
+    return ++serial;
+}
+
+std::uint32_t ReadBigEndian(const std::string& data, size_t offset, size_t size)
+{
+    std::uint32_t value{};
+    for (size_t i = 0; i < size; ++i)
+        value = value << 8 | static_cast<std::uint8_t>(data[offset + i]);
+    return value;
+}
+
+// Reads the dimensions from the PNG or JPEG header, without decoding the
+// image.
+bool ImageSize(const std::string& data, ImageEncoding encoding, std::uint32_t& width, std::uint32_t& height)
+{
+    if (encoding == ImageEncoding::kPNG)
+    {
+        // Signature, then the IHDR chunk with width and height.
+        if (data.size() < 24 || data.compare(0, 8, "\x89PNG\r\n\x1a\n") || data.compare(12, 4, "IHDR"))
+            return false;
+        width = ReadBigEndian(data, 16, 4);
+        height = ReadBigEndian(data, 20, 4);
+        return true;
+    }
+
+    // Walk the JPEG segments up to the first start of frame.
+    if (data.size() < 4 || static_cast<std::uint8_t>(data[0]) != 0xff || static_cast<std::uint8_t>(data[1]) != 0xd8)
+        return false;
+    size_t position = 2;
+    while (position + 4 <= data.size())
+    {
+        if (static_cast<std::uint8_t>(data[position]) != 0xff)
+            return false;
+        const std::uint8_t marker = static_cast<std::uint8_t>(data[position + 1]);
+        if (marker == 0xff)
+        {
+            ++position;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd9))
+        {
+            position += 2;
+            continue;
+        }
+        const size_t length = ReadBigEndian(data, position + 2, 2);
+        const bool startOfFrame = marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc;
+        if (startOfFrame)
+        {
+            if (position + 9 > data.size())
+                return false;
+            height = ReadBigEndian(data, position + 5, 2);
+            width = ReadBigEndian(data, position + 7, 2);
+            return true;
+        }
+        position += 2 + length;
+    }
+    return false;
+}
+} // namespace
+
+StreamSVGPath::StreamSVGPath()
+    : mSerial{NextSerial()}
+{
+}
+
+void StreamSVGPath::Rect(float x, float y, float width, float height)
+{
+    mVerbs.push_back(StreamVerb::kRect);
+    mValues.insert(mValues.end(), {x, y, width, height});
+}
+
+void StreamSVGPath::RoundedRect(float x, float y, float width, float height, float rx, float ry)
+{
+    mVerbs.push_back(StreamVerb::kRoundedRect);
+    mValues.insert(mValues.end(), {x, y, width, height, rx, ry});
+}
+
+void StreamSVGPath::Ellipse(float cx, float cy, float rx, float ry)
+{
+    mVerbs.push_back(StreamVerb::kEllipse);
+    mValues.insert(mValues.end(), {cx, cy, rx, ry});
+}
+
+void StreamSVGPath::MoveTo(float x, float y)
+{
+    mVerbs.push_back(StreamVerb::kMoveTo);
+    mValues.insert(mValues.end(), {x, y});
+}
+
+void StreamSVGPath::LineTo(float x, float y)
+{
+    mVerbs.push_back(StreamVerb::kLineTo);
+    mValues.insert(mValues.end(), {x, y});
+}
+
+void StreamSVGPath::CurveTo(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    mVerbs.push_back(StreamVerb::kCurveTo);
+    mValues.insert(mValues.end(), {x1, y1, x2, y2, x3, y3});
+}
+
+void StreamSVGPath::CurveToV(float x2, float y2, float x3, float y3)
+{
+    mVerbs.push_back(StreamVerb::kCurveToV);
+    mValues.insert(mValues.end(), {x2, y2, x3, y3});
+}
+
+void StreamSVGPath::ClosePath()
+{
+    mVerbs.push_back(StreamVerb::kClosePath);
+}
+
+StreamSVGImageData::StreamSVGImageData(const std::string& base64, ImageEncoding encoding)
+    : mBase64{base64}
+    , mEncoding{encoding}
+    , mSerial{NextSerial()}
+{
+    std::string data;
+    std::uint32_t width{}, height{};
+    if (DecodeBase64(base64, data) && ImageSize(data, encoding, width, height))
+    {
+        mWidth = static_cast<float>(width);
+        mHeight = static_cast<float>(height);
+    }
+}
+
+StreamSVGRenderer::StreamSVGRenderer()
+{
+    Clear();
+}
+
+std::unique_ptr<ImageData> StreamSVGRenderer::CreateImageData(const std::string& base64, ImageEncoding encoding)
+{
+    return std::unique_ptr<StreamSVGImageData>(new StreamSVGImageData(base64, encoding));
+}
+
+std::unique_ptr<Path> StreamSVGRenderer::CreatePath()
+{
+    return std::unique_ptr<StreamSVGPath>(new StreamSVGPath);
+}
+
+std::unique_ptr<Transform> StreamSVGRenderer::CreateTransform(float a, float b, float c, float d, float tx, float ty)
+{
+    return std::unique_ptr<Matrix>(new Matrix(a, b, c, d, tx, ty));
+}
+
+void StreamSVGRenderer::Clear()
+{
+    mStream.clear();
+    mPathIndices.clear();
+    mImageIndices.clear();
+    StreamWriter writer{mStream};
+    writer.Bytes(kStreamMagic, sizeof(kStreamMagic));
+    writer.Byte(kStreamVersion);
+}
+
+void StreamSVGRenderer::Save(const GraphicStyle& graphicStyle)
+{
+    DefineClippingPath(graphicStyle);
+    StreamWriter{mStream}.Byte(static_cast<std::uint8_t>(StreamOp::kSave));
+    WriteGraphic(graphicStyle);
+}
+
+void StreamSVGRenderer::Restore()
+{
+    StreamWriter{mStream}.Byte(static_cast<std::uint8_t>(StreamOp::kRestore));
+}
+
+void StreamSVGRenderer::DrawPath(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle)
+{
+    DefineClippingPath(graphicStyle);
+    const std::uint32_t index = PathIndex(path);
+    StreamWriter writer{mStream};
+    writer.Byte(static_cast<std::uint8_t>(StreamOp::kDrawPath));
+    WriteGraphic(graphicStyle);
+    writer.Varint(index);
+    WriteFill(fillStyle);
+    WriteStroke(strokeStyle);
+}
+
+void StreamSVGRenderer::DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea)
+{
+    DefineClippingPath(graphicStyle);
+    const std::uint32_t index = ImageIndex(image);
+    StreamWriter writer{mStream};
+    writer.Byte(static_cast<std::uint8_t>(StreamOp::kDrawImage));
+    WriteGraphic(graphicStyle);
+    writer.Varint(index);
+    const float areas[8] = {clipArea.x, clipArea.y, clipArea.width, clipArea.height, fillArea.x, fillArea.y, fillArea.width, fillArea.height};
+    writer.Floats(areas, 8);
+}
+
+std::uint32_t StreamSVGRenderer::PathIndex(const Path& path)
+{
+    const auto& streamPath = static_cast<const StreamSVGPath&>(path);
+    auto result = mPathIndices.emplace(streamPath.mSerial, static_cast<std::uint32_t>(mPathIndices.size()));
+    if (result.second)
+    {
+        StreamWriter writer{mStream};
+        writer.Byte(static_cast<std::uint8_t>(StreamOp::kDefinePath));
+        writer.Varint(static_cast<std::uint32_t>(streamPath.mVerbs.size()));
+        writer.Bytes(streamPath.mVerbs.data(), streamPath.mVerbs.size());
+        writer.Varint(static_cast<std::uint32_t>(streamPath.mValues.size()));
+        writer.Floats(streamPath.mValues.data(), streamPath.mValues.size());
+    }
+    return result.first->second;
+}
+
+std::uint32_t StreamSVGRenderer::ImageIndex(const ImageData& image)
+{
+    const auto& streamImage = static_cast<const StreamSVGImageData&>(image);
+    auto result = mImageIndices.emplace(streamImage.mSerial, static_cast<std::uint32_t>(mImageIndices.size()));
+    if (result.second)
+    {
+        StreamWriter writer{mStream};
+        writer.Byte(static_cast<std::uint8_t>(StreamOp::kDefineImage));
+        writer.Byte(static_cast<std::uint8_t>(streamImage.mEncoding));
+        writer.Float(streamImage.mWidth);
+        writer.Float(streamImage.mHeight);
+        writer.Varint(static_cast<std::uint32_t>(streamImage.mBase64.size()));
+        writer.Bytes(streamImage.mBase64.data(), streamImage.mBase64.size());
+    }
+    return result.first->second;
+}
+
+void StreamSVGRenderer::DefineClippingPath(const GraphicStyle& graphicStyle)
+{
+    // Definitions must not end up in the middle of a command.
+    if (graphicStyle.clippingPath && graphicStyle.clippingPath->path)
+        PathIndex(*graphicStyle.clippingPath->path);
+}
+
+void StreamSVGRenderer::WriteGraphic(const GraphicStyle& graphicStyle)
+{
+    const auto& clippingPath = graphicStyle.clippingPath;
+    std::uint8_t flags{};
+    if (graphicStyle.needsSave)
+        flags |= kStreamGraphicNeedsSave;
+    if (graphicStyle.opacity != 1)
+        flags |= kStreamGraphicOpacity;
+    if (graphicStyle.transform)
+        flags |= kStreamGraphicTransform;
+    if (clippingPath)
+        flags |= kStreamGraphicClip;
+
+    StreamWriter writer{mStream};
+    writer.Byte(flags);
+    if (flags & kStreamGraphicOpacity)
+        writer.Float(graphicStyle.opacity);
+    if (graphicStyle.transform)
+        WriteTransform(*graphicStyle.transform);
+    if (!clippingPath)
+        return;
+
+    std::uint8_t clipFlags{};
+    if (clippingPath->hasClipContent)
+        clipFlags |= kStreamClipContent;
+    if (clippingPath->clipRule == WindingRule::kEvenOdd)
+        clipFlags |= kStreamClipEvenOdd;
+    if (clippingPath->path)
+        clipFlags |= kStreamClipPath;
+    if (clippingPath->transform)
+        clipFlags |= kStreamClipTransform;
+    if (clippingPath->isRect)
+        clipFlags |= kStreamClipRect;
+    writer.Byte(clipFlags);
+    if (clippingPath->path)
+        writer.Varint(PathIndex(*clippingPath->path));
+    if (clippingPath->transform)
+        WriteTransform(*clippingPath->transform);
+    if (clippingPath->isRect)
+    {
+        const auto& clipRect = clippingPath->clipRect;
+        writer.Float(clipRect.x);
+        writer.Float(clipRect.y);
+        writer.Float(clipRect.width);
+        writer.Float(clipRect.height);
+    }
+}
+
+void StreamSVGRenderer::WriteFill(const FillStyle& fillStyle)
+{
+    std::uint8_t flags{};
+    if (fillStyle.hasFill)
+        flags |= kStreamFillEnabled;
+    if (fillStyle.fillRule == WindingRule::kEvenOdd)
+        flags |= kStreamFillEvenOdd;
+    if (fillStyle.fillOpacity != 1)
+        flags |= kStreamFillOpacity;
+
+    StreamWriter writer{mStream};
+    writer.Byte(flags);
+    if (flags & kStreamFillOpacity)
+        writer.Float(fillStyle.fillOpacity);
+    if (fillStyle.hasFill)
+        WritePaint(fillStyle.paint);
+}
+
+void StreamSVGRenderer::WriteStroke(const StrokeStyle& strokeStyle)
+{
+    StreamWriter writer{mStream};
+    writer.Byte(strokeStyle.hasStroke ? 1 : 0);
+    if (!strokeStyle.hasStroke)
+        return;
+    writer.Float(strokeStyle.strokeOpacity);
+    writer.Float(strokeStyle.lineWidth);
+    writer.Byte(static_cast<std::uint8_t>(strokeStyle.lineCap));
+    writer.Byte(static_cast<std::uint8_t>(strokeStyle.lineJoin));
+    writer.Float(strokeStyle.miterLimit);
+    writer.Varint(static_cast<std::uint32_t>(strokeStyle.dashArray.size()));
+    writer.Floats(strokeStyle.dashArray.data(), strokeStyle.dashArray.size());
+    writer.Float(strokeStyle.dashOffset);
+    WritePaint(strokeStyle.paint);
+}
+
+void StreamSVGRenderer::WritePaint(const Paint& paint)
+{
+    StreamWriter writer{mStream};
+    if (SVGNative::holds_alternative<Color>(paint))
+    {
+        writer.Byte(0);
+        writer.Floats(SVGNative::get<Color>(paint).data(), 4);
+        return;
+    }
+
+    const auto& gradient = SVGNative::get<Gradient>(paint);
+    writer.Byte(1);
+    writer.Byte(static_cast<std::uint8_t>(gradient.type));
+    writer.Byte(static_cast<std::uint8_t>(gradient.method));
+    writer.Byte(gradient.transform ? 1 : 0);
+    writer.Varint(static_cast<std::uint32_t>(gradient.colorStops.size()));
+    for (const auto& colorStop : gradient.colorStops)
+    {
+        writer.Float(colorStop.first);
+        writer.Floats(colorStop.second.data(), 4);
+    }
+    if (gradient.type == GradientType::kLinearGradient)
+    {
+        const float values[4] = {gradient.x1, gradient.y1, gradient.x2, gradient.y2};
+        writer.Floats(values, 4);
+    }
+    else
+    {
+        const float values[5] = {gradient.cx, gradient.cy, gradient.fx, gradient.fy, gradient.r};
+        writer.Floats(values, 5);
+    }
+    if (gradient.transform)
+        WriteTransform(*gradient.transform);
+}
+
+void StreamSVGRenderer::WriteTransform(const Transform& transform)
+{
+    const auto& matrix = static_cast<const Matrix&>(transform);
+    const float values[6] = {matrix.a, matrix.b, matrix.c, matrix.d, matrix.e, matrix.f};
+    StreamWriter{mStream}.Floats(values, 6);
+}
+
+} // namespace SVGNative
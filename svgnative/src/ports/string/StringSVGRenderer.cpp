@@ -175,6 +175,12 @@ void StringSVGRenderer::DrawImage(const ImageData& image, const GraphicStyle& gr
 
 std::string StringSVGRenderer::String() const { return mStringStream.str(); }
 
+void StringSVGRenderer::Clear()
+{
+    mStringStream.str(std::string{});
+    mIndent = 0;
+}
+
 void StringSVGRenderer::IncIndent() { mIndent += 4; }
 
 void StringSVGRenderer::DecIndent() { mIndent -= 4; }
@@ -0,0 +1,235 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include "SVGParserArcToCurve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace SVGNative;
+
+namespace
+{
+class CurvePath final : public Path
+{
+public:
+    void Rect(float, float, float, float) override {}
+    void RoundedRect(float, float, float, float, float, float) override {}
+    void Ellipse(float, float, float, float) override {}
+    void MoveTo(float, float) override {}
+    void LineTo(float x, float y) override { lines.insert(lines.end(), {x, y}); }
+    void CurveTo(float x1, float y1, float x2, float y2, float x3, float y3) override
+    {
+        curves.insert(curves.end(), {x1, y1, x2, y2, x3, y3});
+    }
+    void CurveToV(float, float, float, float) override {}
+    void ClosePath() override {}
+
+    std::vector<float> lines;
+    std::vector<float> curves;
+};
+
+struct Arc
+{
+    float startX, startY, radiusX, radiusY, angle;
+    bool large, sweep;
+    float endX, endY;
+};
+
+struct Ellipse
+{
+    double centerX, centerY, radiusX, radiusY, phi;
+};
+
+// Straightforward conversion along the SVG implementation notes, with sine
+// and cosine evaluated for every point.
+Ellipse ReferenceArcToCurve(const Arc& arc, std::vector<double>& curves)
+{
+    const double pi = std::acos(-1.0);
+    const double phi = arc.angle * pi / 180;
+    double rx = std::abs(arc.radiusX);
+    double ry = std::abs(arc.radiusY);
+    const double dx = (arc.startX - static_cast<double>(arc.endX)) / 2;
+    const double dy = (arc.startY - static_cast<double>(arc.endY)) / 2;
+    const double x1 = std::cos(phi) * dx + std::sin(phi) * dy;
+    const double y1 = -std::sin(phi) * dx + std::cos(phi) * dy;
+    const double lambda = x1 * x1 / (rx * rx) + y1 * y1 / (ry * ry);
+    if (lambda > 1)
+    {
+        rx *= std::sqrt(lambda);
+        ry *= std::sqrt(lambda);
+    }
+    const double numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    const double denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    const double sign = arc.large == arc.sweep ? -1 : 1;
+    const double k = sign * std::sqrt(std::max(0.0, numerator / denominator));
+    const double cx1 = k * rx * y1 / ry;
+    const double cy1 = -k * ry * x1 / rx;
+    Ellipse ellipse{std::cos(phi) * cx1 - std::sin(phi) * cy1 + (arc.startX + static_cast<double>(arc.endX)) / 2,
+        std::sin(phi) * cx1 + std::cos(phi) * cy1 + (arc.startY + static_cast<double>(arc.endY)) / 2, rx, ry, phi};
+
+    auto angleBetween = [](double ux, double uy, double vx, double vy) {
+        const double angle = std::acos(std::max(-1.0, std::min(1.0, (ux * vx + uy * vy) / std::hypot(ux, uy) / std::hypot(vx, vy))));
+        return ux * vy - uy * vx < 0 ? -angle : angle;
+    };
+    const double theta = angleBetween(1, 0, (x1 - cx1) / rx, (y1 - cy1) / ry);
+    double delta = angleBetween((x1 - cx1) / rx, (y1 - cy1) / ry, (-x1 - cx1) / rx, (-y1 - cy1) / ry);
+    if (arc.sweep && delta < 0)
+        delta += 2 * pi;
+    if (!arc.sweep && delta > 0)
+        delta -= 2 * pi;
+
+    auto point = [&](double t, double& x, double& y, double dxdt, double dydt) {
+        const double ex = rx * (std::cos(t) + dxdt);
+        const double ey = ry * (std::sin(t) + dydt);
+        x = ellipse.centerX + std::cos(phi) * ex - std::sin(phi) * ey;
+        y = ellipse.centerY + std::sin(phi) * ex + std::cos(phi) * ey;
+    };
+    const int segments = std::max(1, static_cast<int>(std::ceil(std::abs(delta) / (pi / 2) - 1e-3)));
+    const double step = delta / segments;
+    const double handle = 4.0 / 3.0 * std::tan(step / 4);
+    for (int i = 0; i < segments; ++i)
+    {
+        const double t0 = theta + i * step;
+        const double t1 = t0 + step;
+        double p[6];
+        point(t0, p[0], p[1], -handle * std::sin(t0), handle * std::cos(t0));
+        point(t1, p[2], p[3], handle * std::sin(t1), -handle * std::cos(t1));
+        point(t1, p[4], p[5], 0, 0);
+        curves.insert(curves.end(), p, p + 6);
+    }
+    return ellipse;
+}
+
+// Distance of a point from the ellipse along the radius.
+double RadialError(const Ellipse& ellipse, double x, double y)
+{
+    const double dx = x - ellipse.centerX;
+    const double dy = y - ellipse.centerY;
+    const double ux = (std::cos(ellipse.phi) * dx + std::sin(ellipse.phi) * dy) / ellipse.radiusX;
+    const double uy = (-std::sin(ellipse.phi) * dx + std::cos(ellipse.phi) * dy) / ellipse.radiusY;
+    return std::abs(std::hypot(ux, uy) - 1) * std::max(ellipse.radiusX, ellipse.radiusY);
+}
+
+std::vector<Arc> RandomArcs(size_t count)
+{
+    std::mt19937 random{45};
+    std::uniform_real_distribution<float> coordinate{-100, 100};
+    std::uniform_real_distribution<float> radius{0.5f, 120};
+    std::uniform_real_distribution<float> angle{-360, 360};
+    std::vector<Arc> arcs;
+    for (size_t i = 0; i < count; ++i)
+    {
+        arcs.push_back(Arc{coordinate(random), coordinate(random), radius(random), radius(random), angle(random),
+            (i & 1) != 0, (i & 2) != 0, coordinate(random), coordinate(random)});
+    }
+    return arcs;
+}
+} // namespace
+
+TEST(arc_to_curve_tests, arc_to_curve_reference_test)
+{
+    for (const auto& arc : RandomArcs(1000))
+    {
+        CurvePath path;
+        float endControlX{}, endControlY{};
+        ArcToCurve(path, arc.startX, arc.startY, arc.radiusX, arc.radiusY, arc.angle, arc.large, arc.sweep, arc.endX, arc.endY,
+            endControlX, endControlY);
+        std::vector<double> expected;
+        const Ellipse ellipse = ReferenceArcToCurve(arc, expected);
+        ASSERT_EQ(path.curves.size(), expected.size());
+        const double tolerance = 1e-5 * (100 + std::max(ellipse.radiusX, ellipse.radiusY));
+        for (size_t i = 0; i < expected.size(); ++i)
+            EXPECT_NEAR(path.curves[i], expected[i], tolerance);
+        EXPECT_EQ(path.curves[path.curves.size() - 2], arc.endX);
+        EXPECT_EQ(path.curves.back(), arc.endY);
+        EXPECT_EQ(endControlX, path.curves[path.curves.size() - 4]);
+        EXPECT_EQ(endControlY, path.curves[path.curves.size() - 3]);
+    }
+}
+
+TEST(arc_to_curve_tests, arc_to_curve_error_bound_test)
+{
+    double maxError{};
+    for (const auto& arc : RandomArcs(1000))
+    {
+        CurvePath path;
+        float endControlX{}, endControlY{};
+        ArcToCurve(path, arc.startX, arc.startY, arc.radiusX, arc.radiusY, arc.angle, arc.large, arc.sweep, arc.endX, arc.endY,
+            endControlX, endControlY);
+        std::vector<double> unused;
+        const Ellipse ellipse = ReferenceArcToCurve(arc, unused);
+        const double radius = std::max(ellipse.radiusX, ellipse.radiusY);
+        double x0 = arc.startX, y0 = arc.startY;
+        for (size_t i = 0; i < path.curves.size(); i += 6)
+        {
+            const float* p = &path.curves[i];
+            for (int step = 0; step <= 32; ++step)
+            {
+                const double t = step / 32.0;
+                const double s = 1 - t;
+                const double x = s * s * s * x0 + 3 * s * s * t * p[0] + 3 * s * t * t * p[2] + t * t * t * p[4];
+                const double y = s * s * s * y0 + 3 * s * s * t * p[1] + 3 * s * t * t * p[3] + t * t * t * p[5];
+                // Allow for float rounding of the coordinates.
+                const double error = RadialError(ellipse, x, y) - 1e-5 * (100 + radius);
+                maxError = std::max(maxError, error / radius);
+            }
+            x0 = p[4];
+            y0 = p[5];
+        }
+    }
+    EXPECT_LE(maxError, kArcToCurveMaxError);
+}
+
+TEST(arc_to_curve_tests, arc_to_curve_rotation_test)
+{
+    // A rotated circle is the same circle.
+    CurvePath circle, rotatedCircle;
+    float x{}, y{};
+    ArcToCurve(circle, 0, 0, 10, 10, 0, false, true, 20, 0, x, y);
+    ArcToCurve(rotatedCircle, 0, 0, 10, 10, 37, false, true, 20, 0, x, y);
+    ASSERT_EQ(circle.curves.size(), rotatedCircle.curves.size());
+    for (size_t i = 0; i < circle.curves.size(); ++i)
+        EXPECT_NEAR(circle.curves[i], rotatedCircle.curves[i], 1e-4);
+
+    // Rotating by 90° swaps the radii.
+    CurvePath ellipse, rotatedEllipse;
+    ArcToCurve(ellipse, 0, 0, 5, 20, 0, true, false, 0, 40, x, y);
+    ArcToCurve(rotatedEllipse, 0, 0, 20, 5, 90, true, false, 0, 40, x, y);
+    ASSERT_EQ(ellipse.curves.size(), rotatedEllipse.curves.size());
+    for (size_t i = 0; i < ellipse.curves.size(); ++i)
+        EXPECT_NEAR(ellipse.curves[i], rotatedEllipse.curves[i], 1e-4);
+}
+
+TEST(arc_to_curve_tests, arc_to_curve_degenerate_test)
+{
+    float x{}, y{};
+    // Equal end points draw nothing.
+    CurvePath empty;
+    ArcToCurve(empty, 5, 5, 10, 10, 0, true, true, 5, 5, x, y);
+    EXPECT_TRUE(empty.curves.empty());
+    EXPECT_TRUE(empty.lines.empty());
+    // Zero radii draw a line.
+    CurvePath line;
+    ArcToCurve(line, 0, 0, 0, 10, 0, true, true, 5, 5, x, y);
+    EXPECT_TRUE(line.curves.empty());
+    EXPECT_EQ(line.lines, (std::vector<float>{5, 5}));
+    // Negative radii count as positive.
+    CurvePath positive, negative;
+    ArcToCurve(positive, 0, 0, 10, 20, 15, false, true, 10, 5, x, y);
+    ArcToCurve(negative, 0, 0, -10, -20, 15, false, true, 10, 5, x, y);
+    EXPECT_EQ(positive.curves, negative.curves);
+}
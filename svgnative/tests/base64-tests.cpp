@@ -0,0 +1,122 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+
+#include "gtest/gtest.h"
+
+#include "Base64.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace SVGNative;
+
+static std::string Encode(const std::vector<std::uint8_t>& data, size_t lineLength = 0)
+{
+    const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string base64;
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        std::uint32_t bits = data[i] << 16;
+        if (i + 1 < data.size())
+            bits |= data[i + 1] << 8;
+        if (i + 2 < data.size())
+            bits |= data[i + 2];
+        base64 += alphabet[(bits >> 18) & 63];
+        base64 += alphabet[(bits >> 12) & 63];
+        base64 += i + 1 < data.size() ? alphabet[(bits >> 6) & 63] : '=';
+        base64 += i + 2 < data.size() ? alphabet[bits & 63] : '=';
+    }
+    if (!lineLength)
+        return base64;
+    std::string lines;
+    for (size_t i = 0; i < base64.size(); i += lineLength)
+        lines += base64.substr(i, lineLength) + "\n";
+    return lines;
+}
+
+static std::vector<std::uint8_t> RandomBytes(size_t size, std::mt19937& random)
+{
+    std::vector<std::uint8_t> data(size);
+    for (auto& byte : data)
+        byte = static_cast<std::uint8_t>(random());
+    return data;
+}
+
+static bool Decode(const std::string& base64, std::vector<std::uint8_t>& data)
+{
+    // Exactly the documented buffer size, so that overruns get caught by
+    // sanitizers.
+    data.resize(DecodedBase64Size(base64.size()));
+    size_t size{};
+    const bool result = DecodeBase64(base64.data(), base64.size(), data.data(), size);
+    EXPECT_LE(size, data.size());
+    data.resize(size);
+    return result;
+}
+
+TEST(base64_tests, base64_round_trip_test)
+{
+    std::mt19937 random{42};
+    for (size_t size = 0; size < 300; ++size)
+    {
+        const auto expected = RandomBytes(size, random);
+        std::vector<std::uint8_t> data;
+        EXPECT_TRUE(Decode(Encode(expected), data)) << size;
+        EXPECT_EQ(data, expected) << size;
+        // Line breaks as in MIME encoded data and unaligned lines.
+        EXPECT_TRUE(Decode(Encode(expected, 76), data)) << size;
+        EXPECT_EQ(data, expected) << size;
+        EXPECT_TRUE(Decode(Encode(expected, 17), data)) << size;
+        EXPECT_EQ(data, expected) << size;
+    }
+}
+
+TEST(base64_tests, base64_unpadded_test)
+{
+    std::vector<std::uint8_t> data;
+    EXPECT_TRUE(Decode("TWFu", data));
+    EXPECT_EQ(std::string(data.begin(), data.end()), "Man");
+    EXPECT_TRUE(Decode("TWE", data));
+    EXPECT_EQ(std::string(data.begin(), data.end()), "Ma");
+    EXPECT_TRUE(Decode("TQ", data));
+    EXPECT_EQ(std::string(data.begin(), data.end()), "M");
+    EXPECT_TRUE(Decode(" T W\tE = garbage", data));
+    EXPECT_EQ(std::string(data.begin(), data.end()), "Ma");
+    EXPECT_TRUE(Decode("", data));
+    EXPECT_TRUE(data.empty());
+}
+
+TEST(base64_tests, base64_invalid_test)
+{
+    std::mt19937 random{7};
+    const std::string base64 = Encode(RandomBytes(120, random));
+    for (size_t i = 0; i < 160; ++i)
+    {
+        std::string invalid = base64;
+        for (char c : {'-', '_', '.', '\x80', '\0', '*'})
+        {
+            invalid[i] = c;
+            std::vector<std::uint8_t> data;
+            EXPECT_FALSE(Decode(invalid, data)) << i << " " << static_cast<int>(c);
+        }
+    }
+}
+
+TEST(base64_tests, base64_string_test)
+{
+    std::string data;
+    EXPECT_TRUE(DecodeBase64(std::string{"SGVsbG8sIFdvcmxkIQ=="}, data));
+    EXPECT_EQ(data, "Hello, World!");
+    EXPECT_FALSE(DecodeBase64(std::string{"SGVs#bG8"}, data));
+}
@@ -0,0 +1,232 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include <fstream>
+#include <iostream>
+#include <tuple>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "gtest/gtest-spi.h"
+
+#include <svgnative/SVGRenderer.h>
+#include <svgnative/SVGDocument.h>
+#include <svgnative/Rect.h>
+#include <svgnative/ports/string/StringSVGRenderer.h>
+
+using namespace SVGNative;
+
+// Bounds are computed by the core. The String port has no canvas at all.
+static std::unique_ptr<SVGDocument> CreateDocument(const std::string& svg)
+{
+    return SVGDocument::CreateSVGDocument(svg.c_str(), std::make_shared<StringSVGRenderer>());
+}
+
+static std::string Svg(const std::string& content)
+{
+    return "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 1000 1000'>"
+        + content + "</svg>";
+}
+
+TEST(core_bounds_tests, core_bounds_cubic_extrema_test)
+{
+    // The control points reach y = 0, the curve only y = 25.
+    auto doc = CreateDocument(Svg("<path d='M0,100 C0,0 100,0 100,100'/>"));
+    Rect bounds;
+    EXPECT_TRUE(doc->GetBoundingBox(bounds));
+    EXPECT_FLOAT_EQ(bounds.x, 0);
+    EXPECT_FLOAT_EQ(bounds.y, 25);
+    EXPECT_FLOAT_EQ(bounds.width, 100);
+    EXPECT_FLOAT_EQ(bounds.height, 75);
+}
+
+TEST(core_bounds_tests, core_bounds_quadratic_extrema_test)
+{
+    auto doc = CreateDocument(Svg("<path d='M0,100 Q50,0 100,100'/>"));
+    Rect bounds;
+    EXPECT_TRUE(doc->GetBoundingBox(bounds));
+    EXPECT_FLOAT_EQ(bounds.y, 50);
+    EXPECT_FLOAT_EQ(bounds.height, 50);
+}
+
+TEST(core_bounds_tests, core_bounds_stroke_test)
+{
+    auto doc = CreateDocument(Svg(
+        "<rect id='miter' x='100' y='100' width='100' height='100' stroke='black' stroke-width='10' stroke-miterlimit='2'/>"
+        "<rect id='round' x='100' y='100' width='100' height='100' stroke='black' stroke-width='10' stroke-linejoin='round'/>"
+        "<rect id='none' x='100' y='100' width='100' height='100' stroke-width='10'/>"));
+    Rect bounds;
+    EXPECT_TRUE(doc->GetBoundingBox("miter", bounds));
+    EXPECT_FLOAT_EQ(bounds.x, 90);
+    EXPECT_FLOAT_EQ(bounds.width, 120);
+    EXPECT_TRUE(doc->GetBoundingBox("round", bounds));
+    EXPECT_FLOAT_EQ(bounds.x, 95);
+    EXPECT_FLOAT_EQ(bounds.width, 110);
+    EXPECT_TRUE(doc->GetBoundingBox("none", bounds));
+    EXPECT_FLOAT_EQ(bounds.x, 100);
+    EXPECT_FLOAT_EQ(bounds.width, 100);
+}
+
+TEST(core_bounds_tests, core_bounds_clip_and_transform_test)
+{
+    auto doc = CreateDocument(Svg(
+        "<clipPath id='clip'><rect x='150' y='0' width='1000' height='1000'/></clipPath>"
+        "<g id='group' transform='translate(10 20) scale(2)'>"
+        "<rect x='100' y='100' width='100' height='100' clip-path='url(#clip)'/></g>"));
+    Rect bounds;
+    EXPECT_TRUE(doc->GetBoundingBox("group", bounds));
+    EXPECT_FLOAT_EQ(bounds.x, 310);
+    EXPECT_FLOAT_EQ(bounds.y, 220);
+    EXPECT_FLOAT_EQ(bounds.width, 100);
+    EXPECT_FLOAT_EQ(bounds.height, 200);
+}
+
+TEST(core_bounds_tests, core_bounds_batch_test)
+{
+    auto doc = CreateDocument(Svg(
+        "<defs><rect id='a' width='10' height='10'/></defs>"
+        "<use id='b' xlink:href='#a' x='100' y='100'/>"
+        "<use id='c' xlink:href='#b' x='100' y='100'/>"));
+    std::vector<Rect> bounds;
+    EXPECT_FALSE(doc->GetBoundingBoxes({"a", "b", "c", "missing"}, bounds));
+    ASSERT_EQ(bounds.size(), 4u);
+    EXPECT_EQ(bounds[0], Rect(0, 0, 10, 10));
+    EXPECT_EQ(bounds[1], Rect(100, 100, 10, 10));
+    EXPECT_EQ(bounds[2], Rect(200, 200, 10, 10));
+    EXPECT_EQ(bounds[3], Rect(0, 0, 0, 0));
+
+    // Repeated calls do not accumulate.
+    Rect first, second;
+    doc->GetBoundingBox("b", first);
+    doc->GetBoundingBox("a", second);
+    doc->GetBoundingBox("b", second);
+    EXPECT_EQ(first, second);
+}
+
+TEST(core_bounds_tests, core_bounds_cycle_test)
+{
+    // The <use> that closes the cycle is cut after parsing and draws
+    // nothing.
+    auto doc = CreateDocument(Svg(
+        "<g id='group'><rect width='10' height='10'/><use xlink:href='#group' x='100'/></g>"));
+    Rect bounds;
+    EXPECT_TRUE(doc->GetBoundingBox("group", bounds));
+    EXPECT_EQ(bounds, Rect(0, 0, 10, 10));
+    // The root group, the <svg> group, the group, the rectangle and the cut
+    // <use>.
+    EXPECT_EQ(doc->GetRenderStats().expandedElements, 5u);
+
+    // The cycle enters the inner group through a <use> and returns to it
+    // through its parent.
+    doc = CreateDocument(Svg("<use xlink:href='#inner'/>"
+        "<g id='outer'><rect width='10' height='10'/><g id='inner'><use xlink:href='#outer' x='100'/></g></g>"));
+    EXPECT_TRUE(doc->GetBoundingBox(bounds));
+    EXPECT_EQ(bounds, Rect(0, 0, 10, 10));
+    // Only the <use> of the inner group draws.
+    doc->Render();
+    EXPECT_EQ(doc->GetRenderStats().referencesTraversed, 1u);
+
+    // Shared content is expanded once per <use>.
+    doc = CreateDocument(Svg("<defs><g id='a'><rect width='1' height='1'/><rect width='1' height='1'/></g>"
+        "<g id='b'><use xlink:href='#a'/><use xlink:href='#a'/></g></defs>"
+        "<use xlink:href='#b'/><use xlink:href='#b'/>"));
+    const size_t a = 3;
+    const size_t b = 1 + 2 * (1 + a);
+    EXPECT_EQ(doc->GetRenderStats().expandedElements, 2 + 2 * (1 + b));
+}
+
+// The test data lives in the source directory, passed in by CMake.
+TEST(core_bounds_tests, core_bounds_functional_test)
+{
+    const std::string testsDir{SVGNATIVE_TESTS_DIR};
+    std::fstream filenames_file;
+    std::fstream bounds_file;
+    filenames_file.open(testsDir + "/svg-filenames.txt");
+    bounds_file.open(testsDir + "/svg-bounds.txt");
+    if (!filenames_file || !bounds_file)
+    {
+        std::cout << "Error! Could not open input file." << std::endl;
+        FAIL();
+    }
+    std::string filename;
+    std::string bounds_line;
+    std::vector<std::tuple<std::string, Rect>> svg_documents_bounds;
+    while(std::getline(filenames_file, filename))
+    {
+        if (filename == "")
+            break;
+        std::getline(bounds_file, bounds_line);
+        float x, y, width, height;
+        sscanf(bounds_line.c_str(), "%f,%f,%f,%f", &x, &y, &width, &height);
+        svg_documents_bounds.push_back(std::tuple<std::string, Rect>(filename, Rect{x, y, width, height}));
+    }
+    filenames_file.close();
+    bounds_file.close();
+    for(auto const& item: svg_documents_bounds)
+    {
+        std::string line = std::get<0>(item);
+        Rect standard_bounds = std::get<1>(item);
+
+        bool bounds_of_group = false;
+        auto loc = line.find_first_of(",");
+        std::string filename = line;
+        std::string id;
+        if (loc != std::string::npos)
+        {
+            filename = line.substr(0, loc);
+            id = line.substr(loc + 2, std::string::npos);
+            bounds_of_group = true;
+        }
+
+        std::string full_file_path = testsDir + "/bound-tests-svgs/" + filename;
+        std::string svgInput{};
+        std::ifstream input(full_file_path);
+        if (!input)
+        {
+            std::cout << "Error! Could not open input file." << std::endl;
+            FAIL();
+        }
+        for (std::string line; std::getline(input, line);)
+            svgInput.append(line);
+        input.close();
+        auto doc = CreateDocument(svgInput);
+        ASSERT_TRUE(doc != nullptr);
+        Rect bounds;
+        if (bounds_of_group)
+            doc->GetBoundingBox(id.c_str(), bounds);
+        else
+            doc->GetBoundingBox(bounds);
+        EXPECT_EQ((bounds.IsEmpty() && !standard_bounds.IsEmpty()) ||
+                  (!bounds.IsEmpty() && standard_bounds.IsEmpty()), false);
+        if (bounds.IsEmpty() && standard_bounds.IsEmpty())
+            continue;
+        float diff = bounds.MaxDiffVertex(standard_bounds);
+        diff = diff / (std::max(standard_bounds.width, standard_bounds.height));
+        if (diff >= 0.1)
+        {
+            const int buffer = 2;
+            bounds.x -= buffer;
+            bounds.y -= buffer;
+            bounds.width += buffer * 2;
+            bounds.height += buffer * 2;
+            if (!bounds.Contains(standard_bounds))
+            {
+                printf("%s, %f, FAIL\n", line.c_str(), diff);
+                printf("standard: %f %f %f %f\n", standard_bounds.x, standard_bounds.y, standard_bounds.width, standard_bounds.height);
+                printf("calculated: %f %f %f %f\n", bounds.x, bounds.y, bounds.width, bounds.height);
+                ADD_FAILURE();
+            }
+        }
+    }
+}
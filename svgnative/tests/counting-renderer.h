@@ -0,0 +1,98 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#ifndef SVGViewer_CountingRenderer_h
+#define SVGViewer_CountingRenderer_h
+
+#include <svgnative/SVGRenderer.h>
+#include <svgnative/Rect.h>
+#include <svgnative/ports/string/StringSVGRenderer.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+namespace SVGNative
+{
+
+/**
+ * Forwards to the String port and counts decodes, saves, drawing calls and
+ * recordings. Fails to decode the image payload "invalid" and throws on the
+ * payload "throw". Pretends to record if recording is supported.
+ */
+class CountingRenderer final : public SVGRenderer
+{
+public:
+    CountingRenderer(bool supportsRecording = false)
+        : mSupportsRecording{supportsRecording}
+    {
+    }
+
+    std::unique_ptr<ImageData> CreateImageData(const std::string& base64, ImageEncoding encoding) override
+    {
+        ++mDecodes;
+        if (base64 == "invalid")
+            return nullptr;
+        if (base64 == "throw")
+            throw std::runtime_error("broken image");
+        return mTarget.CreateImageData(base64, encoding);
+    }
+    std::unique_ptr<Path> CreatePath() override { return mTarget.CreatePath(); }
+    std::unique_ptr<Transform> CreateTransform(float a, float b, float c, float d, float tx, float ty) override
+    {
+        return mTarget.CreateTransform(a, b, c, d, tx, ty);
+    }
+
+    void Save(const GraphicStyle& graphicStyle) override
+    {
+        ++mSaveCount;
+        mTarget.Save(graphicStyle);
+    }
+    void Restore() override { mTarget.Restore(); }
+    void DrawPath(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) override
+    {
+        ++mDrawCount;
+        mTarget.DrawPath(path, graphicStyle, fillStyle, strokeStyle);
+    }
+    void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override
+    {
+        ++mDrawCount;
+        mTarget.DrawImage(image, graphicStyle, clipArea, fillArea);
+    }
+
+    bool BeginRecording(const Rect&) override
+    {
+        if (!mSupportsRecording)
+            return false;
+        ++mRecordingCount;
+        return true;
+    }
+    std::unique_ptr<Recording> EndRecording() override { return std::unique_ptr<Recording>(new Recording); }
+    void DrawRecording(const Recording&, const Transform&) override { ++mReplayCount; }
+
+    std::string String() const { return mTarget.String(); }
+
+    // Images get decoded on worker threads of an ImageCache.
+    std::atomic<int> mDecodes{};
+    int mSaveCount{};
+    int mDrawCount{};
+    int mRecordingCount{};
+    int mReplayCount{};
+
+private:
+    StringSVGRenderer mTarget;
+    bool mSupportsRecording{};
+};
+
+} // namespace SVGNative
+
+#endif // SVGViewer_CountingRenderer_h
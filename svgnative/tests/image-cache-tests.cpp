@@ -0,0 +1,179 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <svgnative/ImageCache.h>
+#include <svgnative/Rect.h>
+#include <svgnative/SVGDocument.h>
+#include <svgnative/ports/string/StringSVGRenderer.h>
+
+#include "counting-renderer.h"
+
+using namespace SVGNative;
+
+// Decoded String port images are 160x110 pixels.
+static const size_t kImageBytes = 160 * 110 * 4;
+
+static std::string ImageElement(const std::string& payload, int x = 0)
+{
+    return "<image x='" + std::to_string(x) + "' width='10' height='10' xlink:href='data:image/png;base64," + payload + "'/>";
+}
+
+static std::string Document(const std::string& content)
+{
+    return "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 100 100'>"
+        + content + "</svg>";
+}
+
+static std::unique_ptr<SVGDocument> Parse(
+    std::string svg, std::shared_ptr<SVGRenderer> renderer, std::shared_ptr<ImageCache> imageCache = nullptr)
+{
+    return SVGDocument::CreateSVGDocument(svg.c_str(), std::move(renderer), std::move(imageCache));
+}
+
+TEST(image_cache_tests, image_cache_lazy_test)
+{
+    // Images decode on first draw, equal payloads only once.
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto doc = Parse(Document(ImageElement("aaaa") + ImageElement("aaaa", 20) + ImageElement("bbbb", 40)), renderer);
+    ASSERT_TRUE(doc);
+    EXPECT_EQ(renderer->mDecodes, 0);
+
+    doc->Render();
+    EXPECT_EQ(renderer->mDecodes, 2);
+    EXPECT_EQ(renderer->mDrawCount, 3);
+
+    doc->Render();
+    EXPECT_EQ(renderer->mDecodes, 2);
+    EXPECT_EQ(renderer->mDrawCount, 6);
+
+    // Bounds do not depend on decoding.
+    Rect bounds;
+    auto unrendered = Parse(Document(ImageElement("aaaa", 20)), renderer);
+    ASSERT_TRUE(unrendered);
+    EXPECT_TRUE(unrendered->GetBoundingBox(bounds));
+    EXPECT_EQ(bounds, Rect(20, 0, 10, 10));
+    EXPECT_EQ(renderer->mDecodes, 2);
+}
+
+TEST(image_cache_tests, image_cache_invalid_test)
+{
+    // Payloads that fail to decode are skipped and not decoded again.
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto doc = Parse(Document(ImageElement("invalid") + ImageElement("throw") + ImageElement("aaaa")), renderer);
+    ASSERT_TRUE(doc);
+    doc->Render();
+    doc->Render();
+    EXPECT_EQ(renderer->mDecodes, 3);
+    EXPECT_EQ(renderer->mDrawCount, 2);
+}
+
+TEST(image_cache_tests, image_cache_shared_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto imageCache = std::make_shared<ImageCache>(10 * kImageBytes);
+    auto first = Parse(Document(ImageElement("aaaa")), renderer, imageCache);
+    auto second = Parse(Document(ImageElement("aaaa") + ImageElement("bbbb")), renderer, imageCache);
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+
+    first->Render();
+    second->Render();
+    EXPECT_EQ(renderer->mDecodes, 2);
+    auto stats = imageCache->GetStats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.bytes, 2 * kImageBytes);
+
+    // Renderers of other types get their own images.
+    auto stringRenderer = std::make_shared<StringSVGRenderer>();
+    auto other = Parse(Document(ImageElement("aaaa")), stringRenderer, imageCache);
+    ASSERT_TRUE(other);
+    other->Render();
+    EXPECT_EQ(imageCache->GetStats().entries, 3u);
+}
+
+TEST(image_cache_tests, image_cache_collision_test)
+{
+    // Payloads with equal fingerprints and sizes never get each other's image.
+    CountingRenderer renderer;
+    ImageCache imageCache{10 * kImageBytes};
+    auto invalid = std::make_shared<const std::string>("invalid");
+    auto colliding = std::make_shared<const std::string>("iVBORw0");
+    EXPECT_FALSE(imageCache.Get(renderer, 1, invalid, ImageEncoding::kPNG));
+    EXPECT_TRUE(imageCache.Get(renderer, 1, colliding, ImageEncoding::kPNG));
+    EXPECT_EQ(renderer.mDecodes, 2);
+
+    // The cached payload keeps its image, equal copies of it hit.
+    EXPECT_FALSE(imageCache.Get(renderer, 1, std::make_shared<const std::string>("invalid"), ImageEncoding::kPNG));
+    EXPECT_EQ(renderer.mDecodes, 2);
+    EXPECT_EQ(imageCache.GetStats().hits, 1u);
+}
+
+TEST(image_cache_tests, image_cache_budget_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto imageCache = std::make_shared<ImageCache>(kImageBytes + kImageBytes / 2);
+    auto doc = Parse(Document(ImageElement("aaaa") + ImageElement("bbbb")), renderer, imageCache);
+    ASSERT_TRUE(doc);
+
+    // Only the most recently used image fits, the other one gets decoded
+    // again on every rendering.
+    doc->Render();
+    EXPECT_EQ(renderer->mDecodes, 2);
+    auto stats = imageCache->GetStats();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, kImageBytes);
+    EXPECT_EQ(stats.evictions, 1u);
+    doc->Render();
+    EXPECT_EQ(renderer->mDecodes, 4);
+
+    imageCache->SetByteBudget(2 * kImageBytes);
+    doc->Render();
+    doc->Render();
+    EXPECT_EQ(renderer->mDecodes, 5);
+
+    imageCache->SetByteBudget(0);
+    stats = imageCache->GetStats();
+    EXPECT_EQ(stats.entries, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+}
+
+TEST(image_cache_tests, image_cache_threads_test)
+{
+    std::string content;
+    for (int i = 0; i < 64; ++i)
+        content += ImageElement("payload" + std::to_string(i % 32), i);
+    const std::string svg = Document(content);
+
+    auto expectedRenderer = std::make_shared<StringSVGRenderer>();
+    auto expected = Parse(svg, expectedRenderer);
+    ASSERT_TRUE(expected);
+    expected->Render();
+
+    // Workers decode ahead of drawing. Every payload is decoded once and
+    // the output does not change.
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto imageCache = std::make_shared<ImageCache>(100 * kImageBytes, 4);
+    auto doc = Parse(svg, renderer, imageCache);
+    auto second = Parse(svg, renderer, imageCache);
+    ASSERT_TRUE(doc);
+    ASSERT_TRUE(second);
+    doc->Render();
+    second->Render();
+    EXPECT_EQ(renderer->mDecodes, 32);
+    EXPECT_EQ(renderer->mDrawCount, 128);
+    EXPECT_EQ(imageCache->GetStats().entries, 32u);
+    EXPECT_EQ(renderer->String().substr(0, expectedRenderer->String().size()), expectedRenderer->String());
+}
@@ -0,0 +1,47 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+
+#include "gtest/gtest.h"
+
+#include "ImageLevel.h"
+
+#include <limits>
+
+using namespace SVGNative;
+
+TEST(image_level_tests, image_level_size_test)
+{
+    EXPECT_EQ(ImageLevelSize(4000, 0), 4000);
+    EXPECT_EQ(ImageLevelSize(4000, 3), 500);
+    // Rounded up like JPEG DCT scaling.
+    EXPECT_EQ(ImageLevelSize(4001, 3), 501);
+    EXPECT_EQ(ImageLevelSize(3, 1), 2);
+    EXPECT_EQ(ImageLevelSize(3, 10), 1);
+}
+
+TEST(image_level_tests, image_level_selection_test)
+{
+    // A 4000x3000 photo as 64x48 thumbnail uses the 125x94 level.
+    EXPECT_EQ(ImageLevelForDeviceSize(4000, 3000, 64, 48), 5);
+    // Levels never get smaller than the device size.
+    EXPECT_EQ(ImageLevelForDeviceSize(4000, 3000, 500, 375), 3);
+    EXPECT_EQ(ImageLevelForDeviceSize(4000, 3000, 501, 375), 2);
+    EXPECT_EQ(ImageLevelForDeviceSize(4000, 3000, 500, 376), 2);
+    // Upscaled and invalid sizes use the full image.
+    EXPECT_EQ(ImageLevelForDeviceSize(4000, 3000, 8000, 6000), 0);
+    EXPECT_EQ(ImageLevelForDeviceSize(4000, 3000, std::numeric_limits<float>::quiet_NaN(), 10), 0);
+    // Tiny device sizes stop at 1x1.
+    EXPECT_EQ(ImageLevelForDeviceSize(4, 2, 0, 0), 2);
+    EXPECT_EQ(ImageLevelForDeviceSize(1, 1, 0, 0), 0);
+    EXPECT_EQ(ImageLevelForDeviceSize(1 << 30, 1 << 30, 0, 0), kMaxImageLevel);
+}
@@ -0,0 +1,226 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include "Bounds.h"
+#include "PathGeometry.h"
+
+#include <svgnative/SVGDocument.h>
+#include <svgnative/ports/string/StringSVGRenderer.h>
+
+#include <sstream>
+
+using namespace SVGNative;
+
+static size_t CountSegments(const std::string& output)
+{
+    size_t count{};
+    for (size_t i = 0; i + 1 < output.size(); ++i)
+    {
+        if (output[i] == ' ' && (output[i + 1] == 'L' || output[i + 1] == 'C' || output[i + 1] == 'Q'))
+            ++count;
+    }
+    return count;
+}
+
+static std::string Replay(const PathGeometry& geometry, float tolerance = 0)
+{
+    StringSVGRenderer renderer;
+    auto path = renderer.CreatePath();
+    if (tolerance > 0)
+        geometry.Simplify(*path, tolerance);
+    else
+        geometry.Replay(*path);
+    return static_cast<StringSVGPath&>(*path).String();
+}
+
+TEST(path_lod_tests, path_geometry_replay_test)
+{
+    PathGeometry geometry;
+    geometry.MoveTo(0, 0);
+    geometry.LineTo(10, 0);
+    geometry.CurveTo(10, 5, 5, 10, 0, 10);
+    geometry.CurveToV(-5, 5, 0, 0);
+    geometry.ClosePath();
+    EXPECT_EQ(geometry.SegmentCount(), 3u);
+    EXPECT_EQ(Replay(geometry), " M0,0 L10,0 C10,5,5,10,0,10 Q-5,5,0,0 Z");
+    // Nothing is within the tolerance.
+    EXPECT_EQ(Replay(geometry, 0.1f), Replay(geometry));
+}
+
+TEST(path_lod_tests, path_append_test)
+{
+    const std::uint8_t verbs[] = {static_cast<std::uint8_t>(PathVerb::kMove), static_cast<std::uint8_t>(PathVerb::kLine),
+        static_cast<std::uint8_t>(PathVerb::kCurve), static_cast<std::uint8_t>(PathVerb::kQuadCurve),
+        static_cast<std::uint8_t>(PathVerb::kClose), static_cast<std::uint8_t>(PathVerb::kLine)};
+    const float points[] = {0, 0, 10, 0, 10, 5, 5, 20, 0, 10, -5, 5, 0, 0};
+
+    // Bulk segments match single calls.
+    PathGeometry geometry;
+    geometry.Append(verbs, 5, points, 7);
+    EXPECT_EQ(geometry.SegmentCount(), 3u);
+    EXPECT_EQ(Replay(geometry), " M0,0 L10,0 C10,5,5,20,0,10 Q-5,5,0,0 Z");
+
+    // Verbs without enough points are ignored. The bounds include the
+    // extrema of the curves.
+    StringSVGRenderer renderer;
+    auto path = renderer.CreatePath();
+    BoundsRecordingPath recorder{*path};
+    recorder.Append(verbs, 6, points, 7);
+    EXPECT_EQ(static_cast<StringSVGPath&>(*path).String(), Replay(geometry));
+    auto single = renderer.CreatePath();
+    BoundsRecordingPath singleRecorder{*single};
+    geometry.Simplify(singleRecorder, 0);
+    EXPECT_EQ(recorder.GetBounds().ToRect(), singleRecorder.GetBounds().ToRect());
+    EXPECT_GT(recorder.GetBounds().maxY, 10);
+}
+
+TEST(path_lod_tests, path_geometry_rect_test)
+{
+    Bounds rect;
+    PathGeometry geometry;
+    geometry.Rect(10, 20, 30, 40);
+    EXPECT_TRUE(geometry.IsRect(rect));
+    EXPECT_EQ(rect.ToRect(), Rect(10, 20, 30, 40));
+
+    // Vertical first, closed by a fourth line and without ClosePath.
+    PathGeometry path;
+    path.MoveTo(0, 0);
+    path.LineTo(0, 10);
+    path.LineTo(-5, 10);
+    path.LineTo(-5, 0);
+    path.LineTo(0, 0);
+    EXPECT_TRUE(path.IsRect(rect));
+    EXPECT_EQ(rect.ToRect(), Rect(-5, 0, 5, 10));
+
+    PathGeometry skewed;
+    skewed.MoveTo(0, 0);
+    skewed.LineTo(10, 0);
+    skewed.LineTo(12, 10);
+    skewed.LineTo(0, 10);
+    skewed.ClosePath();
+    EXPECT_FALSE(skewed.IsRect(rect));
+
+    PathGeometry open;
+    open.MoveTo(0, 0);
+    open.LineTo(10, 0);
+    open.LineTo(10, 10);
+    open.LineTo(0, 10);
+    open.LineTo(0, 5);
+    EXPECT_FALSE(open.IsRect(rect));
+
+    PathGeometry rounded;
+    rounded.RoundedRect(0, 0, 10, 10, 2, 2);
+    EXPECT_FALSE(rounded.IsRect(rect));
+    PathGeometry twice;
+    twice.Rect(0, 0, 10, 10);
+    twice.Rect(20, 0, 10, 10);
+    EXPECT_FALSE(twice.IsRect(rect));
+}
+
+TEST(path_lod_tests, path_geometry_simplify_test)
+{
+    // Short segments get merged, the end point of the subpath stays.
+    PathGeometry geometry;
+    geometry.MoveTo(0, 0);
+    for (int i = 1; i <= 100; ++i)
+        geometry.LineTo(i * 0.1f, (i % 2) * 0.05f);
+    StringSVGRenderer renderer;
+    auto path = renderer.CreatePath();
+    EXPECT_EQ(geometry.Simplify(*path, 1), 10u);
+    const auto output = static_cast<StringSVGPath&>(*path).String();
+    EXPECT_EQ(CountSegments(output), 10u);
+    EXPECT_EQ(output.substr(output.rfind(' ')), " L10,0");
+
+    // Flat curves become lines, curved ones stay.
+    PathGeometry curves;
+    curves.MoveTo(0, 0);
+    curves.CurveTo(10, 0.5f, 20, -0.5f, 30, 0);
+    curves.CurveToV(40, 0.5f, 50, 0);
+    curves.CurveTo(60, 10, 70, 10, 80, 0);
+    EXPECT_EQ(Replay(curves, 1), " M0,0 L30,0 L50,0 C60,10,70,10,80,0");
+    // Closing a subpath drops merged points before it.
+    PathGeometry closed;
+    closed.MoveTo(0, 0);
+    closed.LineTo(10, 0);
+    closed.LineTo(10.1f, 0);
+    closed.ClosePath();
+    EXPECT_EQ(Replay(closed, 1), " M0,0 L10,0 Z");
+}
+
+static std::string ZigZagDocument(int segments)
+{
+    std::ostringstream svg;
+    svg << "<svg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 1000 1000'><path fill='none' stroke='black' d='M0,500";
+    for (int i = 0; i < segments / 2; ++i)
+        svg << " l1,0.5 l1,-0.5";
+    svg << "'/><path d='M0,0 l1,1 l1,-1 z'/></svg>";
+    return svg.str();
+}
+
+static std::string Render(SVGDocument& doc, StringSVGRenderer& renderer, float size)
+{
+    doc.Render(size, size);
+    return renderer.String();
+}
+
+TEST(path_lod_tests, path_lod_document_test)
+{
+    const std::string svg = ZigZagDocument(1000);
+    auto renderer = std::make_shared<StringSVGRenderer>();
+    auto doc = SVGDocument::CreateSVGDocument(std::string{svg}.c_str(), renderer);
+    ASSERT_TRUE(doc);
+    const auto original = Render(*doc, *renderer, 20);
+    EXPECT_EQ(CountSegments(original), 1002u);
+
+    // A 20px thumbnail draws a fraction of the segments. Small paths are
+    // drawn unchanged.
+    auto renderer2 = std::make_shared<StringSVGRenderer>();
+    auto doc2 = SVGDocument::CreateSVGDocument(std::string{svg}.c_str(), renderer2);
+    ASSERT_TRUE(doc2);
+    doc2->SetPathLevelOfDetail(0.5f);
+    const auto thumbnail = Render(*doc2, *renderer2, 20);
+    EXPECT_LT(CountSegments(thumbnail), 100u);
+    EXPECT_NE(thumbnail.find(" M0,0 L1,1 L2,0 Z"), std::string::npos);
+
+    // At large scales nothing gets simplified.
+    auto renderer3 = std::make_shared<StringSVGRenderer>();
+    auto doc3 = SVGDocument::CreateSVGDocument(std::string{svg}.c_str(), renderer3);
+    ASSERT_TRUE(doc3);
+    doc3->SetPathLevelOfDetail(0.5f);
+    auto referenceRenderer = std::make_shared<StringSVGRenderer>();
+    auto reference = SVGDocument::CreateSVGDocument(std::string{svg}.c_str(), referenceRenderer);
+    ASSERT_TRUE(reference);
+    EXPECT_EQ(Render(*doc3, *renderer3, 4000), Render(*reference, *referenceRenderer, 4000));
+}
+
+TEST(path_lod_tests, path_lod_tolerance_test)
+{
+    const std::string svg = ZigZagDocument(1000);
+    auto renderer = std::make_shared<StringSVGRenderer>();
+    auto doc = SVGDocument::CreateSVGDocument(std::string{svg}.c_str(), renderer);
+    ASSERT_TRUE(doc);
+    doc->SetPathLevelOfDetail(0.5f);
+    doc->Render(100, 100);
+    const auto coarse = CountSegments(renderer->String());
+    // Changing the tolerance drops cached paths.
+    doc->SetPathLevelOfDetail(0.05f);
+    const auto before = renderer->String().size();
+    doc->Render(100, 100);
+    const auto fine = CountSegments(renderer->String().substr(before));
+    EXPECT_LT(coarse, fine);
+    doc->SetPathLevelOfDetail(0);
+    const auto reset = renderer->String().size();
+    doc->Render(100, 100);
+    EXPECT_EQ(CountSegments(renderer->String().substr(reset)), 1002u);
+}
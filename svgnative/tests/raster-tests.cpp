@@ -0,0 +1,236 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <svgnative/SVGDocument.h>
+#include <svgnative/ports/raster/RasterSVGRenderer.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace SVGNative;
+
+// Renders a document of 100x100 user units at scale 1 into premultiplied RGBA.
+class RasterImage
+{
+public:
+    RasterImage(const std::string& svg, RasterSVGRenderer::ImageDecoder decoder = nullptr)
+        : mPixels(4 * 100 * 100, 0)
+    {
+        auto renderer = std::make_shared<RasterSVGRenderer>();
+        renderer->SetImageDecoder(decoder);
+        renderer->SetTarget(mPixels.data(), 100, 100, 4 * 100);
+        const std::string document = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' "
+            "width='100' height='100'>" + svg + "</svg>";
+        auto doc = SVGDocument::CreateSVGDocument(document.c_str(), renderer);
+        EXPECT_TRUE(doc);
+        if (doc)
+            doc->Render();
+    }
+
+    const std::uint8_t* At(int x, int y) const { return mPixels.data() + 4 * (y * 100 + x); }
+    int Alpha(int x, int y) const { return At(x, y)[3]; }
+
+private:
+    std::vector<std::uint8_t> mPixels;
+};
+
+#define EXPECT_PIXEL(image, x, y, r, g, b, a)                  \
+    do                                                         \
+    {                                                          \
+        const std::uint8_t* pixel = (image).At(x, y);          \
+        EXPECT_NEAR(pixel[0], r, 2) << "at " << x << "," << y; \
+        EXPECT_NEAR(pixel[1], g, 2) << "at " << x << "," << y; \
+        EXPECT_NEAR(pixel[2], b, 2) << "at " << x << "," << y; \
+        EXPECT_NEAR(pixel[3], a, 2) << "at " << x << "," << y; \
+    } while (false)
+
+TEST(raster_tests, fill_rule_test)
+{
+    // Two squares in the same direction, the inner one inside the outer one.
+    const std::string path = "d='M10 10H90V90H10Z M30 30H70V70H30Z'";
+    RasterImage nonZero{"<path " + path + "/>"};
+    EXPECT_PIXEL(nonZero, 20, 20, 0, 0, 0, 255);
+    EXPECT_PIXEL(nonZero, 50, 50, 0, 0, 0, 255);
+    EXPECT_PIXEL(nonZero, 95, 95, 0, 0, 0, 0);
+
+    RasterImage evenOdd{"<path fill-rule='evenodd' " + path + "/>"};
+    EXPECT_PIXEL(evenOdd, 20, 20, 0, 0, 0, 255);
+    EXPECT_PIXEL(evenOdd, 50, 50, 0, 0, 0, 0);
+}
+
+TEST(raster_tests, anti_aliasing_test)
+{
+    RasterImage image{"<rect x='10.5' y='10' width='20' height='20.25' fill='#0000ff'/>"};
+    EXPECT_PIXEL(image, 10, 20, 0, 0, 128, 128);
+    EXPECT_PIXEL(image, 11, 20, 0, 0, 255, 255);
+    EXPECT_PIXEL(image, 30, 20, 0, 0, 128, 128);
+    EXPECT_EQ(image.Alpha(20, 30), 64);
+    EXPECT_EQ(image.Alpha(9, 20), 0);
+
+    // Coverage of a diagonal edge is the exact area.
+    RasterImage triangle{"<path d='M0 0L100 100H0Z'/>"};
+    EXPECT_EQ(triangle.Alpha(50, 50), 128);
+    EXPECT_EQ(triangle.Alpha(49, 50), 255);
+    EXPECT_EQ(triangle.Alpha(51, 50), 0);
+}
+
+TEST(raster_tests, stroke_test)
+{
+    RasterImage butt{"<path d='M20 50H80' stroke='#000' stroke-width='10'/>"};
+    EXPECT_EQ(butt.Alpha(50, 45), 255);
+    EXPECT_EQ(butt.Alpha(50, 54), 255);
+    EXPECT_EQ(butt.Alpha(50, 56), 0);
+    EXPECT_EQ(butt.Alpha(18, 50), 0);
+
+    RasterImage square{"<path d='M20 50H80' stroke='#000' stroke-width='10' stroke-linecap='square'/>"};
+    EXPECT_EQ(square.Alpha(16, 50), 255);
+    EXPECT_EQ(square.Alpha(83, 50), 255);
+    EXPECT_EQ(square.Alpha(86, 50), 0);
+
+    RasterImage round{"<path d='M20 50H80' stroke='#000' stroke-width='10' stroke-linecap='round'/>"};
+    EXPECT_EQ(round.Alpha(16, 50), 255);
+    EXPECT_EQ(round.Alpha(15, 45), 0);
+
+    // A sharp turn falls back to a bevel with the default miter limit.
+    RasterImage miter{"<path d='M10 20L90 20L10 30' fill='none' stroke='#000' stroke-width='4'/>"};
+    EXPECT_EQ(miter.Alpha(95, 20), 0);
+    RasterImage longMiter{"<path d='M10 20L90 20L10 30' fill='none' stroke='#000' stroke-width='4' stroke-miterlimit='100'/>"};
+    EXPECT_EQ(longMiter.Alpha(95, 20), 255);
+}
+
+TEST(raster_tests, dash_test)
+{
+    RasterImage image{"<path d='M0 50H100' stroke='#000' stroke-width='4' stroke-dasharray='10 10' stroke-dashoffset='5'/>"};
+    EXPECT_EQ(image.Alpha(2, 50), 255);
+    EXPECT_EQ(image.Alpha(10, 50), 0);
+    EXPECT_EQ(image.Alpha(20, 50), 255);
+    EXPECT_EQ(image.Alpha(30, 50), 0);
+}
+
+TEST(raster_tests, gradient_test)
+{
+    RasterImage linear{"<linearGradient id='g' gradientUnits='userSpaceOnUse' x1='0' x2='100'>"
+                       "<stop stop-color='#ff0000'/><stop offset='1' stop-color='#0000ff'/></linearGradient>"
+                       "<rect width='100' height='100' fill='url(#g)'/>"};
+    EXPECT_PIXEL(linear, 0, 50, 254, 0, 1, 255);
+    EXPECT_PIXEL(linear, 50, 50, 127, 0, 128, 255);
+    EXPECT_PIXEL(linear, 99, 50, 1, 0, 254, 255);
+
+    RasterImage reflect{"<linearGradient id='g' gradientUnits='userSpaceOnUse' x1='0' x2='50' spreadMethod='reflect'>"
+                        "<stop stop-color='#000000'/><stop offset='1' stop-color='#ffffff'/></linearGradient>"
+                        "<rect width='100' height='100' fill='url(#g)'/>"};
+    EXPECT_PIXEL(reflect, 49, 50, 252, 252, 252, 255);
+    EXPECT_PIXEL(reflect, 75, 50, 125, 125, 125, 255);
+    EXPECT_PIXEL(reflect, 99, 50, 3, 3, 3, 255);
+
+    RasterImage radial{"<radialGradient id='g' gradientUnits='userSpaceOnUse' cx='50' cy='50' r='40' spreadMethod='repeat'>"
+                       "<stop stop-color='#000000'/><stop offset='1' stop-color='#ffffff'/></radialGradient>"
+                       "<rect width='100' height='100' fill='url(#g)'/>"};
+    EXPECT_PIXEL(radial, 50, 50, 5, 5, 5, 255);
+    EXPECT_PIXEL(radial, 70, 50, 131, 131, 131, 255);
+    EXPECT_PIXEL(radial, 99, 50, 60, 60, 60, 255);
+}
+
+TEST(raster_tests, clip_test)
+{
+    RasterImage image{"<clipPath id='c'><circle cx='50' cy='50' r='20'/></clipPath>"
+                      "<rect width='100' height='100' clip-path='url(#c)'/>"};
+    EXPECT_EQ(image.Alpha(50, 50), 255);
+    EXPECT_EQ(image.Alpha(50, 25), 0);
+    EXPECT_EQ(image.Alpha(10, 10), 0);
+
+    // Nested clipping paths intersect. Masks of popped states get reused.
+    RasterImage nested{"<clipPath id='a'><circle cx='40' cy='30' r='20'/></clipPath>"
+                       "<clipPath id='b'><circle cx='60' cy='30' r='20'/></clipPath>"
+                       "<g clip-path='url(#a)'><rect width='100' height='60' clip-path='url(#b)'/></g>"
+                       "<g clip-path='url(#b)'><rect y='40' width='100' height='60' clip-path='url(#a)' transform='translate(0 40)'/></g>"};
+    EXPECT_EQ(nested.Alpha(50, 30), 255);
+    EXPECT_EQ(nested.Alpha(30, 30), 0);
+    EXPECT_EQ(nested.Alpha(70, 30), 0);
+    EXPECT_EQ(nested.Alpha(50, 70), 0);
+}
+
+TEST(raster_tests, clip_rect_test)
+{
+    // Pixel-aligned rectangles clip without coverage.
+    RasterImage aligned{"<clipPath id='c'><path d='M10 20H40V60H10Z' transform='translate(5 0) scale(1 0.5)'/></clipPath>"
+                        "<rect width='100' height='100' clip-path='url(#c)'/>"};
+    EXPECT_EQ(aligned.Alpha(15, 10), 255);
+    EXPECT_EQ(aligned.Alpha(44, 29), 255);
+    EXPECT_EQ(aligned.Alpha(14, 10), 0);
+    EXPECT_EQ(aligned.Alpha(45, 10), 0);
+    EXPECT_EQ(aligned.Alpha(20, 30), 0);
+
+    // Other rectangles get anti-aliased like any clipping path.
+    RasterImage unaligned{"<clipPath id='c'><rect x='10.5' y='10' width='20' height='20'/></clipPath>"
+                          "<g transform='translate(0 0.25)'><rect width='100' height='100' clip-path='url(#c)'/></g>"};
+    EXPECT_EQ(unaligned.Alpha(20, 20), 255);
+    EXPECT_NEAR(unaligned.Alpha(10, 20), 128, 2);
+    EXPECT_NEAR(unaligned.Alpha(20, 10), 191, 2);
+    EXPECT_EQ(unaligned.Alpha(9, 20), 0);
+
+    // Rotated rectangles are no rectangles in device space.
+    RasterImage rotated{"<clipPath id='c'><rect x='40' y='40' width='20' height='20' transform='rotate(45 50 50)'/></clipPath>"
+                        "<rect width='100' height='100' clip-path='url(#c)'/>"};
+    EXPECT_EQ(rotated.Alpha(50, 50), 255);
+    EXPECT_EQ(rotated.Alpha(41, 41), 0);
+
+    // Invalid transforms get ignored, partially parsed ones too.
+    RasterImage invalid{"<clipPath id='c'><rect x='10' y='10' width='20' height='20' transform='scale(2) foo'/></clipPath>"
+                        "<rect width='100' height='100' clip-path='url(#c)'/>"};
+    EXPECT_EQ(invalid.Alpha(20, 20), 255);
+    EXPECT_EQ(invalid.Alpha(29, 29), 255);
+    EXPECT_EQ(invalid.Alpha(30, 30), 0);
+    EXPECT_EQ(invalid.Alpha(50, 50), 0);
+}
+
+TEST(raster_tests, group_opacity_test)
+{
+    // Overlapping children get composited as one layer.
+    RasterImage image{"<g opacity='0.5'><rect width='60' height='60'/><rect x='40' y='40' width='60' height='60'/></g>"};
+    EXPECT_EQ(image.Alpha(20, 20), 128);
+    EXPECT_EQ(image.Alpha(50, 50), 128);
+    EXPECT_EQ(image.Alpha(80, 80), 128);
+    EXPECT_EQ(image.Alpha(80, 20), 0);
+
+    RasterImage element{"<rect width='100' height='100' opacity='0.5' fill='#ff0000' stroke='#0000ff' stroke-width='20'/>"};
+    EXPECT_PIXEL(element, 2, 50, 0, 0, 128, 128);
+    EXPECT_PIXEL(element, 50, 50, 128, 0, 0, 128);
+}
+
+TEST(raster_tests, image_test)
+{
+    // A 2x2 image, left column red, right column blue.
+    auto decoder = [](const std::string& data, ImageEncoding, RasterSVGImageData& image) {
+        if (data != "abc")
+            return false;
+        image.mWidth = 2;
+        image.mHeight = 2;
+        image.mPixels = {255, 0, 0, 255, 0, 0, 255, 255, 255, 0, 0, 255, 0, 0, 255, 255};
+        return true;
+    };
+    const std::string svg = "<image x='20' y='20' width='60' height='60' xlink:href='data:image/png;base64,YWJj'/>";
+
+    RasterImage image{svg, decoder};
+    EXPECT_PIXEL(image, 25, 50, 255, 0, 0, 255);
+    EXPECT_PIXEL(image, 75, 50, 0, 0, 255, 255);
+    EXPECT_EQ(image.Alpha(19, 50), 0);
+    EXPECT_EQ(image.Alpha(80, 50), 0);
+
+    // Without a decoder, images get skipped.
+    RasterImage skipped{svg};
+    EXPECT_EQ(skipped.Alpha(50, 50), 0);
+}
@@ -0,0 +1,157 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <svgnative/SVGDocument.h>
+
+#include "counting-renderer.h"
+
+using namespace SVGNative;
+
+static const std::string kDocument = "<svg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 100 100'>"
+    "<rect width='50' height='50' fill='var(--fill, red)'/><circle cx='70' cy='70' r='20'/></svg>";
+
+TEST(recording_tests, recording_replay_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>(true);
+    auto doc = SVGDocument::CreateSVGDocument(std::string{kDocument}.c_str(), renderer);
+    ASSERT_TRUE(doc);
+    doc->SetRecordingEnabled(true);
+
+    doc->Render(100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 1);
+    EXPECT_EQ(renderer->mDrawCount, 2);
+    EXPECT_EQ(renderer->mReplayCount, 1);
+
+    doc->Render(400, 400);
+    doc->Render(25, 25);
+    EXPECT_EQ(renderer->mRecordingCount, 1);
+    EXPECT_EQ(renderer->mDrawCount, 2);
+    EXPECT_EQ(renderer->mReplayCount, 3);
+}
+
+TEST(recording_tests, recording_color_map_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>(true);
+    auto doc = SVGDocument::CreateSVGDocument(std::string{kDocument}.c_str(), renderer);
+    ASSERT_TRUE(doc);
+    doc->SetRecordingEnabled(true);
+
+    ColorMap colorMap{{"fill", {{0, 0, 1, 1}}}};
+    doc->Render(colorMap, 100, 100);
+    doc->Render(colorMap, 200, 200);
+    EXPECT_EQ(renderer->mRecordingCount, 1);
+
+    colorMap["fill"] = {{0, 1, 0, 1}};
+    doc->Render(colorMap, 200, 200);
+    EXPECT_EQ(renderer->mRecordingCount, 2);
+    EXPECT_EQ(renderer->mReplayCount, 3);
+
+    doc->ClearRecording();
+    doc->Render(colorMap, 200, 200);
+    EXPECT_EQ(renderer->mRecordingCount, 3);
+}
+
+TEST(recording_tests, recording_disabled_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>(true);
+    auto doc = SVGDocument::CreateSVGDocument(std::string{kDocument}.c_str(), renderer);
+    ASSERT_TRUE(doc);
+
+    doc->Render(100, 100);
+    doc->Render(100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 0);
+    EXPECT_EQ(renderer->mDrawCount, 4);
+
+    // Ports without recording support draw the render tree.
+    auto immediateRenderer = std::make_shared<CountingRenderer>(false);
+    auto immediateDoc = SVGDocument::CreateSVGDocument(std::string{kDocument}.c_str(), immediateRenderer);
+    ASSERT_TRUE(immediateDoc);
+    immediateDoc->SetRecordingEnabled(true);
+    immediateDoc->Render(100, 100);
+    immediateDoc->Render(100, 100);
+    EXPECT_EQ(immediateRenderer->mDrawCount, 4);
+    EXPECT_EQ(immediateRenderer->mReplayCount, 0);
+}
+
+static std::string UseDocument(int symbolDraws, int useCount)
+{
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 100 100'>"
+        "<defs><g id='symbol'>";
+    for (int i = 0; i < symbolDraws; ++i)
+        svg += "<rect x='" + std::to_string(i) + "' width='1' height='1' fill='var(--fill, red)'/>";
+    svg += "</g></defs>";
+    for (int i = 0; i < useCount; ++i)
+        svg += "<use xlink:href='#symbol' x='" + std::to_string(i) + "'/>";
+    return svg + "</svg>";
+}
+
+TEST(recording_tests, recording_instancing_test)
+{
+    // Repeated content gets recorded once and replayed per <use>.
+    auto renderer = std::make_shared<CountingRenderer>(true);
+    auto doc = SVGDocument::CreateSVGDocument(UseDocument(10, 100).c_str(), renderer);
+    ASSERT_TRUE(doc);
+    doc->Render(100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 1);
+    EXPECT_EQ(renderer->mDrawCount, 10);
+    EXPECT_EQ(renderer->mReplayCount, 100);
+    doc->Render(100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 1);
+    EXPECT_EQ(renderer->mDrawCount, 10);
+    auto stats = doc->GetRenderStats();
+    EXPECT_EQ(stats.instancesRecorded, 1u);
+    EXPECT_EQ(stats.instancesReplayed, 200u);
+    EXPECT_EQ(stats.referencesTraversed, 0u);
+
+    // New colors need a new recording.
+    doc->Render(ColorMap{{"fill", {{0, 0, 1, 1}}}}, 100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 2);
+    EXPECT_EQ(renderer->mDrawCount, 20);
+
+    // Instances nest into the recording of the whole document.
+    doc->SetRecordingEnabled(true);
+    doc->Render(100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 4);
+    EXPECT_EQ(renderer->mDrawCount, 30);
+
+    doc->SetRecordingEnabled(false);
+    doc->SetInstancingEnabled(false);
+    doc->Render(100, 100);
+    EXPECT_EQ(renderer->mDrawCount, 1030);
+    EXPECT_EQ(doc->GetRenderStats().referencesTraversed, 100u);
+}
+
+TEST(recording_tests, recording_instancing_threshold_test)
+{
+    // Small content and content used once are drawn as they are.
+    auto renderer = std::make_shared<CountingRenderer>(true);
+    auto small = SVGDocument::CreateSVGDocument(UseDocument(2, 100).c_str(), renderer);
+    auto single = SVGDocument::CreateSVGDocument(UseDocument(10, 1).c_str(), renderer);
+    ASSERT_TRUE(small);
+    ASSERT_TRUE(single);
+    small->Render(100, 100);
+    single->Render(100, 100);
+    EXPECT_EQ(renderer->mRecordingCount, 0);
+    EXPECT_EQ(renderer->mDrawCount, 210);
+    EXPECT_EQ(small->GetRenderStats().referencesTraversed, 100u);
+    EXPECT_EQ(single->GetRenderStats().instancesRecorded, 0u);
+
+    // Ports without recording support draw the referenced content.
+    auto immediateRenderer = std::make_shared<CountingRenderer>(false);
+    auto immediate = SVGDocument::CreateSVGDocument(UseDocument(10, 100).c_str(), immediateRenderer);
+    ASSERT_TRUE(immediate);
+    immediate->Render(100, 100);
+    EXPECT_EQ(immediateRenderer->mDrawCount, 1000);
+    EXPECT_EQ(immediate->GetRenderStats().referencesTraversed, 100u);
+}
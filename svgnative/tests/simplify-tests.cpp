@@ -0,0 +1,182 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <svgnative/SVGDocument.h>
+#include <svgnative/Rect.h>
+#include <svgnative/ports/string/StringSVGRenderer.h>
+
+#include "counting-renderer.h"
+
+using namespace SVGNative;
+
+static std::unique_ptr<SVGDocument> Parse(
+    const std::string& content, std::shared_ptr<SVGRenderer> renderer, bool keepShapeGeometry = true)
+{
+    const std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' "
+                            "viewBox='0 0 100 100'>" + content + "</svg>";
+    ParseOptions options;
+    options.keepShapeGeometry = keepShapeGeometry;
+    return SVGDocument::CreateSVGDocument(svg.c_str(), std::move(renderer), nullptr, options);
+}
+
+TEST(simplify_tests, simplify_prune_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto doc = Parse("<rect width='10' height='10' opacity='0'/>"
+                     "<rect width='10' height='10' fill='none'/>"
+                     "<rect width='10' height='10' fill-opacity='0' stroke='red' stroke-width='0'/>"
+                     "<clipPath id='empty'/><rect width='10' height='10' clip-path='url(#empty)'/>"
+                     "<g opacity='0'><rect width='10' height='10'/></g>"
+                     "<g><rect width='10' height='10' fill='none'/></g>"
+                     "<use xlink:href='#missing'/>"
+                     "<rect x='50' width='10' height='10' fill='none' stroke='red'/>", renderer);
+    ASSERT_TRUE(doc);
+    Rect before;
+    EXPECT_TRUE(doc->GetBoundingBox(before));
+
+    const auto stats = doc->SimplifyRenderTree();
+    EXPECT_EQ(stats.drawsBefore, 7u);
+    EXPECT_EQ(stats.drawsAfter, 1u);
+    EXPECT_LT(stats.elementsAfter, stats.elementsBefore);
+    EXPECT_EQ(doc->GetRenderStats().expandedElements, stats.elementsAfter);
+
+    doc->Render();
+    EXPECT_EQ(renderer->mDrawCount, 1);
+    Rect after;
+    EXPECT_TRUE(doc->GetBoundingBox(after));
+    EXPECT_EQ(after, Rect(48, -2, 14, 14));
+}
+
+TEST(simplify_tests, simplify_display_test)
+{
+    // Rendering draws elements with display:none and visibility:hidden, so
+    // they are no candidates for pruning.
+    const std::string content = "<rect width='10' height='10' display='none'/>"
+                                "<rect x='20' width='10' height='10' visibility='hidden' fill='blue'/>"
+                                "<g display='none'><rect x='40' width='10' height='10' stroke='red'/></g>";
+    auto renderer = std::make_shared<StringSVGRenderer>();
+    auto doc = Parse(content, renderer);
+    ASSERT_TRUE(doc);
+    doc->Render();
+    const auto expected = renderer->String();
+
+    auto simplifiedRenderer = std::make_shared<StringSVGRenderer>();
+    auto simplified = Parse(content, simplifiedRenderer);
+    ASSERT_TRUE(simplified);
+    const auto stats = simplified->SimplifyRenderTree();
+    EXPECT_EQ(stats.drawsAfter, stats.drawsBefore);
+    simplified->Render();
+    EXPECT_EQ(simplifiedRenderer->String(), expected);
+}
+
+TEST(simplify_tests, simplify_collapse_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto doc = Parse("<g><g><g><rect width='10' height='10' stroke='blue'/></g></g></g>"
+                     "<g transform='translate(20 0)'><g transform='scale(2)' opacity='0.5'>"
+                     "<rect width='10' height='10' stroke='blue'/></g></g>", renderer);
+    ASSERT_TRUE(doc);
+    Rect before;
+    EXPECT_TRUE(doc->GetBoundingBox(before));
+
+    // Only the root group and the two rectangles remain.
+    const auto stats = doc->SimplifyRenderTree();
+    EXPECT_EQ(stats.elementsBefore, 9u);
+    EXPECT_EQ(stats.elementsAfter, 3u);
+    EXPECT_EQ(stats.drawsAfter, 2u);
+
+    Rect after;
+    EXPECT_TRUE(doc->GetBoundingBox(after));
+    EXPECT_EQ(after, before);
+    doc->Render();
+    EXPECT_EQ(renderer->mDrawCount, 2);
+    // Only the root transform gets saved.
+    EXPECT_EQ(renderer->mSaveCount, 1);
+}
+
+TEST(simplify_tests, simplify_merge_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>();
+    auto doc = Parse("<rect width='10' height='10' fill='red'/>"
+                     "<circle cx='30' cy='5' r='5' fill='red'/>"
+                     "<path d='M50 0h10v10z' fill='red'/>"
+                     // Overlaps the path.
+                     "<rect x='55' width='10' height='10' fill='red'/>"
+                     // Different fill, stroke and clipping path.
+                     "<rect y='20' width='10' height='10' fill='blue'/>"
+                     "<rect x='20' y='20' width='10' height='10' fill='red' stroke='red'/>"
+                     "<clipPath id='clip'><rect width='50' height='50'/></clipPath>"
+                     "<rect x='40' y='20' width='10' height='10' fill='red' clip-path='url(#clip)'/>"
+                     "<rect y='40' width='10' height='10' fill='var(--a, red)'/>"
+                     "<rect x='20' y='40' width='10' height='10' fill='var(--a, red)'/>", renderer);
+    ASSERT_TRUE(doc);
+    Rect before;
+    EXPECT_TRUE(doc->GetBoundingBox(before));
+
+    const auto stats = doc->SimplifyRenderTree();
+    EXPECT_EQ(stats.drawsBefore, 9u);
+    EXPECT_EQ(stats.drawsAfter, 6u);
+
+    Rect after;
+    EXPECT_TRUE(doc->GetBoundingBox(after));
+    EXPECT_EQ(after, before);
+    doc->Render();
+    EXPECT_EQ(renderer->mDrawCount, 6);
+
+    // Merged paths draw the same as the original ones.
+    auto stringRenderer = std::make_shared<StringSVGRenderer>();
+    auto merged = Parse("<rect width='10' height='10'/><rect x='20' width='10' height='10'/>", stringRenderer);
+    ASSERT_TRUE(merged);
+    merged->SimplifyRenderTree();
+    merged->Render();
+    const auto output = stringRenderer->String();
+    EXPECT_NE(output.find("M0,0 L10,0 L10,10 L0,10 Z M20,0 L30,0 L30,10 L20,10 Z"), std::string::npos) << output;
+
+    // Without the geometry of small shapes, only large paths get merged.
+    std::string segments;
+    for (int i = 0; i < 64; ++i)
+        segments += " h0.1 v0.1";
+    auto unmerged = Parse("<rect width='10' height='10'/><rect x='20' width='10' height='10'/>"
+                          "<path d='M0 20" + segments + "z'/><path d='M50 20" + segments + "z'/>", renderer, false);
+    ASSERT_TRUE(unmerged);
+    const auto unmergedStats = unmerged->SimplifyRenderTree();
+    EXPECT_EQ(unmergedStats.drawsBefore, 4u);
+    EXPECT_EQ(unmergedStats.drawsAfter, 3u);
+}
+
+TEST(simplify_tests, simplify_shared_test)
+{
+    auto renderer = std::make_shared<CountingRenderer>();
+    // The content of 'a' gets merged for every <use>. The shared group 's'
+    // does not move into the translated group.
+    auto doc = Parse("<defs><g id='a'><rect width='10' height='10'/><rect x='20' width='10' height='10'/></g></defs>"
+                     "<use xlink:href='#a'/><use xlink:href='#a' y='50'/>"
+                     "<g transform='translate(50 0)'><g id='s'><rect width='10' height='10' stroke='blue'/></g></g>", renderer);
+    ASSERT_TRUE(doc);
+    Rect sharedBefore;
+    EXPECT_TRUE(doc->GetBoundingBox("s", sharedBefore));
+
+    const auto stats = doc->SimplifyRenderTree();
+    EXPECT_EQ(stats.drawsBefore, 5u);
+    EXPECT_EQ(stats.drawsAfter, 3u);
+
+    doc->Render("a");
+    EXPECT_EQ(renderer->mDrawCount, 1);
+    Rect sharedAfter;
+    EXPECT_TRUE(doc->GetBoundingBox("s", sharedAfter));
+    EXPECT_EQ(sharedAfter, sharedBefore);
+    Rect bounds;
+    EXPECT_TRUE(doc->GetBoundingBox(bounds));
+    EXPECT_EQ(bounds, Rect(0, -2, 62, 62));
+}
@@ -0,0 +1,97 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include "Matrix.h"
+#include "SpatialIndex.h"
+
+#include <vector>
+
+using namespace SVGNative;
+
+// A grid of 10x10 unit squares with a gap of 1 between them.
+static std::vector<Bounds> GridBounds()
+{
+    std::vector<Bounds> bounds;
+    for (int y = 0; y < 10; ++y)
+    {
+        for (int x = 0; x < 10; ++x)
+            bounds.push_back(Bounds(x * 2.0f, y * 2.0f, x * 2.0f + 1, y * 2.0f + 1));
+    }
+    return bounds;
+}
+
+TEST(spatial_index_tests, spatial_index_query_test)
+{
+    auto bounds = GridBounds();
+    SpatialIndex index{bounds};
+    EXPECT_EQ(index.Size(), 100u);
+
+    std::vector<std::uint32_t> result;
+    index.Query(Bounds(3.5f, 3.5f, 6.5f, 4.5f), result);
+    std::vector<std::uint32_t> expected{22, 23};
+    EXPECT_EQ(result, expected);
+
+    index.Query(Bounds(100, 100, 200, 200), result);
+    EXPECT_TRUE(result.empty());
+
+    index.Query(Bounds(-1, -1, 100, 100), result);
+    EXPECT_EQ(result.size(), 100u);
+    for (std::uint32_t i = 0; i < result.size(); ++i)
+        EXPECT_EQ(result[i], i);
+}
+
+TEST(spatial_index_tests, spatial_index_empty_and_infinite_test)
+{
+    auto bounds = GridBounds();
+    bounds[5] = Bounds{};
+    bounds[50] = Bounds::Infinite();
+    SpatialIndex index{bounds};
+    EXPECT_EQ(index.Size(), 99u);
+
+    std::vector<std::uint32_t> result;
+    index.Query(Bounds(1000, 1000, 1001, 1001), result);
+    std::vector<std::uint32_t> expected{50};
+    EXPECT_EQ(result, expected);
+
+    index.Query(Bounds(10, 0, 11, 1), result);
+    expected = {50};
+    EXPECT_EQ(result, expected);
+}
+
+TEST(spatial_index_tests, matrix_map_bounds_test)
+{
+    Matrix matrix;
+    matrix.Translate(10, 20);
+    matrix.Scale(2, 2);
+    Bounds mapped = matrix.MapBounds(Bounds(0, 0, 5, 5));
+    EXPECT_FLOAT_EQ(mapped.minX, 10);
+    EXPECT_FLOAT_EQ(mapped.minY, 20);
+    EXPECT_FLOAT_EQ(mapped.maxX, 20);
+    EXPECT_FLOAT_EQ(mapped.maxY, 30);
+
+    Matrix inverse;
+    EXPECT_TRUE(matrix.Invert(inverse));
+    mapped = inverse.MapBounds(mapped);
+    EXPECT_FLOAT_EQ(mapped.minX, 0);
+    EXPECT_FLOAT_EQ(mapped.maxY, 5);
+
+    matrix.Rotate(90);
+    mapped = matrix.MapBounds(Bounds(0, 0, 5, 1));
+    EXPECT_NEAR(mapped.minX, 8, 1e-4);
+    EXPECT_NEAR(mapped.maxX, 10, 1e-4);
+    EXPECT_NEAR(mapped.minY, 20, 1e-4);
+    EXPECT_NEAR(mapped.maxY, 30, 1e-4);
+
+    EXPECT_FALSE(Matrix(0, 0, 0, 0, 1, 1).Invert(inverse));
+}
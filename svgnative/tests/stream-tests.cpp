@@ -0,0 +1,221 @@
+/*
+Copyright 2022 Adobe. All rights reserved.
+This file is licensed to you under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License. You may obtain a copy
+of the License at http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software distributed under
+the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+OF ANY KIND, either express or implied. See the License for the specific language
+governing permissions and limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <svgnative/SVGDocument.h>
+#include <svgnative/Rect.h>
+#include <svgnative/ports/stream/StreamSVGRenderer.h>
+#include <svgnative/ports/string/StringSVGRenderer.h>
+
+using namespace SVGNative;
+
+// Images have headers for 160x110 pixels, the size the String port assumes.
+// Parsing modifies the text, so documents get parsed from copies.
+static const std::string kDocument = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' viewBox='0 0 200 200'>"
+    "<defs>"
+    "<linearGradient id='lg' x1='0' x2='1' spreadMethod='reflect' gradientTransform='rotate(30)'>"
+    "<stop stop-color='red'/><stop offset='0.5' stop-color='lime' stop-opacity='0.5'/><stop offset='1' stop-color='blue'/>"
+    "</linearGradient>"
+    "<radialGradient id='rg' cx='0.4' cy='0.5' r='0.6' fx='0.3' fy='0.4' spreadMethod='repeat'>"
+    "<stop stop-color='yellow'/><stop offset='1' stop-color='purple'/></radialGradient>"
+    "<clipPath id='cp' clip-rule='evenodd'><path transform='scale(2)' d='M0 0H50V50H0Z M10 10H40V40H10Z'/></clipPath>"
+    "<rect id='r' width='10' height='10' rx='2'/>"
+    "</defs>"
+    "<rect x='5' y='5' width='50' height='40' fill='url(#lg)' stroke='url(#rg)' stroke-width='3'/>"
+    "<g opacity='0.5' transform='translate(10 20)' clip-path='url(#cp)'>"
+    "<ellipse cx='30' cy='30' rx='20' ry='10' fill-opacity='0.25' fill-rule='evenodd'/>"
+    "<circle cx='60' cy='60' r='15' stroke='#123456' stroke-dasharray='4 2 1' stroke-dashoffset='3'"
+    " stroke-linecap='round' stroke-linejoin='bevel' stroke-miterlimit='7' stroke-opacity='0.75'/>"
+    "</g>"
+    "<path d='M10 150 C 20 130 40 130 50 150 Q 60 170 70 150 T 90 150 A 10 10 0 0 1 110 150 Z' fill='url(#rg)'/>"
+    "<use xlink:href='#r' x='100' y='100'/><use xlink:href='#r' x='120' y='100' fill='green'/>"
+    "<image x='120' y='10' width='60' height='40' preserveAspectRatio='xMinYMid slice'"
+    " xlink:href='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAKAAAABuCAIAAAA='/>"
+    "<image x='120' y='60' width='40' height='60' xlink:href='data:image/jpeg;base64,/9j/4AAQSkZJRgABAQAAAQABAAD/wAALCABuAKABAREA'/>"
+    "</svg>";
+
+static std::string RenderString(std::string svg)
+{
+    auto renderer = std::make_shared<StringSVGRenderer>();
+    auto doc = SVGDocument::CreateSVGDocument(svg.c_str(), renderer);
+    EXPECT_TRUE(doc);
+    if (doc)
+        doc->Render(400, 400);
+    return renderer->String();
+}
+
+static std::vector<std::uint8_t> RenderStream(std::string svg)
+{
+    auto renderer = std::make_shared<StreamSVGRenderer>();
+    auto doc = SVGDocument::CreateSVGDocument(svg.c_str(), renderer);
+    EXPECT_TRUE(doc);
+    if (doc)
+        doc->Render(400, 400);
+    return renderer->Stream();
+}
+
+// Forwards to the String port, checks that saves and restores balance and
+// collects rectangular clips. Throws on images like ports do on broken ones
+// if mThrowOnImages is set.
+class BalanceRenderer final : public SVGRenderer
+{
+public:
+    std::unique_ptr<ImageData> CreateImageData(const std::string& base64, ImageEncoding encoding) override
+    {
+        if (mThrowOnImages)
+            throw "Broken image";
+        return mTarget.CreateImageData(base64, encoding);
+    }
+    std::unique_ptr<Path> CreatePath() override { return mTarget.CreatePath(); }
+    std::unique_ptr<Transform> CreateTransform(float a, float b, float c, float d, float tx, float ty) override
+    {
+        return mTarget.CreateTransform(a, b, c, d, tx, ty);
+    }
+
+    void Save(const GraphicStyle& graphicStyle) override
+    {
+        ++mDepth;
+        if (graphicStyle.clippingPath && graphicStyle.clippingPath->isRect)
+            mClipRects.push_back(graphicStyle.clippingPath->clipRect);
+        mTarget.Save(graphicStyle);
+    }
+    void Restore() override
+    {
+        EXPECT_GT(mDepth, 0);
+        --mDepth;
+        mTarget.Restore();
+    }
+    void DrawPath(const Path& path, const GraphicStyle& graphicStyle, const FillStyle& fillStyle, const StrokeStyle& strokeStyle) override
+    {
+        mTarget.DrawPath(path, graphicStyle, fillStyle, strokeStyle);
+    }
+    void DrawImage(const ImageData& image, const GraphicStyle& graphicStyle, const Rect& clipArea, const Rect& fillArea) override
+    {
+        mTarget.DrawImage(image, graphicStyle, clipArea, fillArea);
+    }
+
+    int mDepth{};
+    std::vector<ClipRect> mClipRects;
+    bool mThrowOnImages{};
+
+private:
+    StringSVGRenderer mTarget;
+};
+
+TEST(stream_tests, stream_replay_test)
+{
+    const auto stream = RenderStream(kDocument);
+    StringSVGRenderer target;
+    EXPECT_TRUE(PlayStream(stream.data(), stream.size(), target));
+    EXPECT_EQ(target.String(), RenderString(kDocument));
+
+    // Paints of disabled fills and strokes are not part of the stream.
+    const std::string noFill = "<svg xmlns='http://www.w3.org/2000/svg'><rect width='10' height='10' fill='none' stroke='red'/></svg>";
+    const auto noFillStream = RenderStream(noFill);
+    StringSVGRenderer noFillTarget;
+    EXPECT_TRUE(PlayStream(noFillStream.data(), noFillStream.size(), noFillTarget));
+    EXPECT_NE(noFillTarget.String().find("hasFill: false"), std::string::npos);
+    EXPECT_NE(noFillTarget.String().find("hasStroke: true"), std::string::npos);
+}
+
+TEST(stream_tests, stream_clip_rect_test)
+{
+    // Rectangles keep the fast path of the target port.
+    const std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'>"
+        "<clipPath id='c'><rect x='1' y='2' width='3' height='4' transform='translate(1 0) scale(2)'/></clipPath>"
+        "<g clip-path='url(#c)'><rect width='10' height='10'/></g></svg>";
+    const auto stream = RenderStream(svg);
+    BalanceRenderer target;
+    EXPECT_TRUE(PlayStream(stream.data(), stream.size(), target));
+    ASSERT_EQ(target.mClipRects.size(), 1u);
+    const auto& clipRect = target.mClipRects.front();
+    EXPECT_EQ(clipRect.x, 3);
+    EXPECT_EQ(clipRect.y, 4);
+    EXPECT_EQ(clipRect.width, 6);
+    EXPECT_EQ(clipRect.height, 8);
+}
+
+TEST(stream_tests, stream_definitions_test)
+{
+    // Paths and images are written once, draws only reference them.
+    auto renderer = std::make_shared<StreamSVGRenderer>();
+    auto doc = SVGDocument::CreateSVGDocument(std::string{kDocument}.c_str(), renderer);
+    ASSERT_TRUE(doc);
+    doc->Render();
+    const size_t firstSize = renderer->Stream().size();
+    doc->Render();
+    const size_t secondSize = renderer->Stream().size() - firstSize;
+    EXPECT_LT(secondSize, firstSize);
+
+    StringSVGRenderer target;
+    EXPECT_TRUE(PlayStream(renderer->Stream().data(), renderer->Stream().size(), target));
+
+    renderer->Clear();
+    doc->Render();
+    EXPECT_EQ(renderer->Stream().size(), firstSize);
+}
+
+TEST(stream_tests, stream_malformed_test)
+{
+    const auto stream = RenderStream(kDocument);
+
+    // Any prefix plays without reading past the end, and all saved
+    // states get restored.
+    for (size_t size = 0; size < stream.size(); ++size)
+    {
+        BalanceRenderer target;
+        PlayStream(stream.data(), size, target);
+        EXPECT_EQ(target.mDepth, 0) << "size " << size;
+    }
+
+    // Bad headers, unknown commands and unbalanced restores fail.
+    BalanceRenderer target;
+    auto corrupt = stream;
+    corrupt[4] = 99;
+    EXPECT_FALSE(PlayStream(corrupt.data(), corrupt.size(), target));
+    corrupt = stream;
+    corrupt.push_back(0xff);
+    EXPECT_FALSE(PlayStream(corrupt.data(), corrupt.size(), target));
+    corrupt = stream;
+    corrupt.push_back(2);
+    EXPECT_FALSE(PlayStream(corrupt.data(), corrupt.size(), target));
+
+    // Flipped bytes never crash.
+    for (size_t i = 5; i < stream.size(); ++i)
+    {
+        corrupt = stream;
+        corrupt[i] ^= 0x5a;
+        BalanceRenderer flipped;
+        PlayStream(corrupt.data(), corrupt.size(), flipped);
+        EXPECT_EQ(flipped.mDepth, 0);
+    }
+
+    // Images the port throws on are skipped.
+    BalanceRenderer throwing;
+    throwing.mThrowOnImages = true;
+    EXPECT_TRUE(PlayStream(stream.data(), stream.size(), throwing));
+    EXPECT_EQ(throwing.mDepth, 0);
+}
+
+TEST(stream_tests, stream_image_size_test)
+{
+    StreamSVGRenderer renderer;
+    auto png = renderer.CreateImageData("iVBORw0KGgoAAAANSUhEUgAAAKAAAABuCAIAAAA=", ImageEncoding::kPNG);
+    EXPECT_EQ(png->Width(), 160);
+    EXPECT_EQ(png->Height(), 110);
+    auto jpeg = renderer.CreateImageData("/9j/4AAQSkZJRgABAQAAAQABAAD/wAALCABuAKABAREA", ImageEncoding::kJPEG);
+    EXPECT_EQ(jpeg->Width(), 160);
+    EXPECT_EQ(jpeg->Height(), 110);
+    auto invalid = renderer.CreateImageData("AAAA", ImageEncoding::kPNG);
+    EXPECT_EQ(invalid->Width(), 0);
+}